@@ -8,6 +8,7 @@
 #include <iostream>
 #include <mutex>
 #include <algorithm>                // std::find_if()
+#include <limits>
 
 #include <boost/fiber/all.hpp>
 #include <boost/fiber/scheduler.hpp>
@@ -60,6 +61,23 @@ public:
         }
     }
 
+    // Priority temporarily inherited from a higher-priority fiber blocked on
+    // a mutex held by this fiber. Maintained by priority_scheduler.
+    int get_effective_priority() const {
+        return (std::max)( priority_, inherited_);
+    }
+
+    void set_inherited_priority( int p) {
+        if ( p != inherited_) {
+            inherited_ = p;
+            notify();
+        }
+    }
+
+    void reset_inherited_priority() {
+        set_inherited_priority( (std::numeric_limits< int >::min)() );
+    }
+
     // The fiber name of course is solely for purposes of this example
     // program; it has nothing to do with implementing scheduler priority.
     // This is a public data member -- not requiring set/get access methods --
@@ -68,6 +86,7 @@ public:
                           not need access methods. >*/
 private:
     int priority_;
+    int inherited_{ (std::numeric_limits< int >::min)() };
 };
 //]
 
@@ -93,7 +112,7 @@ public:
          method. This is how your scheduler receives notification of a
          fiber that has become ready to run. >>*/
     virtual void awakened( boost::fibers::context * ctx, priority_props & props) noexcept {
-        int ctx_priority = props.get_priority(); /*< `props` is the instance of
+        int ctx_priority = props.get_effective_priority(); /*< `props` is the instance of
                                                    priority_props associated
                                                    with the passed fiber `ctx`. >*/
         // With this scheduler, fibers with higher priority values are
@@ -104,7 +123,7 @@ public:
         // in the queue with LOWER priority, and insert before that one.
         rqueue_t::iterator i( std::find_if( rqueue_.begin(), rqueue_.end(),
             [ctx_priority,this]( boost::fibers::context & c)
-            { return properties( &c ).get_priority() < ctx_priority; }));
+            { return properties( &c ).get_effective_priority() < ctx_priority; }));
         // Now, whether or not we found a fiber with lower priority,
         // insert this new fiber here.
         rqueue_.insert( i, * ctx);
@@ -177,6 +196,28 @@ public:
         // right place in the ready queue.
         awakened( ctx, props);
     }
+
+    /*<< Overriding [member_link algorithm_with_properties..lock_contended]
+         and [member_link algorithm_with_properties..lock_released] is
+         optional. Together they implement priority inheritance: a fiber
+         holding a mutex runs at the priority of the most important fiber
+         blocked on it, so that medium-priority fibers cannot starve it. >>*/
+    virtual bool lock_contended( boost::fibers::context * /*owner*/, priority_props & owner_props,
+                                 boost::fibers::context * /*waiter*/, priority_props & waiter_props) noexcept {
+        if ( waiter_props.get_effective_priority() > owner_props.get_effective_priority() ) {
+            // notify() -> property_change() moves the owner within the
+            // ready queue if it is ready to run
+            owner_props.set_inherited_priority( waiter_props.get_effective_priority() );
+            return true;
+        }
+        return false;
+    }
+
+    virtual void lock_released( boost::fibers::context * /*owner*/, priority_props & owner_props) noexcept {
+        // keep it simple: a fiber holding more than one contended mutex
+        // drops its boost when it releases the first of them
+        owner_props.reset_inherited_priority();
+    }
 //<-
 
     void describe_ready_queue() {
@@ -186,7 +227,7 @@ public:
             const char * delim = "";
             for ( boost::fibers::context & ctx : rqueue_) {
                 priority_props & props( properties( & ctx) );
-                std::cout << delim << props.name << '(' << props.get_priority() << ')';
+                std::cout << delim << props.name << '(' << props.get_effective_priority() << ')';
                 delim = ", ";
             }
         }
@@ -345,6 +386,33 @@ int main( int argc, char *argv[]) {
         c.join();
     }
 
+    {
+        Verbose v("priority inheritance", "stop\n");
+        // "low" holds the mutex while "high" waits for it: "low" inherits
+        // the priority of "high" and runs ahead of "medium"
+        boost::fibers::mutex mtx;
+        boost::fibers::barrier barrier( 2);
+        boost::fibers::fiber low( launch( [&mtx,&barrier](){
+                    std::unique_lock< boost::fibers::mutex > lk( mtx);
+                    barrier.wait();
+                    yield_fn();
+                }, "low", 1) );
+        // let "low" acquire the mutex
+        boost::this_fiber::yield();
+        boost::fibers::fiber hi( launch( [&mtx](){
+                    std::unique_lock< boost::fibers::mutex > lk( mtx);
+                    std::cout << "fiber high got the mutex" << std::endl;
+                }, "high", 3) );
+        boost::fibers::fiber med( launch( yield_fn, "medium", 2) );
+        barrier.wait();
+        std::cout << "main: high.join()" << std::endl;
+        hi.join();
+        std::cout << "main: medium.join()" << std::endl;
+        med.join();
+        std::cout << "main: low.join()" << std::endl;
+        low.join();
+    }
+
     std::cout << "done." << std::endl;
 
     return EXIT_SUCCESS;
@@ -45,6 +45,18 @@ public:
     // called by fiber_properties::notify() -- don't directly call
     virtual void property_change_( context * f, fiber_properties * props) noexcept = 0;
 
+    // called by fiber_properties::lock_contended() -- don't directly call
+    // creates the properties of a fiber which has not been passed to
+    // awakened() yet
+    virtual fiber_properties * attach_properties_( context * f) noexcept = 0;
+
+    // called by fiber_properties::lock_contended() -- don't directly call
+    virtual bool lock_contended_( context * owner, fiber_properties * owner_props,
+                                  context * waiter, fiber_properties * waiter_props) noexcept = 0;
+
+    // called by fiber_properties::lock_released() -- don't directly call
+    virtual void lock_released_( context * owner, fiber_properties * owner_props) noexcept = 0;
+
 protected:
     static fiber_properties* get_properties( context * f) noexcept;
     static void set_properties( context * f, fiber_properties * p) noexcept;
@@ -59,18 +71,7 @@ struct algorithm_with_properties : public algorithm_with_properties_base {
     // you'd have to remember to start every subclass awakened() override
     // with: algorithm_with_properties<PROPS>::awakened(fb);
     virtual void awakened( context * f) noexcept override final {
-        fiber_properties * props = super::get_properties( f);
-        if ( nullptr == props) {
-            // TODO: would be great if PROPS could be allocated on the new
-            // fiber's stack somehow
-            props = new_properties( f);
-            // It is not good for new_properties() to return 0.
-            BOOST_ASSERT_MSG(props, "new_properties() must return non-NULL");
-            // new_properties() must return instance of (a subclass of) PROPS
-            BOOST_ASSERT_MSG( dynamic_cast< PROPS * >( props),
-                              "new_properties() must return properties class");
-            super::set_properties( f, props);
-        }
+        fiber_properties * props = attach_properties_( f);
         // Set algo_ again every time this fiber becomes READY. That
         // handles the case of a fiber migrating to a new thread with a new
         // algorithm subclass instance.
@@ -97,6 +98,49 @@ struct algorithm_with_properties : public algorithm_with_properties_base {
         property_change( f, * static_cast< PROPS * >( props) );
     }
 
+    // override this to be notified that fiber 'waiter' is going to block on
+    // a mutex held by fiber 'owner', e.g. to let 'owner' inherit the
+    // priority of 'waiter'; return true if 'owner' inherited the priority
+    virtual bool lock_contended( context *, PROPS &, context *, PROPS &) noexcept {
+        return false;
+    }
+
+    // override this to be notified that fiber 'owner' has released a mutex
+    // or that the waiter it inherited from stopped waiting, e.g. to drop a
+    // priority inherited in lock_contended()
+    virtual void lock_released( context *, PROPS &) noexcept {
+    }
+
+    // implementation for algorithm_with_properties_base method
+    fiber_properties * attach_properties_( context * f) noexcept override final {
+        fiber_properties * props = super::get_properties( f);
+        if ( nullptr == props) {
+            // TODO: would be great if PROPS could be allocated on the new
+            // fiber's stack somehow
+            props = new_properties( f);
+            // It is not good for new_properties() to return 0.
+            BOOST_ASSERT_MSG(props, "new_properties() must return non-NULL");
+            // new_properties() must return instance of (a subclass of) PROPS
+            BOOST_ASSERT_MSG( dynamic_cast< PROPS * >( props),
+                              "new_properties() must return properties class");
+            super::set_properties( f, props);
+            props->set_algorithm( this);
+        }
+        return props;
+    }
+
+    // implementation for algorithm_with_properties_base method
+    bool lock_contended_( context * owner, fiber_properties * owner_props,
+                          context * waiter, fiber_properties * waiter_props) noexcept override final {
+        return lock_contended( owner, * static_cast< PROPS * >( owner_props),
+                               waiter, * static_cast< PROPS * >( waiter_props) );
+    }
+
+    // implementation for algorithm_with_properties_base method
+    void lock_released_( context * owner, fiber_properties * owner_props) noexcept override final {
+        lock_released( owner, * static_cast< PROPS * >( owner_props) );
+    }
+
     // Override this to customize instantiation of PROPS, e.g. use a different
     // allocator. Each PROPS instance is associated with a particular
     // context.
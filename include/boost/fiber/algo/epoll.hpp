@@ -0,0 +1,127 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ALGO_EPOLL_H
+#define BOOST_FIBERS_ALGO_EPOLL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/predef.h>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/context_ring_queue.hpp>
+#include <boost/fiber/scheduler.hpp>
+
+#if BOOST_OS_LINUX
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+// round-robin scheduling; if no fiber is ready the thread blocks in
+// epoll_wait() until a file descriptor a fiber waits for becomes ready,
+// the next sleeping fiber times out or notify() is called
+// fibers wait for readiness via this_fiber::wait_readable()/wait_writable();
+// they are readied directly from the results of epoll_wait()
+class BOOST_FIBERS_DECL epoll : public algorithm {
+private:
+    typedef detail::context_ring_queue rqueue_t;
+
+    struct waiters {
+        context     *   reader{ nullptr };
+        context     *   writer{ nullptr };
+        bool            registered{ false };
+    };
+
+    rqueue_t                    rqueue_{};
+    int                         epfd_{ -1 };
+    int                         evfd_{ -1 };
+    std::atomic< bool >         notified_{ false };
+    int                         wakefd_{ -1 };
+    // indexed by file descriptor
+    std::vector< waiters >      fds_{};
+    std::size_t                 waiting_{ 0 };
+    std::size_t                 picks_{ 0 };
+
+    bool arm_( int, waiters &) noexcept;
+
+    void poll_( int) noexcept;
+
+    void wait_( int, bool);
+
+protected:
+    // lets a derived algorithm wake suspend_until() if fd becomes readable;
+    // the descriptor is watched level-triggered and never drained
+    void watch_( int fd);
+
+public:
+    epoll();
+
+    epoll( epoll const&) = delete;
+    epoll & operator=( epoll const&) = delete;
+
+    virtual ~epoll();
+
+    // epoll algorithm installed for the calling thread, nullptr otherwise
+    static epoll * instance() noexcept;
+
+    virtual void awakened( context *) noexcept;
+
+    virtual context * pick_next() noexcept;
+
+    virtual bool has_ready_fibers() const noexcept;
+
+    virtual void suspend_until( std::chrono::steady_clock::time_point const&) noexcept;
+
+    virtual void notify() noexcept;
+
+    void wait_readable( int fd);
+
+    void wait_writable( int fd);
+};
+
+}}
+
+namespace this_fiber {
+
+// suspend the active fiber until fd becomes readable (or hung up/in error);
+// requires algo::epoll to be the scheduling algorithm of this thread
+BOOST_FIBERS_DECL
+void wait_readable( int fd);
+
+// suspend the active fiber until fd becomes writable (or in error);
+// requires algo::epoll to be the scheduling algorithm of this thread
+BOOST_FIBERS_DECL
+void wait_writable( int fd);
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_OS_LINUX
+
+#endif // BOOST_FIBERS_ALGO_EPOLL_H
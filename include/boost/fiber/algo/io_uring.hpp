@@ -0,0 +1,157 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ALGO_IO_URING_H
+#define BOOST_FIBERS_ALGO_IO_URING_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/config.hpp>
+#include <boost/predef.h>
+
+#include <boost/fiber/algo/epoll.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+#if BOOST_OS_LINUX
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+// epoll scheduling extended by an io_uring instance: fibers submit reads,
+// writes, fsyncs and accepts and are suspended until the completion
+// queue entry arrives; submissions are collected and passed to the kernel
+// by one io_uring_enter() per dispatch round
+// if io_uring is not available (or 0 entries were requested) the
+// operations fall back to non-blocking syscalls + epoll readiness waits
+class BOOST_FIBERS_DECL io_uring : public epoll {
+private:
+    int                         ring_fd_{ -1 };
+    void                    *   sq_ring_{ nullptr };
+    std::size_t                 sq_ring_size_{ 0 };
+    void                    *   cq_ring_{ nullptr };
+    std::size_t                 cq_ring_size_{ 0 };
+    ::io_uring_sqe          *   sqes_{ nullptr };
+    std::size_t                 sqes_size_{ 0 };
+    unsigned int            *   sq_head_{ nullptr };
+    unsigned int            *   sq_tail_{ nullptr };
+    unsigned int            *   sq_flags_{ nullptr };
+    unsigned int            *   sq_array_{ nullptr };
+    unsigned int                sq_mask_{ 0 };
+    unsigned int                sq_entries_{ 0 };
+    unsigned int            *   cq_head_{ nullptr };
+    unsigned int            *   cq_tail_{ nullptr };
+    ::io_uring_cqe          *   cqes_{ nullptr };
+    unsigned int                cq_mask_{ 0 };
+    // SQEs not yet passed to the kernel
+    unsigned int                pending_{ 0 };
+    // operations waiting for their completion
+    std::size_t                 inflight_{ 0 };
+
+    void unmap_() noexcept;
+
+    ::io_uring_sqe * get_sqe_() noexcept;
+
+    void submit_() noexcept;
+
+    bool reap_() noexcept;
+
+    int execute_( ::io_uring_sqe *) noexcept;
+
+public:
+    // entries: size of the submission queue (rounded up to a power of two
+    // by the kernel); 0 selects the readiness based fallback
+    explicit io_uring( unsigned int entries = 256);
+
+    io_uring( io_uring const&) = delete;
+    io_uring & operator=( io_uring const&) = delete;
+
+    virtual ~io_uring();
+
+    // io_uring algorithm installed for the calling thread, nullptr otherwise
+    static io_uring * instance() noexcept;
+
+    // true if operations are executed by io_uring
+    bool has_ring() const noexcept {
+        return -1 != ring_fd_;
+    }
+
+    virtual context * pick_next() noexcept;
+
+    virtual void suspend_until( std::chrono::steady_clock::time_point const&) noexcept;
+
+    // the operations return the result of the corresponding syscall,
+    // or -errno on failure; offset -1 uses the file position
+    ::ssize_t read( int fd, void * buf, std::size_t len, std::int64_t offset);
+
+    ::ssize_t write( int fd, void const* buf, std::size_t len, std::int64_t offset);
+
+    int fsync( int fd, bool datasync);
+
+    int accept( int fd, ::sockaddr * addr, ::socklen_t * addrlen, int flags);
+};
+
+}
+
+namespace io {
+
+// fiber-blocking I/O: suspends only the calling fiber
+// executed by algo::io_uring if it schedules this thread; otherwise
+// non-blocking descriptors are waited for with algo::epoll if available,
+// else the plain (thread blocking) syscall is made
+// return values and errno follow the POSIX functions of the same name
+
+BOOST_FIBERS_DECL
+::ssize_t read( int fd, void * buf, std::size_t len);
+
+BOOST_FIBERS_DECL
+::ssize_t pread( int fd, void * buf, std::size_t len, ::off_t offset);
+
+BOOST_FIBERS_DECL
+::ssize_t write( int fd, void const* buf, std::size_t len);
+
+BOOST_FIBERS_DECL
+::ssize_t pwrite( int fd, void const* buf, std::size_t len, ::off_t offset);
+
+BOOST_FIBERS_DECL
+int fsync( int fd);
+
+BOOST_FIBERS_DECL
+int fdatasync( int fd);
+
+BOOST_FIBERS_DECL
+int accept( int fd, ::sockaddr * addr, ::socklen_t * addrlen, int flags = 0);
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_OS_LINUX
+
+#endif // BOOST_FIBERS_ALGO_IO_URING_H
@@ -6,15 +6,15 @@
 #ifndef BOOST_FIBERS_ALGO_ROUND_ROBIN_H
 #define BOOST_FIBERS_ALGO_ROUND_ROBIN_H
 
-#include <condition_variable>
 #include <chrono>
-#include <mutex>
 
 #include <boost/config.hpp>
 
 #include <boost/fiber/algo/algorithm.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/context_ring_queue.hpp>
+#include <boost/fiber/detail/parker.hpp>
 #include <boost/fiber/scheduler.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -32,12 +32,10 @@ namespace algo {
 
 class BOOST_FIBERS_DECL round_robin : public algorithm {
 private:
-    typedef scheduler::ready_queue_t rqueue_t;
+    typedef detail::context_ring_queue rqueue_t;
 
     rqueue_t                    rqueue_{};
-    std::mutex                  mtx_{};
-    std::condition_variable     cnd_{};
-    bool                        flag_{ false };
+    detail::parker              parker_{};
 
 public:
     round_robin() = default;
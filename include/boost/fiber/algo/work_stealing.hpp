@@ -8,10 +8,8 @@
 #ifndef BOOST_FIBERS_ALGO_WORK_STEALING_H
 #define BOOST_FIBERS_ALGO_WORK_STEALING_H
 
-#include <condition_variable>
 #include <chrono>
 #include <cstddef>
-#include <mutex>
 #include <vector>
 
 #include <boost/config.hpp>
@@ -20,6 +18,7 @@
 #include <boost/fiber/detail/context_spmc_queue.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/parker.hpp>
 #include <boost/fiber/scheduler.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -40,9 +39,7 @@ private:
     std::size_t                                     max_idx_;
     detail::context_spmc_queue                      rqueue_{};
     lqueue_t                                        lqueue_{};
-    std::mutex                                      mtx_{};
-    std::condition_variable                         cnd_{};
-    bool                                            flag_{ false };
+    detail::parker                                  parker_{};
     bool                                            suspend_;
 
     static void init_( std::size_t max_idx);
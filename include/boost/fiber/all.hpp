@@ -8,31 +8,48 @@
 #define BOOST_FIBERS_H
 
 #include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/algo/epoll.hpp>
+#include <boost/fiber/algo/io_uring.hpp>
 #include <boost/fiber/algo/round_robin.hpp>
 #include <boost/fiber/algo/shared_work.hpp>
 #include <boost/fiber/algo/work_stealing.hpp>
+#include <boost/fiber/atomic_wait.hpp>
 #include <boost/fiber/barrier.hpp>
 #include <boost/fiber/buffered_channel.hpp>
 #include <boost/fiber/channel_op_status.hpp>
 #include <boost/fiber/condition_variable.hpp>
 #include <boost/fiber/context.hpp>
+#include <boost/fiber/counting_semaphore.hpp>
+#include <boost/fiber/event.hpp>
+#include <boost/fiber/eventcount.hpp>
 #include <boost/fiber/exceptions.hpp>
 #include <boost/fiber/fiber.hpp>
 #include <boost/fiber/fixedsize_stack.hpp>
 #include <boost/fiber/fss.hpp>
 #include <boost/fiber/future.hpp>
+#include <boost/fiber/latch.hpp>
 #include <boost/fiber/mutex.hpp>
+#include <boost/fiber/offload.hpp>
+#include <boost/fiber/once.hpp>
 #include <boost/fiber/operations.hpp>
 #include <boost/fiber/policy.hpp>
 #include <boost/fiber/pooled_fixedsize_stack.hpp>
+#include <boost/fiber/profiler.hpp>
 #include <boost/fiber/properties.hpp>
 #include <boost/fiber/protected_fixedsize_stack.hpp>
+#include <boost/fiber/rcu.hpp>
 #include <boost/fiber/recursive_mutex.hpp>
 #include <boost/fiber/recursive_timed_mutex.hpp>
 #include <boost/fiber/scheduler.hpp>
 #include <boost/fiber/segmented_stack.hpp>
+#include <boost/fiber/select.hpp>
+#include <boost/fiber/shared_mutex.hpp>
+#include <boost/fiber/shared_timed_mutex.hpp>
+#include <boost/fiber/spinlock_policy.hpp>
+#include <boost/fiber/spsc_channel.hpp>
 #include <boost/fiber/timed_mutex.hpp>
 #include <boost/fiber/type.hpp>
+#include <boost/fiber/unbounded_channel.hpp>
 #include <boost/fiber/unbuffered_channel.hpp>
 
 #endif // BOOST_FIBERS_H
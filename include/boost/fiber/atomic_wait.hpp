@@ -0,0 +1,87 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ATOMIC_WAIT_H
+#define BOOST_FIBERS_ATOMIC_WAIT_H
+
+#include <atomic>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// re-evaluated with the bucket spinlock held before the fiber is parked;
+// lives on the stack of the waiting fiber
+class atomic_wait_check {
+public:
+    virtual ~atomic_wait_check() = default;
+
+    virtual bool changed() const noexcept = 0;
+};
+
+template< typename T >
+class atomic_wait_check_impl : public atomic_wait_check {
+private:
+    std::atomic< T > const  *   addr_;
+    T                           old_;
+
+public:
+    atomic_wait_check_impl( std::atomic< T > const* addr, T old) noexcept :
+        addr_{ addr },
+        old_{ old } {
+    }
+
+    bool changed() const noexcept override final {
+        return addr_->load( std::memory_order_seq_cst) != old_;
+    }
+};
+
+// parks the active fiber on addr unless chk reports a change
+BOOST_FIBERS_DECL
+void atomic_wait( void const *, atomic_wait_check const&) noexcept;
+
+// wakes one (or all) fibers parked on addr
+BOOST_FIBERS_DECL
+void atomic_notify( void const *, bool) noexcept;
+
+}
+
+// blocks the active fiber as long as addr holds old; returns only after a
+// change of the value has been observed
+template< typename T >
+void atomic_wait( std::atomic< T > const* addr, T old) noexcept {
+    const detail::atomic_wait_check_impl< T > chk{ addr, old };
+    while ( ! chk.changed() ) {
+        detail::atomic_wait( addr, chk);
+    }
+}
+
+// the modification of *addr preceding a notify must be sequentially
+// consistent (the default for std::atomic<> stores and read-modify-writes)
+template< typename T >
+void atomic_notify_one( std::atomic< T > const* addr) noexcept {
+    detail::atomic_notify( addr, false);
+}
+
+template< typename T >
+void atomic_notify_all( std::atomic< T > const* addr) noexcept {
+    detail::atomic_notify( addr, true);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ATOMIC_WAIT_H
@@ -1,4 +1,3 @@
-
 //          Copyright Oliver Kowalke 2013.
 // Distributed under the Boost Software License, Version 1.0.
 //    (See accompanying file LICENSE_1_0.txt or copy at
@@ -7,40 +6,105 @@
 #ifndef BOOST_FIBERS_BARRIER_H
 #define BOOST_FIBERS_BARRIER_H
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 
 #include <boost/config.hpp>
 
-#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
-#include <boost/fiber/mutex.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
 #endif
 
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
 namespace boost {
 namespace fibers {
 
 class BOOST_FIBERS_DECL barrier {
+public:
+    // identifies the phase a fiber arrived at
+    class arrival_token {
+    private:
+        friend class barrier;
+
+        std::uint32_t   phase_;
+
+        explicit arrival_token( std::uint32_t phase) noexcept :
+            phase_{ phase } {
+        }
+
+    public:
+        arrival_token( arrival_token &&) = default;
+        arrival_token & operator=( arrival_token &&) = default;
+    };
+
 private:
-	std::size_t         initial_;
-	std::size_t         current_;
-	bool                cycle_{ true };
-	mutex               mtx_{};
-	condition_variable  cond_{};
+    typedef context::wait_queue_t   wait_queue_type;
+
+    static constexpr std::uint64_t  count_mask = 0x7fffffff;
+    static constexpr std::uint64_t  releasing_bit = 0x80000000;
+    static constexpr unsigned int   phase_shift = 32;
+
+    // phase number in the upper, fibers still expected in the current
+    // phase in the lower 31 bits; arriving is a single fetch_sub
+    // bit 31 is set while the fiber completing a phase still accesses the
+    // barrier - fibers of the next phase must not leave wait() before it
+    // is cleared
+    std::atomic< std::uint64_t >    state_;
+    // number of fibers expected in the next phase (reduced by
+    // arrive_and_drop())
+    std::atomic< std::size_t >      expected_;
+    std::function< void() >         completion_;
+    detail::spinlock                wait_queue_splk_{};
+    wait_queue_type                 wait_queue_{};
+
+    // returns true if the arrival completed the phase
+    bool arrive_( std::size_t, std::uint32_t &) noexcept;
+
+    void wait_( std::uint32_t) noexcept;
+
+    void wait_released_() const noexcept;
 
 public:
 	explicit barrier( std::size_t);
 
+    // completion is invoked by the fiber completing a phase, before the
+    // waiting fibers are released; it must not throw
+    barrier( std::size_t, std::function< void() >);
+
     barrier( barrier const&) = delete;
     barrier & operator=( barrier const&) = delete;
 
+    static constexpr std::size_t max() noexcept {
+        return static_cast< std::size_t >( count_mask);
+    }
+
 	bool wait();
+
+    arrival_token arrive( std::size_t n = 1) noexcept;
+
+    void wait( arrival_token &&) noexcept;
+
+    void arrive_and_wait() noexcept;
+
+    void arrive_and_drop() noexcept;
 };
 
 }}
 
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_SUFFIX
 #endif
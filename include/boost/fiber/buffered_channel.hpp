@@ -10,11 +10,14 @@
 #ifndef BOOST_FIBERS_BUFFERED_CHANNEL_H
 #define BOOST_FIBERS_BUFFERED_CHANNEL_H
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 
 #include <boost/config.hpp>
@@ -23,8 +26,11 @@
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/select_waiter.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/detail/waiter_count.hpp>
 #include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/spinlock_policy.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -33,7 +39,9 @@
 namespace boost {
 namespace fibers {
 
-template< typename T >
+// Spinlock protects the wait-queues; defaults to the spinlock the library
+// was built with (see spinlock_policy)
+template< typename T, typename Spinlock = detail::spinlock >
 class buffered_channel {
 public:
     typedef T   value_type;
@@ -41,9 +49,13 @@ public:
 private:
     typedef typename std::aligned_storage< sizeof( T), alignof( T) >::type  storage_type;
     typedef context::wait_queue_t                                           wait_queue_type;
+    typedef std::unique_lock< Spinlock >                                    lock_type;
 
     struct alignas(cache_alignment) slot {
         std::atomic< std::size_t >  cycle{ 0 };
+        // published without a value: constructing it threw (see
+        // try_push_n_), consumers step over the slot
+        bool                        skipped{ false };
         storage_type                storage{};
 
         slot() = default;
@@ -55,9 +67,13 @@ private:
     alignas(cache_alignment) std::atomic< std::size_t >     consumer_idx_{ 0 };
     // shared write cacheline
     alignas(cache_alignment) std::atomic_bool               closed_{ false };
-    mutable detail::spinlock                                splk_{};
+    detail::waiter_count                                    producer_waiters_{};
+    detail::waiter_count                                    consumer_waiters_{};
+    mutable Spinlock                                        splk_{};
     wait_queue_type                                         waiting_producers_{};
     wait_queue_type                                         waiting_consumers_{};
+    detail::select_queue                                    select_producers_{};
+    detail::select_queue                                    select_consumers_{};
     // shared read cacheline
     alignas(cache_alignment) slot                        *  slots_{ nullptr };
     std::size_t                                             capacity_;
@@ -97,24 +113,32 @@ private:
     }
 
     channel_op_status try_value_pop_( slot *& s, std::size_t & idx) {
-        idx = consumer_idx_.load( std::memory_order_relaxed);
         for (;;) {
-            s = & slots_[idx & (capacity_ - 1)];
-            std::size_t cycle = s->cycle.load( std::memory_order_acquire);
-            std::intptr_t diff{ static_cast< std::intptr_t >( cycle) - static_cast< std::intptr_t >( idx + 1) };
-            if ( 0 == diff) {
-                if ( consumer_idx_.compare_exchange_weak( idx, idx + 1, std::memory_order_relaxed) ) {
-                    break;
+            idx = consumer_idx_.load( std::memory_order_relaxed);
+            for (;;) {
+                s = & slots_[idx & (capacity_ - 1)];
+                std::size_t cycle = s->cycle.load( std::memory_order_acquire);
+                std::intptr_t diff{ static_cast< std::intptr_t >( cycle) - static_cast< std::intptr_t >( idx + 1) };
+                if ( 0 == diff) {
+                    if ( consumer_idx_.compare_exchange_weak( idx, idx + 1, std::memory_order_relaxed) ) {
+                        break;
+                    }
+                } else if ( 0 > diff) {
+                    return channel_op_status::empty;
+                } else {
+                    idx = consumer_idx_.load( std::memory_order_relaxed);
                 }
-            } else if ( 0 > diff) {
-                return channel_op_status::empty;
-            } else {
-                idx = consumer_idx_.load( std::memory_order_relaxed);
             }
+            if ( ! s->skipped) {
+                // incrementing the slot cycle must be deferred till the value has been consumed
+                // slot cycle tells procuders that the cell can be re-used (store new value)
+                return channel_op_status::success;
+            }
+            // slot holds no value, free it and try the next one
+            s->skipped = false;
+            s->cycle.store( idx + capacity_, std::memory_order_release);
+            notify_producer_();
         }
-        // incrementing the slot cycle must be deferred till the value has been consumed
-        // slot cycle tells procuders that the cell can be re-used (store new value)
-        return channel_op_status::success;
     }
 
     channel_op_status try_pop_( value_type & value) {
@@ -128,6 +152,234 @@ private:
         return status;
     }
 
+    // claims up to n consecutive free slots with one CAS on producer_idx_
+    template< typename ForwardIterator >
+    std::size_t try_push_n_( ForwardIterator & first, std::size_t n) {
+        const std::size_t max{ (std::min)( n, capacity_) };
+        std::size_t idx{ producer_idx_.load( std::memory_order_relaxed) };
+        std::size_t count{ 0 };
+        for (;;) {
+            std::size_t cycle{ 0 };
+            for ( count = 0; count < max; ++count) {
+                cycle = slots_[(idx + count) & (capacity_ - 1)].cycle.load( std::memory_order_acquire);
+                if ( cycle != idx + count) {
+                    break;
+                }
+            }
+            if ( 0 < count) {
+                // the claimed slots can not be taken by other producers
+                if ( producer_idx_.compare_exchange_weak( idx, idx + count, std::memory_order_relaxed) ) {
+                    break;
+                }
+            } else if ( 0 > static_cast< std::intptr_t >( cycle) - static_cast< std::intptr_t >( idx) ) {
+                return 0;
+            } else {
+                idx = producer_idx_.load( std::memory_order_relaxed);
+            }
+        }
+        std::size_t i{ 0 };
+        try {
+            while ( i < count) {
+                slot * s{ & slots_[(idx + i) & (capacity_ - 1)] };
+                ::new ( static_cast< void * >( std::addressof( s->storage) ) ) value_type( * first);
+                s->cycle.store( idx + i + 1, std::memory_order_release);
+                ++i;
+                ++first;
+            }
+        } catch (...) {
+            // the claimed slots can not be given back - publish the rest of
+            // the run as skipped, otherwise consumers would wait forever at
+            // the first of them
+            for ( ; i < count; ++i) {
+                slot * s{ & slots_[(idx + i) & (capacity_ - 1)] };
+                s->skipped = true;
+                s->cycle.store( idx + i + 1, std::memory_order_release);
+            }
+            notify_n_( waiting_consumers_, select_consumers_, consumer_waiters_, count);
+            throw;
+        }
+        return count;
+    }
+
+    // claims up to n consecutive filled slots with one CAS on consumer_idx_
+    // returns the number of values written to out, freed is set to the
+    // number of claimed slots (including skipped ones)
+    template< typename OutputIterator >
+    std::size_t try_pop_n_( OutputIterator & out, std::size_t n, std::size_t & freed) {
+        const std::size_t max{ (std::min)( n, capacity_) };
+        std::size_t idx{ consumer_idx_.load( std::memory_order_relaxed) };
+        std::size_t count{ 0 };
+        for (;;) {
+            std::size_t cycle{ 0 };
+            for ( count = 0; count < max; ++count) {
+                cycle = slots_[(idx + count) & (capacity_ - 1)].cycle.load( std::memory_order_acquire);
+                if ( cycle != idx + count + 1) {
+                    break;
+                }
+            }
+            if ( 0 < count) {
+                if ( consumer_idx_.compare_exchange_weak( idx, idx + count, std::memory_order_relaxed) ) {
+                    break;
+                }
+            } else if ( 0 > static_cast< std::intptr_t >( cycle) - static_cast< std::intptr_t >( idx + 1) ) {
+                return 0;
+            } else {
+                idx = consumer_idx_.load( std::memory_order_relaxed);
+            }
+        }
+        freed = count;
+        std::size_t popped{ 0 };
+        std::size_t i{ 0 };
+        try {
+            while ( i < count) {
+                slot * s{ & slots_[(idx + i) & (capacity_ - 1)] };
+                bool written{ false };
+                if ( s->skipped) {
+                    s->skipped = false;
+                } else {
+                    value_type * v{ reinterpret_cast< value_type * >( std::addressof( s->storage) ) };
+                    * out = std::move( * v);
+                    v->~value_type();
+                    written = true;
+                }
+                s->cycle.store( idx + i + capacity_, std::memory_order_release);
+                ++i;
+                if ( written) {
+                    ++popped;
+                    ++out;
+                }
+            }
+        } catch (...) {
+            // the claimed slots can not be given back - destroy the values
+            // not written to out and free the rest of the run, otherwise
+            // producers would wait forever at the first of them
+            for ( ; i < count; ++i) {
+                slot * s{ & slots_[(idx + i) & (capacity_ - 1)] };
+                if ( s->skipped) {
+                    s->skipped = false;
+                } else {
+                    reinterpret_cast< value_type * >( std::addressof( s->storage) )->~value_type();
+                }
+                s->cycle.store( idx + i + capacity_, std::memory_order_release);
+            }
+            notify_n_( waiting_producers_, select_producers_, producer_waiters_, count);
+            throw;
+        }
+        return popped;
+    }
+
+    // readies one fiber blocked in push() or, if there is none, one select()
+    // with a push case on this channel
+    void notify_producer_() {
+        if ( ! producer_waiters_.notify_needed() ) {
+            return;
+        }
+        lock_type lk{ splk_ };
+        if ( ! waiting_producers_.empty() ) {
+            context * producer_ctx{ & waiting_producers_.front() };
+            waiting_producers_.pop_front();
+            producer_waiters_.leave();
+            lk.unlock();
+            context::active()->set_ready( producer_ctx);
+            return;
+        }
+        detail::select_notify_one( select_producers_, producer_waiters_);
+    }
+
+    // readies one fiber blocked in pop() or, if there is none, one select()
+    // with a pop case on this channel
+    void notify_consumer_() {
+        if ( ! consumer_waiters_.notify_needed() ) {
+            return;
+        }
+        lock_type lk{ splk_ };
+        if ( ! waiting_consumers_.empty() ) {
+            context * consumer_ctx{ & waiting_consumers_.front() };
+            waiting_consumers_.pop_front();
+            consumer_waiters_.leave();
+            lk.unlock();
+            context::active()->set_ready( consumer_ctx);
+            return;
+        }
+        detail::select_notify_one( select_consumers_, consumer_waiters_);
+    }
+
+    // readies up to n fibers of queue (one batch per scheduler), the
+    // remaining notifications go to the select() calls of selectors
+    void notify_n_( wait_queue_type & queue, detail::select_queue & selectors,
+                    detail::waiter_count & count, std::size_t n) {
+        if ( ! count.notify_needed() ) {
+            return;
+        }
+        wait_queue_type waiters;
+        lock_type lk{ splk_ };
+        for ( ; 0 < n && ! queue.empty(); --n) {
+            context * ctx{ & queue.front() };
+            queue.pop_front();
+            count.leave();
+            ctx->wait_link( waiters);
+        }
+        while ( 0 < n && detail::select_notify_one( selectors, count) ) {
+            --n;
+        }
+        lk.unlock();
+        if ( ! waiters.empty() ) {
+            context::active()->set_ready_all( waiters);
+        }
+    }
+
+    // operations of the select() cases (see select.hpp)
+    channel_op_status select_try_pop_( value_type & value) {
+        channel_op_status status{ try_pop_( value) };
+        if ( channel_op_status::success == status) {
+            notify_producer_();
+        } else if ( is_closed() ) {
+            status = channel_op_status::closed;
+        }
+        return status;
+    }
+
+    template< typename ValueType >
+    channel_op_status select_try_push_( ValueType && value,
+                                        std::chrono::steady_clock::time_point const*) {
+        if ( is_closed() ) {
+            return channel_op_status::closed;
+        }
+        channel_op_status status{ try_push_( std::forward< ValueType >( value) ) };
+        if ( channel_op_status::success == status) {
+            notify_consumer_();
+        }
+        return status;
+    }
+
+    // links w unless the case became ready meanwhile
+    bool select_arm_( detail::select_waiter & w, bool push) {
+        lock_type lk{ splk_ };
+        detail::waiter_count & waiters = push ? producer_waiters_ : consumer_waiters_;
+        waiters.enter();
+        if ( is_closed() || ( push ? ! is_full_() : ! is_empty_() ) ) {
+            waiters.leave();
+            return false;
+        }
+        ( push ? select_producers_ : select_consumers_).push_back( w);
+        return true;
+    }
+
+    void select_disarm_( detail::select_waiter & w, bool push) noexcept {
+        // synchronizes with a notifier that might still access the
+        // select_state of w
+        lock_type lk{ splk_ };
+        if ( w.is_linked() ) {
+            w.unlink();
+            ( push ? producer_waiters_ : consumer_waiters_).leave();
+        }
+    }
+
+    template< typename >
+    friend class detail::select_pop_case;
+    template< typename, typename >
+    friend class detail::select_push_case;
+
 public:
     explicit buffered_channel( std::size_t capacity) :
         capacity_{ capacity } {
@@ -165,20 +417,24 @@ public:
 
     void close() noexcept {
         context * ctx{ context::active() };
-        detail::spinlock_lock lk{ splk_ };
+        lock_type lk{ splk_ };
         closed_.store( true, std::memory_order_release);
         // notify all waiting producers
         while ( ! waiting_producers_.empty() ) {
             context * producer_ctx{ & waiting_producers_.front() };
             waiting_producers_.pop_front();
+            producer_waiters_.leave();
             ctx->set_ready( producer_ctx);
         }
         // notify all waiting consumers
         while ( ! waiting_consumers_.empty() ) {
             context * consumer_ctx{ & waiting_consumers_.front() };
             waiting_consumers_.pop_front();
+            consumer_waiters_.leave();
             ctx->set_ready( consumer_ctx);
         }
+        detail::select_notify_all( select_producers_, producer_waiters_);
+        detail::select_notify_all( select_consumers_, consumer_waiters_);
     }
 
     channel_op_status try_push( value_type const& value) {
@@ -203,18 +459,13 @@ public:
             }
             channel_op_status status{ try_push_( value) };
             if ( channel_op_status::success == status) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    lk.unlock();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 return status;
             } else if ( channel_op_status::full == status) {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ producer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -222,6 +473,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                wg.release();
                 // suspend this producer
                 ctx->suspend( lk);
             } else {
@@ -239,18 +491,13 @@ public:
             }
             channel_op_status status{ try_push_( std::move( value) ) };
             if ( channel_op_status::success == status) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    lk.unlock();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 return status;
             } else if ( channel_op_status::full == status) {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ producer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -258,6 +505,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                wg.release();
                 // suspend this producer
                 ctx->suspend( lk);
             } else {
@@ -292,18 +540,13 @@ public:
             }
             channel_op_status status{ try_push_( value) };
             if ( channel_op_status::success == status) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    lk.unlock();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 return status;
             } else if ( channel_op_status::full == status) {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ producer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -311,12 +554,16 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                wg.release();
                 // suspend this producer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
                     lk.lock();
-                    // remove from waiting-queue
-                    ctx->wait_unlink();
+                    // remove from waiting-queue, unless a notifier did
+                    if ( ctx->wait_is_linked() ) {
+                        ctx->wait_unlink();
+                        producer_waiters_.leave();
+                    }
                     return channel_op_status::timeout;
                 }
             } else {
@@ -337,18 +584,13 @@ public:
             }
             channel_op_status status{ try_push_( std::move( value) ) };
             if ( channel_op_status::success == status) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    lk.unlock();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 return status;
             } else if ( channel_op_status::full == status) {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ producer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -356,12 +598,16 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                wg.release();
                 // suspend this producer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
                     lk.lock();
-                    // remove from waiting-queue
-                    ctx->wait_unlink();
+                    // remove from waiting-queue, unless a notifier did
+                    if ( ctx->wait_is_linked() ) {
+                        ctx->wait_unlink();
+                        producer_waiters_.leave();
+                    }
                     return channel_op_status::timeout;
                 }
             } else {
@@ -371,6 +617,43 @@ public:
         }
     }
 
+    // pushes the elements of [first,last), claiming as many slots as are
+    // free with one operation; blocks while the channel is full
+    // returns the number of pushed elements - less than the size of the
+    // range only if the channel was closed
+    template< typename ForwardIterator >
+    std::size_t push_n( ForwardIterator first, ForwardIterator last) {
+        context * ctx{ context::active() };
+        const std::size_t n{ static_cast< std::size_t >( std::distance( first, last) ) };
+        std::size_t pushed{ 0 };
+        while ( pushed < n) {
+            if ( is_closed() ) {
+                break;
+            }
+            std::size_t count{ try_push_n_( first, n - pushed) };
+            if ( 0 < count) {
+                pushed += count;
+                // notify waiting consumers, one for each pushed element
+                notify_n_( waiting_consumers_, select_consumers_, consumer_waiters_, count);
+                continue;
+            }
+            BOOST_ASSERT( ! ctx->wait_is_linked() );
+            lock_type lk{ splk_ };
+            detail::waiter_guard wg{ producer_waiters_ };
+            if ( is_closed() ) {
+                break;
+            }
+            if ( ! is_full_() ) {
+                continue;
+            }
+            ctx->wait_link( waiting_producers_);
+            wg.release();
+            // suspend this producer
+            ctx->suspend( lk);
+        }
+        return pushed;
+    }
+
     channel_op_status try_pop( value_type & value) {
         channel_op_status status{ try_pop_( value) };
         if ( channel_op_status::success != status) {
@@ -386,18 +669,13 @@ public:
         for (;;) {
             channel_op_status status{ try_pop_( value) };
             if ( channel_op_status::success == status) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting producer
-                if ( ! waiting_producers_.empty() ) {
-                    context * producer_ctx{ & waiting_producers_.front() };
-                    waiting_producers_.pop_front();
-                    lk.unlock();
-                    ctx->set_ready( producer_ctx);
-                }
+                notify_producer_();
                 return status;
             } else if ( channel_op_status::empty == status) {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ consumer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -405,6 +683,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                wg.release();
                 // suspend this consumer
                 ctx->suspend( lk);
             } else {
@@ -423,18 +702,13 @@ public:
             if ( channel_op_status::success == status) {
                 value_type value{ std::move( * reinterpret_cast< value_type * >( std::addressof( s->storage) ) ) };
                 s->cycle.store( idx + capacity_, std::memory_order_release);
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting producer
-                if ( ! waiting_producers_.empty() ) {
-                    context * producer_ctx{ & waiting_producers_.front() };
-                    waiting_producers_.pop_front();
-                    lk.unlock();
-                    ctx->set_ready( producer_ctx);
-                }
+                notify_producer_();
                 return std::move( value);
             } else if ( channel_op_status::empty == status) {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ consumer_waiters_ };
                 if ( is_closed() ) {
                     throw fiber_error{
                             std::make_error_code( std::errc::operation_not_permitted),
@@ -444,6 +718,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                wg.release();
                 // suspend this consumer
                 ctx->suspend( lk);
             } else {
@@ -470,18 +745,13 @@ public:
         for (;;) {
             channel_op_status status{ try_pop_( value) };
             if ( channel_op_status::success == status) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting producer
-                if ( ! waiting_producers_.empty() ) {
-                    context * producer_ctx{ & waiting_producers_.front() };
-                    waiting_producers_.pop_front();
-                    lk.unlock();
-                    context::active()->set_ready( producer_ctx);
-                }
+                notify_producer_();
                 return status;
             } else if ( channel_op_status::empty == status) {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ consumer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -489,12 +759,16 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                wg.release();
                 // suspend this consumer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
                     lk.lock();
-                    // remove from waiting-queue
-                    ctx->wait_unlink();
+                    // remove from waiting-queue, unless a notifier did
+                    if ( ctx->wait_is_linked() ) {
+                        ctx->wait_unlink();
+                        consumer_waiters_.leave();
+                    }
                     return channel_op_status::timeout;
                 }
             } else {
@@ -504,6 +778,44 @@ public:
         }
     }
 
+    // blocks until the channel is not empty, then pops up to max elements
+    // with one operation and writes them to out
+    // returns the number of popped elements, 0 if the channel is closed
+    // and empty
+    template< typename OutputIterator >
+    std::size_t pop_n( OutputIterator out, std::size_t max) {
+        context * ctx{ context::active() };
+        if ( 0 == max) {
+            return 0;
+        }
+        for (;;) {
+            std::size_t freed{ 0 };
+            std::size_t count{ try_pop_n_( out, max, freed) };
+            if ( 0 < freed) {
+                // notify waiting producers, one for each free slot
+                notify_n_( waiting_producers_, select_producers_, producer_waiters_, freed);
+                if ( 0 < count) {
+                    return count;
+                }
+                // the claimed slots were all skipped
+                continue;
+            }
+            BOOST_ASSERT( ! ctx->wait_is_linked() );
+            lock_type lk{ splk_ };
+            detail::waiter_guard wg{ consumer_waiters_ };
+            if ( is_closed() ) {
+                return 0;
+            }
+            if ( ! is_empty_() ) {
+                continue;
+            }
+            ctx->wait_link( waiting_consumers_);
+            wg.release();
+            // suspend this consumer
+            ctx->suspend( lk);
+        }
+    }
+
     class iterator : public std::iterator< std::input_iterator_tag, typename std::remove_reference< value_type >::type > {
     private:
         typedef typename std::aligned_storage< sizeof( value_type), alignof( value_type) >::type  storage_type;
@@ -526,7 +838,7 @@ public:
 
         iterator() noexcept = default;
 
-        explicit iterator( buffered_channel< T > * chan) noexcept :
+        explicit iterator( buffered_channel * chan) noexcept :
             chan_{ chan } {
             increment_();
         }
@@ -568,16 +880,16 @@ public:
     friend class iterator;
 };
 
-template< typename T >
-typename buffered_channel< T >::iterator
-begin( buffered_channel< T > & chan) {
-    return typename buffered_channel< T >::iterator( & chan);
+template< typename T, typename Spinlock >
+typename buffered_channel< T, Spinlock >::iterator
+begin( buffered_channel< T, Spinlock > & chan) {
+    return typename buffered_channel< T, Spinlock >::iterator( & chan);
 }
 
-template< typename T >
-typename buffered_channel< T >::iterator
-end( buffered_channel< T > &) {
-    return typename buffered_channel< T >::iterator();
+template< typename T, typename Spinlock >
+typename buffered_channel< T, Spinlock >::iterator
+end( buffered_channel< T, Spinlock > &) {
+    return typename buffered_channel< T, Spinlock >::iterator();
 }
 
 }}
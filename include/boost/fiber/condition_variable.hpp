@@ -19,6 +19,7 @@
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/profile.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
 #include <boost/fiber/exceptions.hpp>
 #include <boost/fiber/mutex.hpp>
@@ -47,13 +48,22 @@ private:
 
     wait_queue_t        wait_queue_{};
     detail::spinlock    wait_queue_splk_{};
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    detail::profile_record  *   profile_;
+#endif
 
 public:
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    condition_variable_any();
+
+    ~condition_variable_any();
+#else
     condition_variable_any() = default;
 
     ~condition_variable_any() {
         BOOST_ASSERT( wait_queue_.empty() );
     }
+#endif
 
     condition_variable_any( condition_variable_any const&) = delete;
     condition_variable_any & operator=( condition_variable_any const&) = delete;
@@ -65,6 +75,7 @@ public:
     template< typename LockType >
     void wait( LockType & lt) {
         context * ctx = context::active();
+        BOOST_FIBERS_PROFILE( const std::int64_t start = detail::profile_now(); )
         // atomically call lt.unlock() and block on *this
         // store this fiber in waiting-queue
         detail::spinlock_lock lk( wait_queue_splk_);
@@ -72,14 +83,9 @@ public:
         ctx->wait_link( wait_queue_);
         // unlock external lt
         lt.unlock();
-        // suspend this fiber
+        // suspend this fiber; notify_*() removed it from the waiting-queue
         ctx->suspend( lk);
-        // relock local lk
-        lk.lock();
-        // remove from waiting-queue
-        ctx->wait_unlink();
-        // unlock local lk
-        lk.unlock();
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
         // relock external again before returning
         try {
             lt.lock();
@@ -103,6 +109,7 @@ public:
         std::chrono::steady_clock::time_point timeout_time(
                 detail::convert( timeout_time_) );
         context * ctx = context::active();
+        BOOST_FIBERS_PROFILE( const std::int64_t start = detail::profile_now(); )
         // atomically call lt.unlock() and block on *this
         // store this fiber in waiting-queue
         detail::spinlock_lock lk( wait_queue_splk_);
@@ -113,13 +120,22 @@ public:
         // suspend this fiber
         if ( ! ctx->wait_until( timeout_time, lk) ) {
             status = cv_status::timeout;
+            // relock local lk
+            lk.lock();
+            // remove from waiting-queue if not notified meanwhile
+            if ( ctx->wait_is_linked() ) {
+                ctx->wait_unlink();
+            }
+            // unlock local lk
+            lk.unlock();
+        }
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+        if ( cv_status::timeout == status) {
+            detail::profile_waited( profile_, start);
+        } else {
+            detail::profile_acquired( profile_, start);
         }
-        // relock local lk
-        lk.lock();
-        // remove from waiting-queue
-        ctx->wait_unlink();
-        // unlock local lk
-        lk.unlock();
+#endif
         // relock external again before returning
         try {
             lt.lock();
@@ -158,93 +174,98 @@ public:
 
 class BOOST_FIBERS_DECL condition_variable {
 private:
-    condition_variable_any      cnd_;
+    typedef context::wait_queue_t   wait_queue_t;
+
+    wait_queue_t        wait_queue_{};
+    detail::spinlock    wait_queue_splk_{};
+    // mutex passed by the waiting fibers; notified fibers are moved to its
+    // wait-queue (wait morphing) instead of being readied just to block
+    // on the mutex again
+    mutex           *   mtx_{ nullptr };
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    detail::profile_record  *   profile_;
+#endif
+
+    void wait_( mutex &);
+
+    cv_status wait_until_( mutex &, std::chrono::steady_clock::time_point const&);
 
 public:
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    condition_variable();
+
+    ~condition_variable();
+#else
     condition_variable() = default;
 
+    ~condition_variable() {
+        BOOST_ASSERT( wait_queue_.empty() );
+    }
+#endif
+
     condition_variable( condition_variable const&) = delete;
     condition_variable & operator=( condition_variable const&) = delete;
 
-    void notify_one() noexcept {
-        cnd_.notify_one();
-    }
+    void notify_one() noexcept;
 
-    void notify_all() noexcept {
-        cnd_.notify_all();
-    }
+    void notify_all() noexcept;
 
     void wait( std::unique_lock< mutex > & lt) {
         // pre-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
-        cnd_.wait( lt);
+        BOOST_ASSERT( context::active() == lt.mutex()->state_.owner() );
+        wait_( * lt.mutex() );
         // post-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->state_.owner() );
     }
 
     template< typename Pred >
     void wait( std::unique_lock< mutex > & lt, Pred pred) {
-        // pre-condition
-        BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
-        cnd_.wait( lt, pred);
-        // post-condition
-        BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        while ( ! pred() ) {
+            wait( lt);
+        }
     }
 
     template< typename Clock, typename Duration >
     cv_status wait_until( std::unique_lock< mutex > & lt,
-                          std::chrono::time_point< Clock, Duration > const& timeout_time) {
+                          std::chrono::time_point< Clock, Duration > const& timeout_time_) {
         // pre-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
-        cv_status result = cnd_.wait_until( lt, timeout_time);
+        BOOST_ASSERT( context::active() == lt.mutex()->state_.owner() );
+        std::chrono::steady_clock::time_point timeout_time(
+                detail::convert( timeout_time_) );
+        cv_status result = wait_until_( * lt.mutex(), timeout_time);
         // post-condition
         BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
+        BOOST_ASSERT( context::active() == lt.mutex()->state_.owner() );
         return result;
     }
 
     template< typename Clock, typename Duration, typename Pred >
     bool wait_until( std::unique_lock< mutex > & lt,
                      std::chrono::time_point< Clock, Duration > const& timeout_time, Pred pred) {
-        // pre-condition
-        BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
-        bool result = cnd_.wait_until( lt, timeout_time, pred);
-        // post-condition
-        BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
-        return result;
+        while ( ! pred() ) {
+            if ( cv_status::timeout == wait_until( lt, timeout_time) ) {
+                return pred();
+            }
+        }
+        return true;
     }
 
     template< typename Rep, typename Period >
     cv_status wait_for( std::unique_lock< mutex > & lt,
                         std::chrono::duration< Rep, Period > const& timeout_duration) {
-        // pre-condition
-        BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
-        cv_status result = cnd_.wait_for( lt, timeout_duration);
-        // post-condition
-        BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
-        return result;
+        return wait_until( lt,
+                           std::chrono::steady_clock::now() + timeout_duration);
     }
 
     template< typename Rep, typename Period, typename Pred >
     bool wait_for( std::unique_lock< mutex > & lt,
                    std::chrono::duration< Rep, Period > const& timeout_duration, Pred pred) {
-        // pre-condition
-        BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
-        bool result = cnd_.wait_for( lt, timeout_duration, pred);
-        // post-condition
-        BOOST_ASSERT( lt.owns_lock() );
-        BOOST_ASSERT( context::active() == lt.mutex()->owner_);
-        return result;
+        return wait_until( lt,
+                           std::chrono::steady_clock::now() + timeout_duration,
+                           pred);
     }
 };
 
@@ -60,6 +60,8 @@ class scheduler;
 
 namespace detail {
 
+class context_ring_queue;
+
 struct wait_tag;
 typedef intrusive::list_member_hook<
     intrusive::tag< wait_tag >,
@@ -229,6 +231,9 @@ public:
     detail::wait_hook                       wait_hook_{};
     detail::worker_hook                     worker_hook_{};
     std::atomic< context * >                remote_nxt_{ nullptr };
+    // set while the context is stored in an array-based ready-queue
+    detail::context_ring_queue          *   ready_ring_{ nullptr };
+    std::size_t                             ready_ring_idx_{ 0 };
     std::chrono::steady_clock::time_point   tp_{ (std::chrono::steady_clock::time_point::max)() };
 
     typedef intrusive::list<
@@ -242,6 +247,10 @@ private:
     detail::spinlock                        splk_{};
     fiber_properties                    *   properties_{ nullptr };
 
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    static void set_remote_ready_( context *, wait_queue_t &) noexcept;
+#endif
+
 public:
     class id {
     private:
@@ -382,11 +391,17 @@ public:
     id get_id() const noexcept;
 
     void resume() noexcept;
-    void resume( detail::spinlock_lock &) noexcept;
+    void resume( detail::lock_ref const&) noexcept;
     void resume( context *) noexcept;
 
     void suspend() noexcept;
-    void suspend( detail::spinlock_lock &) noexcept;
+    void suspend( detail::lock_ref const&) noexcept;
+
+    // lk is released after this context has been suspended
+    template< typename LockType >
+    void suspend( LockType & lk) noexcept {
+        suspend( detail::lock_ref{ lk });
+    }
 
 #if (BOOST_EXECUTION_CONTEXT==1)
     void set_terminated() noexcept;
@@ -400,10 +415,24 @@ public:
 
     bool wait_until( std::chrono::steady_clock::time_point const&) noexcept;
     bool wait_until( std::chrono::steady_clock::time_point const&,
-                     detail::spinlock_lock &) noexcept;
+                     detail::lock_ref const&) noexcept;
+
+    template< typename LockType >
+    bool wait_until( std::chrono::steady_clock::time_point const& tp,
+                     LockType & lk) noexcept {
+        return wait_until( tp, detail::lock_ref{ lk });
+    }
 
     void set_ready( context *) noexcept;
 
+    // readies all contexts of the (unlinked) wait-queue; contexts belonging
+    // to the same remote scheduler are passed as one batch
+    void set_ready_all( wait_queue_t &) noexcept;
+
+    // as set_ready_all() but callable from any thread, even one that never
+    // ran a fiber; all contexts go through the remote ready-queues
+    static void set_remote_ready_all( wait_queue_t &) noexcept;
+
     bool is_context( type t) const noexcept {
         return type::none != ( type_ & t);
     }
@@ -446,6 +475,8 @@ public:
         lst.push_back( * this);
     }
 
+    void ready_link( detail::context_ring_queue &) noexcept;
+
     template< typename Set >
     void sleep_link( Set & set) noexcept {
         static_assert( std::is_same< typename Set::value_traits::hook_type,detail::sleep_hook >::value, "not a sleep-queue");
@@ -0,0 +1,95 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_COUNTING_SEMAPHORE_H
+#define BOOST_FIBERS_COUNTING_SEMAPHORE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+class BOOST_FIBERS_DECL counting_semaphore {
+private:
+    typedef context::wait_queue_t   wait_queue_t;
+
+    // bit 0 flags fibers in the wait-queue, the remaining bits count the
+    // available permits; the waiters bit is only set while no permits are
+    // available, released permits are handed over to the waiters directly
+    static constexpr std::size_t waiters_bit = 1;
+    static constexpr std::size_t permit_one = 2;
+
+    std::atomic< std::size_t >  value_;
+    wait_queue_t                wait_queue_{};
+    detail::spinlock            wait_queue_splk_{};
+
+    // called with the wait-queue spinlock held: takes a permit released
+    // meanwhile, otherwise sets the waiters bit
+    bool acquire_or_wait_() noexcept;
+
+    bool try_acquire_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept;
+
+public:
+    explicit counting_semaphore( std::size_t permits = 0) noexcept :
+        value_{ permits * permit_one } {
+    }
+
+    ~counting_semaphore() {
+        BOOST_ASSERT( wait_queue_.empty() );
+    }
+
+    counting_semaphore( counting_semaphore const&) = delete;
+    counting_semaphore & operator=( counting_semaphore const&) = delete;
+
+    void acquire();
+
+    bool try_acquire() noexcept;
+
+    template< typename Clock, typename Duration >
+    bool try_acquire_until( std::chrono::time_point< Clock, Duration > const& timeout_time_) {
+        std::chrono::steady_clock::time_point timeout_time(
+                detail::convert( timeout_time_) );
+        return try_acquire_until_( timeout_time);
+    }
+
+    template< typename Rep, typename Period >
+    bool try_acquire_for( std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return try_acquire_until_( std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    // wakes up to n waiters, the remaining permits become available
+    void release( std::size_t n = 1) noexcept;
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_COUNTING_SEMAPHORE_H
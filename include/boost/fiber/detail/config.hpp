@@ -55,6 +55,23 @@
 # define BOOST_FIBERS_SPIN_MAX_TESTS 100
 #endif
 
+// waiting time (microseconds) after which a barging fibers::mutex falls
+// back to handing the lock over in FIFO order
+#if !defined(BOOST_FIBERS_MUTEX_STARVATION_THRESHOLD)
+# define BOOST_FIBERS_MUTEX_STARVATION_THRESHOLD 1000
+#endif
+
+// upper limit of helper threads executing fibers::offload()
+#if !defined(BOOST_FIBERS_OFFLOAD_MAX_THREADS)
+# define BOOST_FIBERS_OFFLOAD_MAX_THREADS 32
+#endif
+
+// number of wait-queues fibers::atomic_wait() hashes addresses to
+// (must be a power of two)
+#if !defined(BOOST_FIBERS_ATOMIC_WAIT_BUCKETS)
+# define BOOST_FIBERS_ATOMIC_WAIT_BUCKETS 256
+#endif
+
 // modern architectures have cachelines with 64byte length
 // ARM Cortex-A15 32/64byte, Cortex-A9 16/32/64bytes
 // MIPS 74K: 32byte, 4KEc: 16byte
@@ -65,6 +65,16 @@ public:
         prev->remote_nxt_.store( ctx, std::memory_order_release);
     }
 
+    // pushes the contexts first .. last, already chained via remote_nxt_,
+    // with one exchange
+    void push( context * first, context * last) noexcept {
+        BOOST_ASSERT( nullptr != first);
+        BOOST_ASSERT( nullptr != last);
+        last->remote_nxt_.store( nullptr, std::memory_order_release);
+        context * prev = head_.exchange( last, std::memory_order_acq_rel);
+        prev->remote_nxt_.store( first, std::memory_order_release);
+    }
+
     context * pop() noexcept {
         context * tail = tail_;
         context * next = tail->remote_nxt_.load( std::memory_order_acquire);
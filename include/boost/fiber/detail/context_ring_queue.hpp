@@ -0,0 +1,173 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_CONTEXT_RING_QUEUE_H
+#define BOOST_FIBERS_DETAIL_CONTEXT_RING_QUEUE_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/intrusive/list.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/prefetch.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// a FIFO of context pointers stored in a contiguous, growable ring
+// only accessed by the thread owning the scheduler
+// contexts do not need to be touched by push()/pop() - an intrusive
+// list would dereference the neighbours living on other fiber stacks
+//
+// the ring registers itself in context::ready_ring_ so that
+// context::ready_is_linked() and context::ready_unlink() keep working;
+// unlinking leaves a hole (nullptr) which is skipped by pop()
+//
+// push() must not fail - it is called from algorithm::awakened(); if the
+// ring can not grow, contexts are appended to an intrusive list instead
+// until the ring has drained
+class context_ring_queue {
+private:
+    typedef intrusive::list<
+                context,
+                intrusive::member_hook<
+                    context, detail::ready_hook, & context::ready_hook_ >,
+                intrusive::constant_time_size< false > >    overflow_t;
+
+    std::size_t                     capacity_;
+    std::unique_ptr< context *[] >  slots_;
+    // head_ and tail_ are monotonic; the slot is selected by masking,
+    // which keeps context::ready_ring_idx_ valid if the ring grows
+    std::size_t                     head_{ 0 };
+    std::size_t                     tail_{ 0 };
+    // number of linked contexts (holes are not counted)
+    std::size_t                     size_{ 0 };
+    // contexts pushed after growing the ring failed, queued behind the ring
+    overflow_t                      overflow_{};
+
+    context *& slot_( std::size_t idx) const noexcept {
+        return slots_[idx & ( capacity_ - 1)];
+    }
+
+    bool grow_() noexcept {
+        std::size_t capacity = 2 * capacity_;
+        std::unique_ptr< context *[] > slots{ new ( std::nothrow) context *[capacity] };
+        if ( ! slots) {
+            return false;
+        }
+        for ( std::size_t i = head_; i != tail_; ++i) {
+            slots[i & ( capacity - 1)] = slot_( i);
+        }
+        slots_.swap( slots);
+        capacity_ = capacity;
+        return true;
+    }
+
+    void skip_holes_() noexcept {
+        while ( head_ != tail_ && nullptr == slot_( head_) ) {
+            ++head_;
+        }
+    }
+
+public:
+    // capacity must be a power of two
+    explicit context_ring_queue( std::size_t capacity = 64) :
+        capacity_{ capacity },
+        slots_{ new context *[capacity] } {
+        BOOST_ASSERT( 0 < capacity_);
+        BOOST_ASSERT( 0 == ( capacity_ & ( capacity_ - 1) ) );
+    }
+
+    context_ring_queue( context_ring_queue const&) = delete;
+    context_ring_queue & operator=( context_ring_queue const&) = delete;
+
+    bool empty() const noexcept {
+        return 0 == size_;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    void push( context * ctx) noexcept {
+        BOOST_ASSERT( nullptr != ctx);
+        BOOST_ASSERT( ! ctx->ready_is_linked() );
+        ctx->ready_ring_ = this;
+        ++size_;
+        if ( ! overflow_.empty() ) {
+            // keep FIFO order
+            overflow_.push_back( * ctx);
+            return;
+        }
+        if ( capacity_ == tail_ - head_) {
+            // drop leading holes before paying for a resize
+            skip_holes_();
+            if ( capacity_ == tail_ - head_ && ! grow_() ) {
+                overflow_.push_back( * ctx);
+                return;
+            }
+        }
+        ctx->ready_ring_idx_ = tail_;
+        slot_( tail_++) = ctx;
+    }
+
+    context * pop() noexcept {
+        skip_holes_();
+        if ( head_ == tail_) {
+            if ( overflow_.empty() ) {
+                return nullptr;
+            }
+            context * ctx = & overflow_.front();
+            overflow_.pop_front();
+            ctx->ready_ring_ = nullptr;
+            --size_;
+            return ctx;
+        }
+        context * ctx = slot_( head_++);
+        BOOST_ASSERT( nullptr != ctx);
+        BOOST_ASSERT( this == ctx->ready_ring_);
+        ctx->ready_ring_ = nullptr;
+        --size_;
+        // the successor is resumed on one of the next dispatch rounds;
+        // fetch its control block while the popped context runs
+        skip_holes_();
+        if ( head_ != tail_) {
+            prefetch( slot_( head_) );
+        }
+        return ctx;
+    }
+
+    void erase( context * ctx) noexcept {
+        BOOST_ASSERT( nullptr != ctx);
+        BOOST_ASSERT( this == ctx->ready_ring_);
+        if ( ctx->ready_hook_.is_linked() ) {
+            // stored in the overflow list
+            ctx->ready_hook_.unlink();
+        } else {
+            BOOST_ASSERT( ctx == slot_( ctx->ready_ring_idx_) );
+            slot_( ctx->ready_ring_idx_) = nullptr;
+        }
+        ctx->ready_ring_ = nullptr;
+        --size_;
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_CONTEXT_RING_QUEUE_H
@@ -23,14 +23,38 @@ class context;
 
 namespace detail {
 
+// lock held by the suspending context, released by the resumed context
+// after the switch; type-erased, so that primitives can pick their spinlock
+class lock_ref {
+private:
+    void    *   lk_;
+    void    ( * unlock_)( void *);
+
+    template< typename LockType >
+    static void do_unlock_( void * lk) {
+        static_cast< LockType * >( lk)->unlock();
+    }
+
+public:
+    template< typename LockType >
+    explicit lock_ref( LockType & lk) noexcept :
+        lk_{ & lk },
+        unlock_{ & lock_ref::do_unlock_< LockType > } {
+    }
+
+    void unlock() const noexcept {
+        unlock_( lk_);
+    }
+};
+
 #if (BOOST_EXECUTION_CONTEXT==1)
 struct data_t {
-    spinlock_lock   *   lk{ nullptr };
+    lock_ref const  *   lk{ nullptr };
     context         *   ctx{ nullptr };
 
     data_t() noexcept = default;
 
-    explicit data_t( spinlock_lock * lk_) noexcept :
+    explicit data_t( lock_ref const* lk_) noexcept :
         lk{ lk_ } {
     }
 
@@ -40,7 +64,7 @@ struct data_t {
 };
 #else
 struct data_t {
-    spinlock_lock   *   lk{ nullptr };
+    lock_ref const  *   lk{ nullptr };
     context         *   ctx{ nullptr };
     context         *   from;
 
@@ -48,7 +72,7 @@ struct data_t {
         from{ from_ } {
     }
 
-    explicit data_t( spinlock_lock * lk_,
+    explicit data_t( lock_ref const* lk_,
                      context * from_) noexcept :
         lk{ lk_ },
         from{ from_ } {
@@ -7,6 +7,10 @@
 #ifndef BOOST_FIBERS_DETAIL_FUTEX_H
 #define BOOST_FIBERS_DETAIL_FUTEX_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
 #include <boost/config.hpp>
 #include <boost/predef.h> 
 
@@ -16,6 +20,8 @@
 extern "C" {
 #include <linux/futex.h>
 #include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
 }
 #elif BOOST_OS_WINDOWS
 #include <Windows.h>
@@ -40,6 +46,16 @@ inline
 int futex_wait( std::atomic< std::int32_t > * addr, std::int32_t x) {
     return 0 <= sys_futex( static_cast< void * >( addr), FUTEX_WAIT_PRIVATE, x) ? 0 : -1;
 }
+
+// blocks at most for timeout (measured against CLOCK_MONOTONIC)
+inline
+int futex_wait_for( std::atomic< std::int32_t > * addr, std::int32_t x, std::chrono::nanoseconds timeout) {
+    const std::chrono::seconds secs = std::chrono::duration_cast< std::chrono::seconds >( timeout);
+    ::timespec ts;
+    ts.tv_sec = static_cast< ::time_t >( secs.count() );
+    ts.tv_nsec = static_cast< long >( ( timeout - secs).count() );
+    return 0 <= ::syscall( SYS_futex, static_cast< void * >( addr), FUTEX_WAIT_PRIVATE, x, & ts, nullptr, 0) ? 0 : -1;
+}
 #elif BOOST_OS_WINDOWS
 inline
 int futex_wake( std::atomic< std::int32_t > * addr) {
@@ -52,6 +68,13 @@ int futex_wait( std::atomic< std::int32_t > * addr, std::int32_t x) {
     ::WaitOnAddress( static_cast< volatile void * >( addr), & x, sizeof( x), -1);
     return 0;
 }
+
+inline
+int futex_wait_for( std::atomic< std::int32_t > * addr, std::int32_t x, std::chrono::nanoseconds timeout) {
+    // milliseconds, rounded up
+    const DWORD ms = static_cast< DWORD >( ( timeout.count() + 999999) / 1000000);
+    return ::WaitOnAddress( static_cast< volatile void * >( addr), & x, sizeof( x), ms) ? 0 : -1;
+}
 #else
 # warn "no futex support on this platform"
 #endif
@@ -0,0 +1,61 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_LOCK_INHERITANCE_H
+#define BOOST_FIBERS_DETAIL_LOCK_INHERITANCE_H
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// reports the waiters of a fiber mutex to the algorithm of the owner
+// (priority inheritance) without walking the wait-queue: the mutex
+// remembers the waiter whose priority the owner inherited last
+// ("booster"), which is the most urgent of the reported waiters - a new
+// owner inherits from the booster, or from the next waiter in line if the
+// booster left the wait-queue
+// all member functions must be called with the wait-queue spinlock of the
+// mutex held
+class BOOST_FIBERS_DECL lock_inheritance {
+private:
+    context     *   booster_{ nullptr };
+
+public:
+    lock_inheritance() = default;
+
+    lock_inheritance( lock_inheritance const&) = delete;
+    lock_inheritance & operator=( lock_inheritance const&) = delete;
+
+    // waiter is going to block on the mutex held by owner
+    void contended( context * owner, context * waiter) noexcept;
+
+    // owner released the mutex and removed waiter from the wait-queue in
+    // order to hand the mutex over or to wake it
+    void released( context * owner, context * waiter) noexcept;
+
+    // new_owner acquired the mutex while fibers are still waiting
+    void acquired( context * new_owner, context::wait_queue_t & waiters) noexcept;
+
+    // waiter left the wait-queue without getting the mutex (timed out);
+    // the owner has to drop a priority inherited from it
+    void withdrawn( context * owner, context * waiter, context::wait_queue_t & waiters) noexcept;
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_LOCK_INHERITANCE_H
@@ -0,0 +1,179 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_LOCK_WORD_H
+#define BOOST_FIBERS_DETAIL_LOCK_WORD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/cpu_relax.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+class context;
+
+namespace detail {
+
+// state of a fiber mutex in one word: the owning context, bit 0 flags
+// fibers blocked in the wait-queue
+// lock and unlock without contention are a single CAS; the wait-queue
+// (and its spinlock) is only touched if the waiters bit is set
+// the waiters bit is set and cleared with the wait-queue spinlock held,
+// it is set if and only if the wait-queue is not empty
+class lock_word {
+private:
+    static constexpr std::uintptr_t waiters_bit = 1;
+
+    std::atomic< std::uintptr_t >   value_{ 0 };
+    // estimated number of spins after which a lock held by a fiber
+    // running in another thread becomes free
+    std::atomic< std::size_t >      spins_{ 0 };
+
+public:
+    lock_word() = default;
+
+    lock_word( lock_word const&) = delete;
+    lock_word & operator=( lock_word const&) = delete;
+
+    context * owner() const noexcept {
+        return reinterpret_cast< context * >(
+                value_.load( std::memory_order_relaxed) & ~waiters_bit);
+    }
+
+    bool has_waiters() const noexcept {
+        return 0 != ( value_.load( std::memory_order_relaxed) & waiters_bit);
+    }
+
+    bool try_acquire( context * ctx) noexcept {
+        BOOST_ASSERT( 0 == ( reinterpret_cast< std::uintptr_t >( ctx) & waiters_bit) );
+        std::uintptr_t expected = 0;
+        return value_.compare_exchange_strong(
+                expected, reinterpret_cast< std::uintptr_t >( ctx),
+                std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    // fails if fibers are waiting - the lock must be handed over
+    bool try_release( context * ctx) noexcept {
+        std::uintptr_t expected = reinterpret_cast< std::uintptr_t >( ctx);
+        return value_.compare_exchange_strong(
+                expected, 0,
+                std::memory_order_release, std::memory_order_relaxed);
+    }
+
+    // adaptive spinning before parking: pays off if the owner runs in
+    // another thread and releases the lock soon; the spin budget shrinks
+    // if spinning fails (e.g. the owner is a suspended fiber of this thread)
+    bool spin( context * ctx) noexcept {
+#if ! defined(BOOST_FIBERS_SPIN_SINGLE_CORE)
+        const std::size_t prev_spins = spins_.load( std::memory_order_relaxed);
+        const std::size_t max_spins = (std::min)(
+                static_cast< std::size_t >( BOOST_FIBERS_SPIN_MAX_TESTS), 2 * prev_spins + 8);
+        for ( std::size_t spins = 0; spins < max_spins; ++spins) {
+            std::uintptr_t value = value_.load( std::memory_order_relaxed);
+            if ( 0 != ( value & waiters_bit) ) {
+                // others are already parked - queue up behind them
+                break;
+            }
+            if ( 0 == value && try_acquire( ctx) ) {
+                spins_.store( spins >= prev_spins
+                                ? prev_spins + ( spins - prev_spins) / 8
+                                : prev_spins - ( prev_spins - spins) / 8,
+                              std::memory_order_relaxed);
+                return true;
+            }
+            cpu_relax();
+        }
+        spins_.store( prev_spins / 2, std::memory_order_relaxed);
+#endif
+        return false;
+    }
+
+    // barging: acquires the lock if it is not owned, even if fibers are
+    // waiting (the waiters bit is kept)
+    bool try_barge( context * ctx) noexcept {
+        std::uintptr_t value = value_.load( std::memory_order_relaxed);
+        while ( 0 == ( value & ~waiters_bit) ) {
+            if ( value_.compare_exchange_weak(
+                        value, reinterpret_cast< std::uintptr_t >( ctx) | value,
+                        std::memory_order_acquire, std::memory_order_relaxed) ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // called with the wait-queue spinlock held: acquires the lock if it has
+    // been released meanwhile (if barge is set, even if fibers are waiting),
+    // otherwise sets the waiters bit
+    bool acquire_or_wait( context * ctx, bool barge = false) noexcept {
+        std::uintptr_t value = value_.load( std::memory_order_relaxed);
+        for (;;) {
+            if ( 0 == value || ( barge && waiters_bit == value) ) {
+                if ( value_.compare_exchange_weak(
+                            value, reinterpret_cast< std::uintptr_t >( ctx) | value,
+                            std::memory_order_acquire, std::memory_order_relaxed) ) {
+                    return true;
+                }
+            } else if ( 0 != ( value & waiters_bit) ||
+                        value_.compare_exchange_weak(
+                            value, value | waiters_bit,
+                            std::memory_order_relaxed, std::memory_order_relaxed) ) {
+                return false;
+            }
+        }
+    }
+
+    // called with the wait-queue spinlock held: passes ownership to the
+    // first waiter (or releases the lock if next is nullptr)
+    void hand_over( context * next, bool waiters) noexcept {
+        value_.store(
+                reinterpret_cast< std::uintptr_t >( next) | ( waiters ? waiters_bit : 0),
+                std::memory_order_release);
+    }
+
+    // called with the wait-queue spinlock held before fibers are moved to
+    // the wait-queue (wait morphing): sets the waiters bit if the lock is
+    // owned, fails if it is free
+    bool wait_if_owned() noexcept {
+        std::uintptr_t value = value_.load( std::memory_order_relaxed);
+        for (;;) {
+            if ( 0 == value) {
+                return false;
+            }
+            if ( 0 != ( value & waiters_bit) ||
+                 value_.compare_exchange_weak(
+                    value, value | waiters_bit,
+                    std::memory_order_relaxed, std::memory_order_relaxed) ) {
+                return true;
+            }
+        }
+    }
+
+    // called with the wait-queue spinlock held if the last waiter left
+    // the wait-queue without becoming owner (timeout)
+    void clear_waiters() noexcept {
+        value_.fetch_and( ~waiters_bit, std::memory_order_relaxed);
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_LOCK_WORD_H
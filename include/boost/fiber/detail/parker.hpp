@@ -0,0 +1,112 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_PARKER_H
+#define BOOST_FIBERS_DETAIL_PARKER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#if defined(BOOST_FIBERS_HAS_FUTEX)
+# include <boost/fiber/detail/futex.hpp>
+#else
+# include <condition_variable>
+# include <mutex>
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// blocks the thread of an idle scheduler until unpark() is called or a
+// deadline is reached; an unpark() preceding park_until() is not lost
+// only the scheduler's thread parks, any thread might unpark
+class BOOST_FIBERS_DECL parker {
+private:
+#if defined(BOOST_FIBERS_HAS_FUTEX)
+    enum : std::int32_t {
+        parked = -1,
+        empty = 0,
+        notified = 1
+    };
+
+    std::atomic< std::int32_t >     state_{ empty };
+#else
+    std::mutex                      mtx_{};
+    std::condition_variable         cnd_{};
+    bool                            flag_{ false };
+#endif
+
+public:
+    // compiled into the library: applies the timer slack the library was
+    // built with (BOOST_FIBERS_TIMER_SLACK)
+    parker() noexcept;
+
+    parker( parker const&) = delete;
+    parker & operator=( parker const&) = delete;
+
+#if defined(BOOST_FIBERS_HAS_FUTEX)
+    void park_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+        if ( notified == state_.fetch_sub( 1, std::memory_order_acquire) ) {
+            // consumed a pending notification
+            return;
+        }
+        if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
+            while ( parked == state_.load( std::memory_order_acquire) ) {
+                futex_wait( & state_, parked);
+            }
+        } else {
+            while ( parked == state_.load( std::memory_order_acquire) ) {
+                const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                if ( now >= time_point) {
+                    break;
+                }
+                futex_wait_for( & state_, parked, time_point - now);
+            }
+        }
+        // consumes a notification that arrived meanwhile
+        state_.exchange( empty, std::memory_order_acquire);
+    }
+
+    void unpark() noexcept {
+        if ( parked == state_.exchange( notified, std::memory_order_release) ) {
+            futex_wake( & state_);
+        }
+    }
+#else
+    void park_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+        std::unique_lock< std::mutex > lk( mtx_);
+        if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
+            cnd_.wait( lk, [this](){ return flag_; });
+        } else {
+            cnd_.wait_until( lk, time_point, [this](){ return flag_; });
+        }
+        flag_ = false;
+    }
+
+    void unpark() noexcept {
+        std::unique_lock< std::mutex > lk( mtx_);
+        flag_ = true;
+        lk.unlock();
+        cnd_.notify_all();
+    }
+#endif
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_PARKER_H
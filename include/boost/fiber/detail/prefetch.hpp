@@ -0,0 +1,49 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_PREFETCH_H
+#define BOOST_FIBERS_DETAIL_PREFETCH_H
+
+#include <boost/config.hpp>
+#include <boost/predef.h>
+
+#include <boost/fiber/detail/config.hpp>
+
+#if BOOST_COMP_MSVC && (BOOST_ARCH_X86_32 || BOOST_ARCH_X86_64)
+# include <xmmintrin.h>
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+#if BOOST_COMP_GNUC || BOOST_COMP_CLANG || BOOST_COMP_INTEL
+BOOST_FORCEINLINE
+void prefetch( void * addr) noexcept {
+    // read access, keep in all levels of cache
+    __builtin_prefetch( addr, 0, 3);
+}
+#elif BOOST_COMP_MSVC && (BOOST_ARCH_X86_32 || BOOST_ARCH_X86_64)
+BOOST_FORCEINLINE
+void prefetch( void * addr) noexcept {
+    ::_mm_prefetch( static_cast< const char * >( addr), _MM_HINT_T0);
+}
+#else
+BOOST_FORCEINLINE
+void prefetch( void *) noexcept {
+}
+#endif
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_PREFETCH_H
@@ -0,0 +1,122 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_PROFILE_H
+#define BOOST_FIBERS_DETAIL_PROFILE_H
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+// contention profiling of the synchronization primitives is opt-in: the
+// library and the code using it have to be compiled with
+// BOOST_FIBERS_PROFILE_CONTENTION defined, otherwise the hooks vanish
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+# define BOOST_FIBERS_PROFILE(x) x
+#else
+# define BOOST_FIBERS_PROFILE(x)
+#endif
+
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if BOOST_COMP_MSVC
+# include <intrin.h>
+# define BOOST_FIBERS_RETURN_ADDRESS() _ReturnAddress()
+#elif defined(__GNUC__)
+# define BOOST_FIBERS_RETURN_ADDRESS() __builtin_return_address( 0)
+#else
+# define BOOST_FIBERS_RETURN_ADDRESS() nullptr
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// statistics of one primitive instance; times are nanoseconds
+// the counters are updated by fibers of any thread, acquired_at only by
+// the current owner
+class profile_record {
+public:
+    char const                  *   kind;
+    void const                  *   object;
+    // code address the primitive was constructed from
+    void const                  *   site;
+    std::atomic< std::uint64_t >    acquisitions{ 0 };
+    std::atomic< std::uint64_t >    contentions{ 0 };
+    std::atomic< std::uint64_t >    wait_total{ 0 };
+    std::atomic< std::uint64_t >    wait_max{ 0 };
+    std::atomic< std::uint64_t >    hold_total{ 0 };
+    std::atomic< std::int64_t >     acquired_at{ 0 };
+
+    profile_record( char const* kind_, void const* object_, void const* site_) noexcept :
+        kind{ kind_ },
+        object{ object_ },
+        site{ site_ } {
+    }
+};
+
+BOOST_FIBERS_DECL
+profile_record * profile_register( void const*, char const*, void const*);
+
+// folds the statistics into the per-site totals and frees the record
+BOOST_FIBERS_DECL
+void profile_unregister( profile_record *) noexcept;
+
+inline
+std::int64_t profile_now() noexcept {
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(
+            std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+inline
+void profile_waited( profile_record * r, std::int64_t start) noexcept {
+    const std::uint64_t wait = static_cast< std::uint64_t >( profile_now() - start);
+    r->contentions.fetch_add( 1, std::memory_order_relaxed);
+    r->wait_total.fetch_add( wait, std::memory_order_relaxed);
+    std::uint64_t max = r->wait_max.load( std::memory_order_relaxed);
+    while ( max < wait &&
+            ! r->wait_max.compare_exchange_weak( max, wait, std::memory_order_relaxed) ) {
+    }
+}
+
+// acquired without blocking
+inline
+void profile_acquired( profile_record * r) noexcept {
+    r->acquisitions.fetch_add( 1, std::memory_order_relaxed);
+    r->acquired_at.store( profile_now(), std::memory_order_relaxed);
+}
+
+// acquired after blocking since start
+inline
+void profile_acquired( profile_record * r, std::int64_t start) noexcept {
+    profile_waited( r, start);
+    profile_acquired( r);
+}
+
+inline
+void profile_released( profile_record * r) noexcept {
+    r->hold_total.fetch_add(
+            static_cast< std::uint64_t >(
+                profile_now() - r->acquired_at.load( std::memory_order_relaxed) ),
+            std::memory_order_relaxed);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_PROFILE_H
@@ -0,0 +1,112 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_SELECT_WAITER_H
+#define BOOST_FIBERS_DETAIL_SELECT_WAITER_H
+
+#include <cstddef>
+#include <limits>
+
+#include <boost/config.hpp>
+#include <boost/intrusive/list.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/detail/waiter_count.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+class context;
+
+namespace detail {
+
+template< typename Channel >
+class select_pop_case;
+
+template< typename Channel, typename ValueType >
+class select_push_case;
+
+// state of one select() call, lives on the stack of the selecting fiber
+// a context has only one wait-hook, so select() links one select_waiter
+// per case into the channels instead of the context itself; the first
+// channel that fires the state wakes the fiber, later attempts fail and
+// the channel passes its notification on to the next waiter
+class BOOST_FIBERS_DECL select_state {
+public:
+    static constexpr std::size_t none = (std::numeric_limits< std::size_t >::max)();
+
+    context         *   ctx;
+    spinlock            splk{};
+    // index of the case the fiber was woken for
+    std::size_t         fired{ none };
+    // the fiber is suspended (or about to), firing has to resume it
+    bool                sleeping{ false };
+
+    explicit select_state( context * ctx_) noexcept :
+        ctx{ ctx_ } {
+    }
+
+    select_state( select_state const&) = delete;
+    select_state & operator=( select_state const&) = delete;
+
+    // called by a channel while it holds its lock; returns false if the
+    // fiber was already woken by another case (or timed out)
+    bool fire( std::size_t index) noexcept;
+};
+
+// the record select() links into the waiter list of a channel for one case;
+// linked and unlinked only with the lock of that channel held
+struct select_waiter : public intrusive::list_base_hook<
+                                    intrusive::link_mode<
+                                        intrusive::auto_unlink
+                                    >
+                              > {
+    select_state    *   state{ nullptr };
+    std::size_t         index{ 0 };
+};
+
+typedef intrusive::list<
+    select_waiter,
+    intrusive::constant_time_size< false >
+>                                           select_queue;
+
+// wakes the first select() of queue that was not woken by another case;
+// the lock of the channel owning queue must be held
+inline
+bool select_notify_one( select_queue & queue, waiter_count & waiters) noexcept {
+    while ( ! queue.empty() ) {
+        select_waiter & w = queue.front();
+        queue.pop_front();
+        waiters.leave();
+        if ( w.state->fire( w.index) ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline
+void select_notify_all( select_queue & queue, waiter_count & waiters) noexcept {
+    while ( ! queue.empty() ) {
+        select_waiter & w = queue.front();
+        queue.pop_front();
+        waiters.leave();
+        w.state->fire( w.index);
+    }
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_SELECT_WAITER_H
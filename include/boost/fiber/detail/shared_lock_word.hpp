@@ -0,0 +1,200 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_SHARED_LOCK_WORD_H
+#define BOOST_FIBERS_DETAIL_SHARED_LOCK_WORD_H
+
+#include <atomic>
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+class context;
+
+namespace detail {
+
+// state of a fiber shared mutex in one word: bit 0 flags exclusive
+// ownership, bit 1 flags fibers blocked in one of the wait-queues, the
+// remaining bits count the shared owners
+// lock_shared()/unlock_shared() without a writer are a single CAS on the
+// reader count; the wait-queues (and their spinlock) are only touched if
+// the waiters bit is set
+// the waiters bit is set and cleared with the wait-queue spinlock held,
+// it is set if and only if one of the wait-queues is not empty; new
+// readers are blocked while it is set, hence a queued writer can not be
+// starved by a stream of readers
+class shared_lock_word {
+private:
+    static constexpr std::size_t writer_bit = 1;
+    static constexpr std::size_t waiters_bit = 2;
+    static constexpr std::size_t reader_one = 4;
+
+    std::atomic< std::size_t >      value_{ 0 };
+    // exclusive owner, only used to detect deadlocks and misuse
+    std::atomic< context * >        owner_{ nullptr };
+
+public:
+    shared_lock_word() = default;
+
+    shared_lock_word( shared_lock_word const&) = delete;
+    shared_lock_word & operator=( shared_lock_word const&) = delete;
+
+    context * owner() const noexcept {
+        return owner_.load( std::memory_order_relaxed);
+    }
+
+    std::size_t readers() const noexcept {
+        return value_.load( std::memory_order_relaxed) / reader_one;
+    }
+
+    bool has_writer() const noexcept {
+        return 0 != ( value_.load( std::memory_order_relaxed) & writer_bit);
+    }
+
+    bool try_acquire( context * ctx) noexcept {
+        std::size_t expected = 0;
+        if ( value_.compare_exchange_strong(
+                    expected, writer_bit,
+                    std::memory_order_acquire, std::memory_order_relaxed) ) {
+            owner_.store( ctx, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    // fails if fibers are waiting - the lock must be handed over
+    bool try_release() noexcept {
+        owner_.store( nullptr, std::memory_order_relaxed);
+        std::size_t expected = writer_bit;
+        return value_.compare_exchange_strong(
+                expected, 0,
+                std::memory_order_release, std::memory_order_relaxed);
+    }
+
+    // fails if the lock is held exclusively or fibers are waiting
+    bool try_acquire_shared() noexcept {
+        std::size_t value = value_.load( std::memory_order_relaxed);
+        while ( 0 == ( value & ( writer_bit | waiters_bit) ) ) {
+            if ( value_.compare_exchange_weak(
+                        value, value + reader_one,
+                        std::memory_order_acquire, std::memory_order_relaxed) ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // fails if fibers are waiting - a writer might have to be woken up
+    bool try_release_shared() noexcept {
+        std::size_t value = value_.load( std::memory_order_relaxed);
+        while ( 0 == ( value & waiters_bit) ) {
+            BOOST_ASSERT( reader_one <= value);
+            if ( value_.compare_exchange_weak(
+                        value, value - reader_one,
+                        std::memory_order_release, std::memory_order_relaxed) ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // called with the wait-queue spinlock held: acquires the lock if it
+    // has been released meanwhile, otherwise sets the waiters bit
+    bool acquire_or_wait( context * ctx) noexcept {
+        std::size_t value = value_.load( std::memory_order_relaxed);
+        for (;;) {
+            if ( 0 == value) {
+                if ( value_.compare_exchange_weak(
+                            value, writer_bit,
+                            std::memory_order_acquire, std::memory_order_relaxed) ) {
+                    owner_.store( ctx, std::memory_order_relaxed);
+                    return true;
+                }
+            } else if ( 0 != ( value & waiters_bit) ||
+                        value_.compare_exchange_weak(
+                            value, value | waiters_bit,
+                            std::memory_order_relaxed, std::memory_order_relaxed) ) {
+                return false;
+            }
+        }
+    }
+
+    // called with the wait-queue spinlock held: joins the shared owners if
+    // neither a writer owns nor fibers wait, otherwise sets the waiters bit
+    bool acquire_shared_or_wait() noexcept {
+        std::size_t value = value_.load( std::memory_order_relaxed);
+        for (;;) {
+            if ( 0 == ( value & ( writer_bit | waiters_bit) ) ) {
+                if ( value_.compare_exchange_weak(
+                            value, value + reader_one,
+                            std::memory_order_acquire, std::memory_order_relaxed) ) {
+                    return true;
+                }
+            } else if ( 0 != ( value & waiters_bit) ||
+                        value_.compare_exchange_weak(
+                            value, value | waiters_bit,
+                            std::memory_order_relaxed, std::memory_order_relaxed) ) {
+                return false;
+            }
+        }
+    }
+
+    // called with the wait-queue spinlock held and the waiters bit set:
+    // returns the number of remaining shared owners
+    std::size_t release_shared() noexcept {
+        const std::size_t value = value_.fetch_sub( reader_one, std::memory_order_release);
+        BOOST_ASSERT( 0 != ( value & waiters_bit) );
+        BOOST_ASSERT( reader_one <= value);
+        return value / reader_one - 1;
+    }
+
+    // called with the wait-queue spinlock held and the waiters bit set
+    // (no concurrent modification possible): passes exclusive ownership
+    // to a waiting writer
+    void hand_over( context * next, bool waiters) noexcept {
+        owner_.store( next, std::memory_order_relaxed);
+        value_.store( writer_bit | ( waiters ? waiters_bit : 0), std::memory_order_release);
+    }
+
+    // called with the wait-queue spinlock held and the waiters bit set:
+    // makes n waiting readers shared owners (in addition to the current ones)
+    void hand_over_shared( std::size_t n, bool waiters) noexcept {
+        owner_.store( nullptr, std::memory_order_relaxed);
+        const std::size_t value = value_.load( std::memory_order_relaxed) & ~( writer_bit | waiters_bit);
+        value_.store( ( value + n * reader_one) | ( waiters ? waiters_bit : 0), std::memory_order_release);
+    }
+
+    // called with the wait-queue spinlock held if the last waiter left
+    // the wait-queues without becoming owner (timeout) before the
+    // exclusive owner released the lock
+    void release() noexcept {
+        owner_.store( nullptr, std::memory_order_relaxed);
+        value_.store( 0, std::memory_order_release);
+    }
+
+    // called with the wait-queue spinlock held if the last waiter left
+    // the wait-queues without becoming owner (timeout)
+    void clear_waiters() noexcept {
+        value_.fetch_and( ~waiters_bit, std::memory_order_relaxed);
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_SHARED_LOCK_WORD_H
@@ -13,6 +13,7 @@
 
 #if !defined(BOOST_FIBERS_NO_ATOMICS) 
 # include <mutex>
+# include <boost/fiber/detail/spinlock_mcs.hpp>
 # include <boost/fiber/detail/spinlock_ttas.hpp>
 # include <boost/fiber/detail/spinlock_ttas_adaptive.hpp>
 # if defined(BOOST_FIBERS_HAS_FUTEX)
@@ -50,6 +51,8 @@ using spinlock = spinlock_ttas_futex;
 using spinlock = spinlock_ttas_adaptive_futex;
 # elif defined(BOOST_FIBERS_SPINLOCK_TTAS_ADAPTIVE) 
 using spinlock = spinlock_ttas_adaptive;
+# elif defined(BOOST_FIBERS_SPINLOCK_MCS)
+using spinlock = spinlock_mcs;
 # else
 using spinlock = spinlock_ttas;
 # endif
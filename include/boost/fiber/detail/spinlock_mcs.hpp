@@ -0,0 +1,168 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SPINLOCK_MCS_H
+#define BOOST_FIBERS_SPINLOCK_MCS_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/cpu_relax.hpp>
+#if defined(BOOST_FIBERS_HAS_FUTEX)
+# include <boost/fiber/detail/futex.hpp>
+#endif
+
+// based on informations from:
+// J. M. Mellor-Crummey, M. L. Scott: Algorithms for Scalable Synchronization
+// on Shared-Memory Multiprocessors
+
+#if BOOST_COMP_CLANG
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-private-field"
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// queued spinlock: the waiters form a list, each waiter spins on the
+// cacheline of its own queue node; releasing the lock touches only the
+// node of the successor instead of invalidating the cacheline of all
+// spinning threads
+// lock()/unlock() take no queue node (variant of the K42 project): a
+// waiter enqueues a node living on its stack, once it owns the lock it
+// moves the link to its successor into head_ - lock() never allocates
+// after BOOST_FIBERS_SPIN_MAX_TESTS the waiter suspends via futex
+class spinlock_mcs {
+private:
+    enum {
+        waiting = 0,
+        parked,
+        granted
+    };
+
+    struct alignas(cache_alignment) node {
+        std::atomic< node * >           next{ nullptr };
+        std::atomic< std::int32_t >     state{ waiting };
+    };
+
+    // align shared variable 'tail_' at cache line to prevent false sharing
+    // tail_ points to head_ while the lock is owned and nobody waits
+    alignas(cache_alignment) std::atomic< node * >      tail_{ nullptr };
+    // stands for the owner in the queue: next is the first waiter
+    node                                                head_{};
+    // padding to avoid other data one the cacheline of shared variable 'tail_'
+    char                                                pad_[cacheline_length];
+
+    static void wait_( node & n) noexcept {
+        std::int32_t tests = 0;
+        while ( granted != n.state.load( std::memory_order_acquire) ) {
+            if ( BOOST_FIBERS_SPIN_MAX_TESTS > tests) {
+                ++tests;
+#if !defined(BOOST_FIBERS_SPIN_SINGLE_CORE)
+                cpu_relax();
+#else
+                std::this_thread::yield();
+#endif
+                continue;
+            }
+#if defined(BOOST_FIBERS_HAS_FUTEX)
+            // lock held for a long time, pause via futex
+            std::int32_t expected = waiting;
+            if ( n.state.compare_exchange_strong( expected, parked, std::memory_order_acquire) ||
+                 parked == expected) {
+                futex_wait( & n.state, parked);
+            }
+#else
+            std::this_thread::yield();
+#endif
+        }
+    }
+
+public:
+    spinlock_mcs() noexcept = default;
+
+    spinlock_mcs( spinlock_mcs const&) = delete;
+    spinlock_mcs & operator=( spinlock_mcs const&) = delete;
+
+    void lock() noexcept {
+        for (;;) {
+            node * pred = tail_.load( std::memory_order_relaxed);
+            if ( nullptr == pred) {
+                // lock is free
+                if ( tail_.compare_exchange_weak( pred, & head_,
+                                                  std::memory_order_acquire,
+                                                  std::memory_order_relaxed) ) {
+                    return;
+                }
+                continue;
+            }
+            node n;
+            if ( ! tail_.compare_exchange_weak( pred, & n,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_relaxed) ) {
+                continue;
+            }
+            // enqueue behind the predecessor (head_ or the stack node of
+            // another waiter) and wait for the hand-over
+            pred->next.store( & n, std::memory_order_release);
+            wait_( n);
+            // success, lock acquired - n must not be referenced after
+            // returning
+            node * succ = n.next.load( std::memory_order_acquire);
+            if ( nullptr == succ) {
+                head_.next.store( nullptr, std::memory_order_relaxed);
+                node * expected = & n;
+                if ( tail_.compare_exchange_strong( expected, & head_,
+                                                    std::memory_order_acq_rel,
+                                                    std::memory_order_relaxed) ) {
+                    return;
+                }
+                // a waiter swapped tail_ but did not link itself yet
+                while ( nullptr == ( succ = n.next.load( std::memory_order_acquire) ) ) {
+                    cpu_relax();
+                }
+            }
+            head_.next.store( succ, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    void unlock() noexcept {
+        node * succ = head_.next.load( std::memory_order_acquire);
+        if ( nullptr == succ) {
+            node * expected = & head_;
+            if ( tail_.compare_exchange_strong( expected, nullptr,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed) ) {
+                // no waiter
+                return;
+            }
+            // a waiter swapped tail_ but did not link itself yet
+            while ( nullptr == ( succ = head_.next.load( std::memory_order_acquire) ) ) {
+                cpu_relax();
+            }
+        }
+        // hand over the lock
+        if ( parked == succ->state.exchange( granted, std::memory_order_release) ) {
+#if defined(BOOST_FIBERS_HAS_FUTEX)
+            // the waiter might already have returned, the stale wake-up is
+            // harmless since futex waiters re-check their condition
+            futex_wake( & succ->state);
+#endif
+        }
+    }
+};
+
+}}}
+
+#if BOOST_COMP_CLANG
+#pragma clang diagnostic pop
+#endif
+
+#endif // BOOST_FIBERS_SPINLOCK_MCS_H
@@ -0,0 +1,101 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_WAITER_COUNT_H
+#define BOOST_FIBERS_DETAIL_WAITER_COUNT_H
+
+#include <atomic>
+#include <cstddef>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// number of fibers that are linked (or about to be linked) into the
+// wait-queue of one direction of a channel; lets a fiber that made the
+// channel ready for the other direction skip the lock of the wait-queues if
+// nobody waits
+//
+// sleep transition:
+//   waiter:   lock wait-queues, enter(), re-check the channel, link itself
+//             and suspend (releasing the lock) - or leave() if the channel
+//             became ready meanwhile
+//   notifier: publish the value resp. free slot, then notify_needed() -
+//             lock the wait-queues and wake a waiter only if it returns true
+// enter() and notify_needed() issue a seq_cst fence between their store and
+// their load: either the waiter sees the change and does not suspend, or
+// the notifier sees the counter and acquires the lock, which the waiter
+// releases only after it has been linked into the wait-queue
+// whoever unlinks a waiter (notifier, close(), timed out waiter) calls
+// leave() while holding the lock, so a woken fiber that did not run yet
+// does not send the notifiers down the slow path
+class waiter_count {
+private:
+    std::atomic< std::size_t >  count_{ 0 };
+
+public:
+    waiter_count() = default;
+
+    waiter_count( waiter_count const&) = delete;
+    waiter_count & operator=( waiter_count const&) = delete;
+
+    void enter() noexcept {
+        count_.fetch_add( 1, std::memory_order_relaxed);
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+    }
+
+    void leave() noexcept {
+        count_.fetch_sub( 1, std::memory_order_relaxed);
+    }
+
+    bool notify_needed() const noexcept {
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+        return 0 != count_.load( std::memory_order_relaxed);
+    }
+};
+
+// leaves on destruction unless the fiber was linked into the wait-queue
+class waiter_guard {
+private:
+    waiter_count    *   count_;
+
+public:
+    explicit waiter_guard( waiter_count & count) noexcept :
+        count_( & count) {
+        count_->enter();
+    }
+
+    ~waiter_guard() {
+        if ( nullptr != count_) {
+            count_->leave();
+        }
+    }
+
+    waiter_guard( waiter_guard const&) = delete;
+    waiter_guard & operator=( waiter_guard const&) = delete;
+
+    // the fiber has been linked into the wait-queue, the fiber unlinking
+    // it is responsible for leave()
+    void release() noexcept {
+        count_ = nullptr;
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_WAITER_COUNT_H
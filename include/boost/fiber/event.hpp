@@ -0,0 +1,103 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_EVENT_H
+#define BOOST_FIBERS_EVENT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+// binary event: set() releases all waiting fibers (manual reset) or
+// exactly one (auto reset, the event is consumed by the woken fiber)
+class BOOST_FIBERS_DECL event {
+private:
+    typedef context::wait_queue_t   wait_queue_t;
+
+    // bit 0 flags the signaled state, bit 1 flags fibers in the
+    // wait-queue; both are never set at the same time
+    static constexpr std::size_t set_bit = 1;
+    static constexpr std::size_t waiters_bit = 2;
+
+    std::atomic< std::size_t >  value_;
+    wait_queue_t                wait_queue_{};
+    detail::spinlock            wait_queue_splk_{};
+    bool                        manual_reset_;
+
+    // called with the wait-queue spinlock held: consumes the event if it
+    // was set meanwhile, otherwise sets the waiters bit
+    bool consume_or_wait_() noexcept;
+
+    bool wait_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept;
+
+public:
+    explicit event( bool manual_reset = false, bool signaled = false) noexcept :
+        value_{ signaled ? set_bit : 0 },
+        manual_reset_{ manual_reset } {
+    }
+
+    ~event() {
+        BOOST_ASSERT( wait_queue_.empty() );
+    }
+
+    event( event const&) = delete;
+    event & operator=( event const&) = delete;
+
+    void set() noexcept;
+
+    void reset() noexcept;
+
+    bool is_set() const noexcept {
+        return 0 != ( value_.load( std::memory_order_acquire) & set_bit);
+    }
+
+    void wait();
+
+    bool try_wait() noexcept;
+
+    template< typename Clock, typename Duration >
+    bool wait_until( std::chrono::time_point< Clock, Duration > const& timeout_time_) {
+        std::chrono::steady_clock::time_point timeout_time(
+                detail::convert( timeout_time_) );
+        return wait_until_( timeout_time);
+    }
+
+    template< typename Rep, typename Period >
+    bool wait_for( std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return wait_until_( std::chrono::steady_clock::now() + timeout_duration);
+    }
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_EVENT_H
@@ -0,0 +1,124 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_EVENTCOUNT_H
+#define BOOST_FIBERS_EVENTCOUNT_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+// lets fibers block until a condition maintained by lock-free code
+// changes; notify_*() may be called from any thread, including threads
+// that never run a fiber
+//
+//   for (;;) {
+//       if ( try_pop( x) ) break;
+//       eventcount::key k = ec.prepare_wait();
+//       if ( try_pop( x) ) { ec.cancel_wait(); break; }
+//       ec.commit_wait( k);
+//   }
+class BOOST_FIBERS_DECL eventcount {
+public:
+    class key {
+    private:
+        friend class eventcount;
+
+        std::uint32_t   epoch_;
+
+        explicit key( std::uint32_t epoch) noexcept :
+            epoch_{ epoch } {
+        }
+    };
+
+private:
+    typedef context::wait_queue_t   wait_queue_t;
+
+    // the upper 32 bits count the notifications (epoch), the lower 32
+    // bits the fibers between prepare_wait() and the end of the wait
+    static constexpr std::uint64_t  waiter_one = 1;
+    static constexpr std::uint64_t  epoch_one = std::uint64_t( 1) << 32;
+    static constexpr std::uint64_t  waiters_mask = epoch_one - 1;
+
+    std::atomic< std::uint64_t >    state_{ 0 };
+    wait_queue_t                    wait_queue_{};
+    detail::spinlock                wait_queue_splk_{};
+
+    void notify_( bool) noexcept;
+
+public:
+    eventcount() = default;
+
+    ~eventcount() {
+        BOOST_ASSERT( wait_queue_.empty() );
+    }
+
+    eventcount( eventcount const&) = delete;
+    eventcount & operator=( eventcount const&) = delete;
+
+    // announces the intent to wait; the caller has to re-check its
+    // condition afterwards and then call either cancel_wait() or
+    // commit_wait()
+    key prepare_wait() noexcept {
+        return key{ static_cast< std::uint32_t >(
+                state_.fetch_add( waiter_one, std::memory_order_seq_cst) >> 32) };
+    }
+
+    void cancel_wait() noexcept {
+        BOOST_ASSERT( 0 != ( state_.load( std::memory_order_relaxed) & waiters_mask) );
+        state_.fetch_sub( waiter_one, std::memory_order_seq_cst);
+    }
+
+    // blocks unless a notification happened since prepare_wait(); might
+    // return without the condition being met
+    void commit_wait( key) noexcept;
+
+    // wait-free if no fiber is waiting
+    void notify_one() noexcept {
+        // orders the preceding update of the condition before reading
+        // the number of waiters
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+        if ( 0 != ( state_.load( std::memory_order_relaxed) & waiters_mask) ) {
+            notify_( false);
+        }
+    }
+
+    void notify_all() noexcept {
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+        if ( 0 != ( state_.load( std::memory_order_relaxed) & waiters_mask) ) {
+            notify_( true);
+        }
+    }
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_EVENTCOUNT_H
@@ -0,0 +1,86 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_LATCH_H
+#define BOOST_FIBERS_LATCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+// single-use counter: wait() blocks until count_down() brought the
+// counter to zero
+class BOOST_FIBERS_DECL latch {
+private:
+    typedef context::wait_queue_t   wait_queue_t;
+
+    // bit 0 flags fibers in the wait-queue, the remaining bits hold the
+    // counter; the waiters bit stays set until the fiber counting down to
+    // zero has released the wait-queue - hence a fiber returning from
+    // wait() may destroy the latch
+    static constexpr std::ptrdiff_t waiters_bit = 1;
+    static constexpr std::ptrdiff_t count_one = 2;
+
+    std::atomic< std::ptrdiff_t >   value_;
+    wait_queue_t                    wait_queue_{};
+    detail::spinlock                wait_queue_splk_{};
+
+    void release_() noexcept;
+
+public:
+    explicit latch( std::ptrdiff_t);
+
+    ~latch() {
+        BOOST_ASSERT( wait_queue_.empty() );
+    }
+
+    latch( latch const&) = delete;
+    latch & operator=( latch const&) = delete;
+
+    static constexpr std::ptrdiff_t max() noexcept {
+        return (std::numeric_limits< std::ptrdiff_t >::max)() / count_one;
+    }
+
+    void count_down( std::ptrdiff_t n = 1) noexcept;
+
+    bool try_wait() const noexcept {
+        return 0 == value_.load( std::memory_order_acquire);
+    }
+
+    void wait() noexcept;
+
+    void arrive_and_wait( std::ptrdiff_t n = 1) noexcept;
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_LATCH_H
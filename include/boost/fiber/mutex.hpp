@@ -7,12 +7,17 @@
 #ifndef BOOST_FIBERS_MUTEX_H
 #define BOOST_FIBERS_MUTEX_H
 
+#include <atomic>
+
 #include <boost/config.hpp>
 
 #include <boost/assert.hpp>
 
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/lock_inheritance.hpp>
+#include <boost/fiber/detail/profile.hpp>
+#include <boost/fiber/detail/lock_word.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -29,23 +34,66 @@ namespace fibers {
 
 class condition_variable;
 
+enum class mutex_mode {
+    // unlock() hands the lock over to the longest waiting fiber
+    fifo,
+    // unlock() releases the lock and wakes the longest waiting fiber,
+    // which competes with newly arriving fibers
+    barging
+};
+
 class BOOST_FIBERS_DECL mutex {
 private:
     friend class condition_variable;
 
     typedef context::wait_queue_t   wait_queue_t;
 
-    context                 *   owner_{ nullptr };
+    detail::lock_word           state_{};
     wait_queue_t                wait_queue_{};
     detail::spinlock            wait_queue_splk_{};
+    detail::lock_inheritance    inheritance_{};
+    bool                        barging_{ false };
+    // barging mode only: a waiter exceeded the starvation threshold, the
+    // lock is handed over in FIFO order until the wait-queue drains
+    std::atomic< bool >         starving_{ false };
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    detail::profile_record  *   profile_;
+#endif
+
+    // slow path of lock(): enqueues ctx and suspends until it owns the
+    // lock; woken is set if ctx was already readied by a barging unlock()
+    void wait_( context * ctx, bool woken);
+
+    // wait morphing, called by condition_variable::notify_*(): if the lock
+    // is owned, the notified waiters are moved to the wait-queue and get
+    // the lock handed over by unlock() one after another; fails if the
+    // lock is free - the waiters have to be readied
+    bool requeue_( wait_queue_t & waiters) noexcept;
+
+    // called by a notified waiter after it was resumed: returns if the lock
+    // was handed over, waits for it if the waiter was moved to the
+    // wait-queue, acquires the lock otherwise
+    void relock_( context * ctx);
 
 public:
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    mutex();
+
+    explicit mutex( mutex_mode);
+
+    ~mutex();
+#else
     mutex() = default;
 
+    explicit mutex( mutex_mode mode) noexcept :
+        barging_{ mutex_mode::barging == mode } {
+    }
+
     ~mutex() {
-        BOOST_ASSERT( nullptr == owner_);
+        BOOST_ASSERT( nullptr == state_.owner() );
         BOOST_ASSERT( wait_queue_.empty() );
     }
+#endif
 
     mutex( mutex const&) = delete;
     mutex & operator=( mutex const&) = delete;
@@ -54,6 +102,9 @@ public:
 
     bool try_lock();
 
+    // try_lock() followed by yielding to the other ready fibers
+    bool try_lock_and_yield();
+
     void unlock();
 };
 
@@ -0,0 +1,155 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_OFFLOAD_H
+#define BOOST_FIBERS_OFFLOAD_H
+
+#include <exception>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// a call executed by a helper thread on behalf of a suspended fiber
+// lives on the stack of the calling fiber - no allocation per call
+class offload_task {
+public:
+    context             *   ctx{ nullptr };
+    // held by the calling fiber until it is suspended
+    spinlock                splk{};
+    offload_task        *   nxt{ nullptr };
+    std::exception_ptr      except{};
+
+    virtual ~offload_task() = default;
+
+    virtual void run() noexcept = 0;
+};
+
+template< typename R >
+class offload_result {
+private:
+    typename std::aligned_storage< sizeof( R), alignof( R) >::type  storage_;
+    bool                                                            ready_{ false };
+
+public:
+    offload_result() = default;
+
+    ~offload_result() {
+        if ( ready_) {
+            reinterpret_cast< R * >( std::addressof( storage_) )->~R();
+        }
+    }
+
+    template< typename Fn >
+    void set( Fn & fn) {
+        ::new ( static_cast< void * >( std::addressof( storage_) ) ) R( fn() );
+        ready_ = true;
+    }
+
+    R get() {
+        return std::move( * reinterpret_cast< R * >( std::addressof( storage_) ) );
+    }
+};
+
+template< typename R >
+class offload_result< R & > {
+private:
+    R   *   value_{ nullptr };
+
+public:
+    template< typename Fn >
+    void set( Fn & fn) {
+        value_ = std::addressof( fn() );
+    }
+
+    R & get() noexcept {
+        return * value_;
+    }
+};
+
+template<>
+class offload_result< void > {
+public:
+    template< typename Fn >
+    void set( Fn & fn) {
+        fn();
+    }
+
+    void get() noexcept {
+    }
+};
+
+template< typename R, typename Fn >
+class offload_task_impl : public offload_task {
+private:
+    Fn                      fn_;
+    offload_result< R >     result_{};
+
+public:
+    explicit offload_task_impl( Fn && fn) :
+        fn_{ std::forward< Fn >( fn) } {
+    }
+
+    void run() noexcept override final {
+        try {
+            result_.set( fn_);
+        } catch (...) {
+            except = std::current_exception();
+        }
+    }
+
+    R get() {
+        if ( except) {
+            std::rethrow_exception( except);
+        }
+        return result_.get();
+    }
+};
+
+// hands task to the helper threads and suspends the active fiber until
+// the task has been executed
+BOOST_FIBERS_DECL
+void offload( offload_task *);
+
+}
+
+// executes fn( args ...) on a helper thread; only the calling fiber is
+// suspended while the other fibers of this thread keep running
+// intended for blocking calls (getaddrinfo(), fsync(), synchronous clients)
+template< typename Fn, typename ... Args >
+typename std::result_of< Fn &&( Args && ...) >::type
+offload( Fn && fn, Args && ... args) {
+    typedef typename std::result_of< Fn &&( Args && ...) >::type   result_t;
+
+    // the arguments stay alive on the stack of the suspended fiber
+    auto call = [&fn,&args...]() -> result_t {
+        return std::forward< Fn >( fn)( std::forward< Args >( args) ... );
+    };
+    detail::offload_task_impl< result_t, decltype( call) > task{ std::move( call) };
+    detail::offload( & task);
+    return task.get();
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_OFFLOAD_H
@@ -0,0 +1,106 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ONCE_H
+#define BOOST_FIBERS_ONCE_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/context/detail/invoke.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+// like std::once_flag, but fibers blocked on a running initializer are
+// suspended instead of the whole thread
+class BOOST_FIBERS_DECL once_flag {
+private:
+    template< typename Fn, typename ... Args >
+    friend void call_once( once_flag &, Fn &&, Args && ...);
+
+    typedef context::wait_queue_t   wait_queue_t;
+
+    enum : std::uint32_t {
+        idle = 0,
+        running,
+        // running, fibers are in the wait-queue
+        contended,
+        // the waiters are being released
+        completing,
+        done
+    };
+
+    std::atomic< std::uint32_t >    state_{ idle };
+    wait_queue_t                    wait_queue_{};
+    detail::spinlock                wait_queue_splk_{};
+
+    // returns true if the calling fiber has to run the initializer; waits
+    // while another fiber runs it
+    bool begin_();
+
+    void complete_() noexcept;
+
+    // the initializer threw - one of the waiters runs it next
+    void abort_() noexcept;
+
+public:
+    once_flag() = default;
+
+    ~once_flag() {
+        BOOST_ASSERT( wait_queue_.empty() );
+    }
+
+    once_flag( once_flag const&) = delete;
+    once_flag & operator=( once_flag const&) = delete;
+};
+
+template< typename Fn, typename ... Args >
+void call_once( once_flag & flag, Fn && fn, Args && ... args) {
+    // fast path: initialized
+    if ( BOOST_LIKELY( once_flag::done == flag.state_.load( std::memory_order_acquire) ) ) {
+        return;
+    }
+    if ( ! flag.begin_() ) {
+        return;
+    }
+    try {
+        boost::context::detail::invoke(
+                std::forward< Fn >( fn),
+                std::forward< Args >( args) ... );
+    } catch (...) {
+        flag.abort_();
+        throw;
+    }
+    flag.complete_();
+}
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ONCE_H
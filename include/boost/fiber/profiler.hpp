@@ -0,0 +1,72 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_PROFILER_H
+#define BOOST_FIBERS_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace profiler {
+
+// contention statistics of a mutex or condition variable; collected only
+// if the library is compiled with BOOST_FIBERS_PROFILE_CONTENTION
+struct entry {
+    // kind of primitive ("mutex", "timed_mutex", ...)
+    char const                  *   kind{ nullptr };
+    // the live instance, nullptr for the totals of the destroyed instances
+    // constructed at site
+    void const                  *   object{ nullptr };
+    // code address the primitive was constructed from (resolve with
+    // addr2line or a debugger)
+    void const                  *   site{ nullptr };
+    std::string                     name{};
+    std::uint64_t                   acquisitions{ 0 };
+    // acquisitions (or timed-out attempts) that had to wait
+    std::uint64_t                   contentions{ 0 };
+    std::chrono::nanoseconds        wait_total{ 0 };
+    std::chrono::nanoseconds        wait_max{ 0 };
+    std::chrono::nanoseconds        hold_total{ 0 };
+};
+
+// true if the library collects statistics
+BOOST_FIBERS_DECL
+bool enabled() noexcept;
+
+// labels a live primitive in snapshots and dumps
+BOOST_FIBERS_DECL
+void set_name( void const *, std::string const&);
+
+BOOST_FIBERS_DECL
+std::vector< entry > snapshot();
+
+// writes snapshot() as a table, most contended first
+BOOST_FIBERS_DECL
+void dump( std::ostream &);
+
+// clears the statistics of all primitives
+BOOST_FIBERS_DECL
+void reset();
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_PROFILER_H
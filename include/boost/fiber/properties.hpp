@@ -33,6 +33,11 @@ struct algorithm;
 }
 
 class BOOST_FIBERS_DECL fiber_properties {
+private:
+    // properties of ctx, created on demand if ctx has not been passed to
+    // awakened() yet (e.g. a fiber launched with launch::dispatch)
+    static fiber_properties * attach_( context * ctx) noexcept;
+
 protected:
     // initialized by constructor
     context         *   ctx_;
@@ -64,6 +69,17 @@ public:
     void set_algorithm( algo::algorithm * algo) noexcept {
         algo_ = algo;
     }
+
+    // called by the fiber mutexes -- don't directly call
+    // Inform the algorithm of 'owner' that fiber 'waiter' is going to block
+    // on a mutex held by 'owner' (e.g. to boost the owner's priority);
+    // returns true if 'owner' inherited the priority of 'waiter'.
+    static bool lock_contended( context * owner, context * waiter) noexcept;
+
+    // called by the fiber mutexes -- don't directly call
+    // Inform the algorithm of 'owner' that 'owner' has released a mutex, or
+    // that the waiter it inherited a priority from stopped waiting.
+    static void lock_released( context * owner) noexcept;
 };
 
 }} // namespace boost::fibers
@@ -0,0 +1,68 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_RCU_H
+#define BOOST_FIBERS_RCU_H
+
+#include <functional>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+class scheduler;
+
+namespace detail {
+
+BOOST_FIBERS_DECL
+void rcu_unregister( scheduler *) noexcept;
+
+}
+
+// read-copy-update: readers access shared data without locks or atomic
+// read-modify-writes; writers publish a new version and reclaim the old
+// one after all readers that might still reference it are done
+// a read-side section must not suspend the fiber (no blocking operation,
+// no yield) - every context switch of a thread is a quiescent state
+
+// marks the beginning of a read-side section; registers the scheduler of
+// this thread for quiescent state tracking on first use
+BOOST_FIBERS_DECL
+void rcu_read_lock() noexcept;
+
+inline
+void rcu_read_unlock() noexcept {
+}
+
+// reports a quiescent state of this thread; only required if the thread
+// reads in a loop without ever passing through the fiber scheduler
+BOOST_FIBERS_DECL
+void rcu_quiescent_state() noexcept;
+
+// blocks the calling fiber until all read-side sections entered before
+// the call have been left (a grace period elapsed); must not be called
+// inside a read-side section
+BOOST_FIBERS_DECL
+void synchronize_rcu();
+
+// invokes fn after a grace period; callbacks are batched and run by a
+// helper fiber of the calling thread
+BOOST_FIBERS_DECL
+void call_rcu( std::function< void() > fn);
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_RCU_H
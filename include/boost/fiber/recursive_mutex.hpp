@@ -17,6 +17,8 @@
 
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/lock_inheritance.hpp>
+#include <boost/fiber/detail/profile.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -43,8 +45,17 @@ private:
     std::size_t                 count_{ 0 };
     wait_queue_t                wait_queue_{};
     detail::spinlock            wait_queue_splk_{};
+    detail::lock_inheritance    inheritance_{};
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    detail::profile_record  *   profile_;
+#endif
 
 public:
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    recursive_mutex();
+
+    ~recursive_mutex();
+#else
     recursive_mutex() = default;
 
     ~recursive_mutex() {
@@ -52,6 +63,7 @@ public:
         BOOST_ASSERT( 0 == count_);
         BOOST_ASSERT( wait_queue_.empty() );
     }
+#endif
 
     recursive_mutex( recursive_mutex const&) = delete;
     recursive_mutex & operator=( recursive_mutex const&) = delete;
@@ -60,6 +72,9 @@ public:
 
     bool try_lock() noexcept;
 
+    // try_lock() followed by yielding to the other ready fibers
+    bool try_lock_and_yield() noexcept;
+
     void unlock();
 };
 
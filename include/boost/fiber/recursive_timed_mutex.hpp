@@ -18,6 +18,8 @@
 
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/lock_inheritance.hpp>
+#include <boost/fiber/detail/profile.hpp>
 #include <boost/fiber/detail/convert.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
 
@@ -45,10 +47,19 @@ private:
     std::size_t                 count_{ 0 };
     wait_queue_t                wait_queue_{};
     detail::spinlock            wait_queue_splk_{};
+    detail::lock_inheritance    inheritance_{};
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    detail::profile_record  *   profile_;
+#endif
 
     bool try_lock_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept;
 
 public:
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    recursive_timed_mutex();
+
+    ~recursive_timed_mutex();
+#else
     recursive_timed_mutex() = default;
 
     ~recursive_timed_mutex() {
@@ -56,6 +67,7 @@ public:
         BOOST_ASSERT( 0 == count_);
         BOOST_ASSERT( wait_queue_.empty() );
     }
+#endif
 
     recursive_timed_mutex( recursive_timed_mutex const&) = delete;
     recursive_timed_mutex & operator=( recursive_timed_mutex const&) = delete;
@@ -64,6 +76,9 @@ public:
 
     bool try_lock() noexcept;
 
+    // try_lock() followed by yielding to the other ready fibers
+    bool try_lock_and_yield() noexcept;
+
     template< typename Clock, typename Duration >
     bool try_lock_until( std::chrono::time_point< Clock, Duration > const& timeout_time_) {
         std::chrono::steady_clock::time_point timeout_time(
@@ -6,7 +6,9 @@
 #ifndef BOOST_FIBERS_FIBER_MANAGER_H
 #define BOOST_FIBERS_FIBER_MANAGER_H
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -40,6 +42,11 @@
 
 namespace boost {
 namespace fibers {
+namespace detail {
+
+class rcu_domain;
+
+}
 
 class BOOST_FIBERS_DECL scheduler {
 public:
@@ -85,12 +92,31 @@ private:
     // remote ready-queue contains context' signaled by schedulers
     // running in other threads
     detail::context_mpsc_queue          remote_ready_queue_{};
+    // set if algo_->notify() was called for the content of the
+    // remote ready-queue; reset when the dispatcher drains the queue
+    std::atomic< bool >                 remote_notified_{ false };
     // sleep-queue contains context' which have been called
 #endif
     // scheduler::wait_until()
     sleep_queue_t                       sleep_queue_{};
     bool                                shutdown_{ false };
 
+    friend class fiber_properties;
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    friend class detail::rcu_domain;
+
+    // RCU quiescent states: advanced by 2 at each context switch, bit 0 is
+    // set while the thread is idle; only maintained after a fiber of this
+    // scheduler entered an RCU read-side section
+    std::atomic< std::uint64_t >        rcu_epoch_{ 0 };
+    bool                                rcu_reader_{ false };
+    // links the scheduler into the list of RCU readers - registering
+    // allocates nothing, rcu_read_lock() is noexcept
+    intrusive::list_member_hook<>       rcu_hook_{};
+
+    void rcu_advance_( std::uint64_t) noexcept;
+#endif
+
     context * get_next_() noexcept;
 
     void release_terminated_() noexcept;
@@ -113,6 +139,9 @@ public:
 
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     void set_remote_ready( context *) noexcept;
+
+    // contexts first .. last chained via remote_nxt_
+    void set_remote_ready( context * first, context * last) noexcept;
 #endif
 
 #if (BOOST_EXECUTION_CONTEXT==1)
@@ -131,10 +160,10 @@ public:
                      std::chrono::steady_clock::time_point const&) noexcept;
     bool wait_until( context *,
                      std::chrono::steady_clock::time_point const&,
-                     detail::spinlock_lock &) noexcept;
+                     detail::lock_ref const&) noexcept;
 
     void suspend() noexcept;
-    void suspend( detail::spinlock_lock &) noexcept;
+    void suspend( detail::lock_ref const&) noexcept;
 
     bool has_ready_fibers() const noexcept;
 
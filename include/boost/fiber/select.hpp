@@ -0,0 +1,155 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SELECT_H
+#define BOOST_FIBERS_SELECT_H
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/channel_op_status.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/select_waiter.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+struct select_result {
+    // index of the completed case, the number of cases if select timed out
+    std::size_t         index;
+    // success, closed or timeout
+    channel_op_status   status;
+};
+
+namespace detail {
+
+class select_case {
+public:
+    // performs the operation if it does not block; returns success or
+    // closed if the case is complete, empty or full otherwise
+    virtual channel_op_status try_complete( std::chrono::steady_clock::time_point const*) = 0;
+
+    // links w into the channel, returns false if the case became ready
+    virtual bool arm( select_waiter &) = 0;
+
+    virtual void disarm( select_waiter &) noexcept = 0;
+
+protected:
+    ~select_case() = default;
+};
+
+template< typename Channel >
+class select_pop_case final : public select_case {
+private:
+    Channel                             &   chan_;
+    typename Channel::value_type        &   value_;
+
+public:
+    select_pop_case( Channel & chan, typename Channel::value_type & value) noexcept :
+        chan_( chan),
+        value_( value) {
+    }
+
+    channel_op_status try_complete( std::chrono::steady_clock::time_point const*) override {
+        return chan_.select_try_pop_( value_);
+    }
+
+    bool arm( select_waiter & w) override {
+        return chan_.select_arm_( w, false);
+    }
+
+    void disarm( select_waiter & w) noexcept override {
+        chan_.select_disarm_( w, false);
+    }
+};
+
+template< typename Channel, typename ValueType >
+class select_push_case final : public select_case {
+private:
+    Channel                                             &   chan_;
+    typename std::remove_reference< ValueType >::type   *   value_;
+
+public:
+    select_push_case( Channel & chan, ValueType && value) noexcept :
+        chan_( chan),
+        value_( std::addressof( value) ) {
+    }
+
+    channel_op_status try_complete( std::chrono::steady_clock::time_point const* timeout_time) override {
+        // the value is moved (if passed as rvalue) only if the push succeeds
+        return chan_.select_try_push_( static_cast< ValueType && >( * value_), timeout_time);
+    }
+
+    bool arm( select_waiter & w) override {
+        return chan_.select_arm_( w, true);
+    }
+
+    void disarm( select_waiter & w) noexcept override {
+        chan_.select_disarm_( w, true);
+    }
+};
+
+BOOST_FIBERS_DECL
+select_result select_( select_case **, select_waiter *, std::size_t,
+                       std::chrono::steady_clock::time_point const*);
+
+}
+
+// case of select(): pops a value from a buffered_channel or unbuffered_channel
+template< typename Channel >
+detail::select_pop_case< Channel > pop_case( Channel & chan, typename Channel::value_type & value) noexcept {
+    return detail::select_pop_case< Channel >{ chan, value };
+}
+
+// case of select(): pushes value to a buffered_channel or unbuffered_channel
+template< typename Channel, typename ValueType >
+detail::select_push_case< Channel, ValueType > push_case( Channel & chan, ValueType && value) noexcept {
+    return detail::select_push_case< Channel, ValueType >{ chan, std::forward< ValueType >( value) };
+}
+
+// completes exactly one of the cases, blocking until one is ready
+// returns the index of the completed case with status success, or with
+// status closed if the channel of the case was closed
+template< typename ... Cases >
+select_result select( Cases && ... cases) {
+    static_assert( 0 < sizeof ... ( Cases), "boost fiber: select requires at least one case");
+    detail::select_case * cs[] = { & cases ... };
+    detail::select_waiter ws[sizeof ... ( Cases)];
+    return detail::select_( cs, ws, sizeof ... ( Cases), nullptr);
+}
+
+template< typename Clock, typename Duration, typename ... Cases >
+select_result select_until( std::chrono::time_point< Clock, Duration > const& timeout_time_, Cases && ... cases) {
+    static_assert( 0 < sizeof ... ( Cases), "boost fiber: select requires at least one case");
+    std::chrono::steady_clock::time_point timeout_time( detail::convert( timeout_time_) );
+    detail::select_case * cs[] = { & cases ... };
+    detail::select_waiter ws[sizeof ... ( Cases)];
+    return detail::select_( cs, ws, sizeof ... ( Cases), & timeout_time);
+}
+
+template< typename Rep, typename Period, typename ... Cases >
+select_result select_for( std::chrono::duration< Rep, Period > const& timeout_duration, Cases && ... cases) {
+    return select_until( std::chrono::steady_clock::now() + timeout_duration,
+                         std::forward< Cases >( cases) ... );
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SELECT_H
@@ -0,0 +1,80 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SHARED_MUTEX_H
+#define BOOST_FIBERS_SHARED_MUTEX_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/shared_lock_word.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+class BOOST_FIBERS_DECL shared_mutex {
+private:
+    typedef context::wait_queue_t   wait_queue_t;
+
+    detail::shared_lock_word    state_{};
+    wait_queue_t                readers_queue_{};
+    wait_queue_t                writers_queue_{};
+    detail::spinlock            wait_queue_splk_{};
+
+    void wake_readers_() noexcept;
+
+    void wake_writer_() noexcept;
+
+public:
+    shared_mutex() = default;
+
+    ~shared_mutex() {
+        BOOST_ASSERT( ! state_.has_writer() );
+        BOOST_ASSERT( 0 == state_.readers() );
+        BOOST_ASSERT( readers_queue_.empty() );
+        BOOST_ASSERT( writers_queue_.empty() );
+    }
+
+    shared_mutex( shared_mutex const&) = delete;
+    shared_mutex & operator=( shared_mutex const&) = delete;
+
+    void lock();
+
+    bool try_lock();
+
+    void unlock();
+
+    void lock_shared();
+
+    bool try_lock_shared();
+
+    void unlock_shared();
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SHARED_MUTEX_H
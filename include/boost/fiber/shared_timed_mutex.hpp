@@ -0,0 +1,110 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SHARED_TIMED_MUTEX_H
+#define BOOST_FIBERS_SHARED_TIMED_MUTEX_H
+
+#include <chrono>
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/shared_lock_word.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+class BOOST_FIBERS_DECL shared_timed_mutex {
+private:
+    typedef context::wait_queue_t   wait_queue_t;
+
+    detail::shared_lock_word    state_{};
+    wait_queue_t                readers_queue_{};
+    wait_queue_t                writers_queue_{};
+    detail::spinlock            wait_queue_splk_{};
+
+    void wake_readers_() noexcept;
+
+    void wake_writer_() noexcept;
+
+    bool try_lock_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept;
+
+    bool try_lock_shared_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept;
+
+public:
+    shared_timed_mutex() = default;
+
+    ~shared_timed_mutex() {
+        BOOST_ASSERT( ! state_.has_writer() );
+        BOOST_ASSERT( 0 == state_.readers() );
+        BOOST_ASSERT( readers_queue_.empty() );
+        BOOST_ASSERT( writers_queue_.empty() );
+    }
+
+    shared_timed_mutex( shared_timed_mutex const&) = delete;
+    shared_timed_mutex & operator=( shared_timed_mutex const&) = delete;
+
+    void lock();
+
+    bool try_lock();
+
+    template< typename Clock, typename Duration >
+    bool try_lock_until( std::chrono::time_point< Clock, Duration > const& timeout_time_) {
+        std::chrono::steady_clock::time_point timeout_time(
+                detail::convert( timeout_time_) );
+        return try_lock_until_( timeout_time);
+    }
+
+    template< typename Rep, typename Period >
+    bool try_lock_for( std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return try_lock_until_( std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    void unlock();
+
+    void lock_shared();
+
+    bool try_lock_shared();
+
+    template< typename Clock, typename Duration >
+    bool try_lock_shared_until( std::chrono::time_point< Clock, Duration > const& timeout_time_) {
+        std::chrono::steady_clock::time_point timeout_time(
+                detail::convert( timeout_time_) );
+        return try_lock_shared_until_( timeout_time);
+    }
+
+    template< typename Rep, typename Period >
+    bool try_lock_shared_for( std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return try_lock_shared_until_( std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    void unlock_shared();
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SHARED_TIMED_MUTEX_H
@@ -0,0 +1,56 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SPINLOCK_POLICY_H
+#define BOOST_FIBERS_SPINLOCK_POLICY_H
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// spinlocks a channel can be instantiated with, e.g.
+// buffered_channel< T, spinlock_policy::mcs >
+namespace spinlock_policy {
+
+// the spinlock selected by the macros the library was compiled with
+using library_default = detail::spinlock;
+
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+using std_mutex = std::mutex;
+using ttas = detail::spinlock_ttas;
+using ttas_adaptive = detail::spinlock_ttas_adaptive;
+# if defined(BOOST_FIBERS_HAS_FUTEX)
+using ttas_futex = detail::spinlock_ttas_futex;
+using ttas_adaptive_futex = detail::spinlock_ttas_adaptive_futex;
+# endif
+// queued lock, scales with the number of contending threads
+using mcs = detail::spinlock_mcs;
+#else
+// no synchronization between threads - all policies are no-ops
+using std_mutex = detail::spinlock;
+using ttas = detail::spinlock;
+using ttas_adaptive = detail::spinlock;
+using ttas_futex = detail::spinlock;
+using ttas_adaptive_futex = detail::spinlock;
+using mcs = detail::spinlock;
+#endif
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SPINLOCK_POLICY_H
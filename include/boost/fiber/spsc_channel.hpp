@@ -0,0 +1,492 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SPSC_CHANNEL_H
+#define BOOST_FIBERS_SPSC_CHANNEL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/channel_op_status.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/detail/waiter_count.hpp>
+#include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/spinlock_policy.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// bounded channel for exactly one producing and one consuming fiber (which
+// might run in different threads)
+// each index is written only by its side: push and pop are a plain store
+// with release semantics; the index of the other side is re-read (acquire)
+// only if the cached copy indicates a full resp. empty buffer
+// the slots are densely packed - no per-slot sequence numbers
+template< typename T, typename Spinlock = detail::spinlock >
+class spsc_channel {
+public:
+    typedef T   value_type;
+
+private:
+    typedef typename std::aligned_storage< sizeof( T), alignof( T) >::type  storage_type;
+    typedef context::wait_queue_t                                           wait_queue_type;
+    typedef std::unique_lock< Spinlock >                                    lock_type;
+
+    // producer cacheline
+    alignas(cache_alignment) std::atomic< std::size_t >     tail_{ 0 };
+    std::size_t                                             head_cache_{ 0 };
+    // consumer cacheline
+    alignas(cache_alignment) std::atomic< std::size_t >     head_{ 0 };
+    std::size_t                                             tail_cache_{ 0 };
+    // shared write cacheline
+    alignas(cache_alignment) std::atomic_bool               closed_{ false };
+    detail::waiter_count                                    producer_waiters_{};
+    detail::waiter_count                                    consumer_waiters_{};
+    mutable Spinlock                                        splk_{};
+    wait_queue_type                                         waiting_producers_{};
+    wait_queue_type                                         waiting_consumers_{};
+    // shared read cacheline
+    alignas(cache_alignment) storage_type                *  slots_{ nullptr };
+    std::size_t                                             capacity_;
+    char                                                    pad_[cacheline_length];
+
+    value_type * slot_( std::size_t idx) noexcept {
+        return reinterpret_cast< value_type * >( std::addressof( slots_[idx & (capacity_ - 1)]) );
+    }
+
+    // called by the producer
+    bool is_full_() noexcept {
+        return capacity_ == tail_.load( std::memory_order_relaxed) - head_.load( std::memory_order_acquire);
+    }
+
+    // called by the consumer
+    bool is_empty_() noexcept {
+        return head_.load( std::memory_order_relaxed) == tail_.load( std::memory_order_acquire);
+    }
+
+    template< typename ValueType >
+    channel_op_status try_push_( ValueType && value) {
+        const std::size_t tail{ tail_.load( std::memory_order_relaxed) };
+        if ( capacity_ == tail - head_cache_) {
+            head_cache_ = head_.load( std::memory_order_acquire);
+            if ( capacity_ == tail - head_cache_) {
+                return channel_op_status::full;
+            }
+        }
+        ::new ( static_cast< void * >( slot_( tail) ) ) value_type( std::forward< ValueType >( value) );
+        tail_.store( tail + 1, std::memory_order_release);
+        return channel_op_status::success;
+    }
+
+    // the oldest value, nullptr if the buffer is empty
+    value_type * front_() noexcept {
+        const std::size_t head{ head_.load( std::memory_order_relaxed) };
+        if ( head == tail_cache_) {
+            tail_cache_ = tail_.load( std::memory_order_acquire);
+            if ( head == tail_cache_) {
+                return nullptr;
+            }
+        }
+        return slot_( head);
+    }
+
+    void pop_front_() noexcept {
+        const std::size_t head{ head_.load( std::memory_order_relaxed) };
+        slot_( head)->~value_type();
+        // the slot can be re-used by the producer
+        head_.store( head + 1, std::memory_order_release);
+    }
+
+    channel_op_status try_pop_( value_type & value) {
+        value_type * v{ front_() };
+        if ( nullptr == v) {
+            return channel_op_status::empty;
+        }
+        value = std::move( * v);
+        pop_front_();
+        return channel_op_status::success;
+    }
+
+    // notify the fiber of the other side, if waiting
+    void notify_( wait_queue_type & queue, detail::waiter_count & waiters) {
+        if ( ! waiters.notify_needed() ) {
+            return;
+        }
+        lock_type lk{ splk_ };
+        if ( ! queue.empty() ) {
+            context * ctx{ & queue.front() };
+            queue.pop_front();
+            waiters.leave();
+            lk.unlock();
+            context::active()->set_ready( ctx);
+        }
+    }
+
+    template< typename ValueType >
+    channel_op_status push_( ValueType && value) {
+        context * ctx{ context::active() };
+        for (;;) {
+            if ( is_closed() ) {
+                return channel_op_status::closed;
+            }
+            if ( channel_op_status::success == try_push_( std::forward< ValueType >( value) ) ) {
+                notify_( waiting_consumers_, consumer_waiters_);
+                return channel_op_status::success;
+            }
+            BOOST_ASSERT( ! ctx->wait_is_linked() );
+            lock_type lk{ splk_ };
+            detail::waiter_guard wg{ producer_waiters_ };
+            if ( is_closed() ) {
+                return channel_op_status::closed;
+            }
+            if ( ! is_full_() ) {
+                continue;
+            }
+            ctx->wait_link( waiting_producers_);
+            wg.release();
+            // suspend this producer
+            ctx->suspend( lk);
+        }
+    }
+
+    template< typename ValueType >
+    channel_op_status push_wait_until_( ValueType && value,
+                                        std::chrono::steady_clock::time_point const& timeout_time) {
+        context * ctx{ context::active() };
+        for (;;) {
+            if ( is_closed() ) {
+                return channel_op_status::closed;
+            }
+            if ( channel_op_status::success == try_push_( std::forward< ValueType >( value) ) ) {
+                notify_( waiting_consumers_, consumer_waiters_);
+                return channel_op_status::success;
+            }
+            BOOST_ASSERT( ! ctx->wait_is_linked() );
+            lock_type lk{ splk_ };
+            detail::waiter_guard wg{ producer_waiters_ };
+            if ( is_closed() ) {
+                return channel_op_status::closed;
+            }
+            if ( ! is_full_() ) {
+                continue;
+            }
+            ctx->wait_link( waiting_producers_);
+            wg.release();
+            // suspend this producer
+            if ( ! ctx->wait_until( timeout_time, lk) ) {
+                // relock local lk
+                lk.lock();
+                // remove from waiting-queue, unless a notifier did
+                if ( ctx->wait_is_linked() ) {
+                    ctx->wait_unlink();
+                    producer_waiters_.leave();
+                }
+                return channel_op_status::timeout;
+            }
+        }
+    }
+
+public:
+    explicit spsc_channel( std::size_t capacity) :
+        capacity_{ capacity } {
+        if ( 0 == capacity_ || 0 != ( capacity_ & (capacity_ - 1) ) ) {
+            throw fiber_error( std::make_error_code( std::errc::invalid_argument),
+                               "boost fiber: buffer capacity is invalid");
+        }
+        slots_ = new storage_type[capacity_];
+    }
+
+    ~spsc_channel() {
+        close();
+        const std::size_t tail{ tail_.load( std::memory_order_acquire) };
+        for ( std::size_t head = head_.load( std::memory_order_relaxed); head != tail; ++head) {
+            slot_( head)->~value_type();
+        }
+        delete [] slots_;
+    }
+
+    spsc_channel( spsc_channel const&) = delete;
+    spsc_channel & operator=( spsc_channel const&) = delete;
+
+    bool is_closed() const noexcept {
+        return closed_.load( std::memory_order_acquire);
+    }
+
+    void close() noexcept {
+        context * ctx{ context::active() };
+        lock_type lk{ splk_ };
+        closed_.store( true, std::memory_order_release);
+        // notify waiting producer
+        while ( ! waiting_producers_.empty() ) {
+            context * producer_ctx{ & waiting_producers_.front() };
+            waiting_producers_.pop_front();
+            producer_waiters_.leave();
+            ctx->set_ready( producer_ctx);
+        }
+        // notify waiting consumer
+        while ( ! waiting_consumers_.empty() ) {
+            context * consumer_ctx{ & waiting_consumers_.front() };
+            waiting_consumers_.pop_front();
+            consumer_waiters_.leave();
+            ctx->set_ready( consumer_ctx);
+        }
+    }
+
+    channel_op_status try_push( value_type const& value) {
+        if ( is_closed() ) {
+            return channel_op_status::closed;
+        }
+        channel_op_status status{ try_push_( value) };
+        if ( channel_op_status::success == status) {
+            notify_( waiting_consumers_, consumer_waiters_);
+        }
+        return status;
+    }
+
+    channel_op_status try_push( value_type && value) {
+        if ( is_closed() ) {
+            return channel_op_status::closed;
+        }
+        channel_op_status status{ try_push_( std::move( value) ) };
+        if ( channel_op_status::success == status) {
+            notify_( waiting_consumers_, consumer_waiters_);
+        }
+        return status;
+    }
+
+    channel_op_status push( value_type const& value) {
+        return push_( value);
+    }
+
+    channel_op_status push( value_type && value) {
+        return push_( std::move( value) );
+    }
+
+    template< typename Rep, typename Period >
+    channel_op_status push_wait_for( value_type const& value,
+                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return push_wait_until_( value,
+                                 std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    template< typename Rep, typename Period >
+    channel_op_status push_wait_for( value_type && value,
+                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return push_wait_until_( std::move( value),
+                                 std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    template< typename Clock, typename Duration >
+    channel_op_status push_wait_until( value_type const& value,
+                                       std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return push_wait_until_( value, detail::convert( timeout_time) );
+    }
+
+    template< typename Clock, typename Duration >
+    channel_op_status push_wait_until( value_type && value,
+                                       std::chrono::time_point< Clock, Duration > const& timeout_time) {
+        return push_wait_until_( std::move( value), detail::convert( timeout_time) );
+    }
+
+    channel_op_status try_pop( value_type & value) {
+        channel_op_status status{ try_pop_( value) };
+        if ( channel_op_status::success == status) {
+            notify_( waiting_producers_, producer_waiters_);
+        } else if ( is_closed() ) {
+            status = channel_op_status::closed;
+        }
+        return status;
+    }
+
+    channel_op_status pop( value_type & value) {
+        context * ctx{ context::active() };
+        for (;;) {
+            if ( channel_op_status::success == try_pop_( value) ) {
+                notify_( waiting_producers_, producer_waiters_);
+                return channel_op_status::success;
+            }
+            BOOST_ASSERT( ! ctx->wait_is_linked() );
+            lock_type lk{ splk_ };
+            detail::waiter_guard wg{ consumer_waiters_ };
+            if ( is_closed() ) {
+                return channel_op_status::closed;
+            }
+            if ( ! is_empty_() ) {
+                continue;
+            }
+            ctx->wait_link( waiting_consumers_);
+            wg.release();
+            // suspend this consumer
+            ctx->suspend( lk);
+        }
+    }
+
+    value_type value_pop() {
+        context * ctx{ context::active() };
+        for (;;) {
+            value_type * v{ front_() };
+            if ( nullptr != v) {
+                value_type value{ std::move( * v) };
+                pop_front_();
+                notify_( waiting_producers_, producer_waiters_);
+                return std::move( value);
+            }
+            BOOST_ASSERT( ! ctx->wait_is_linked() );
+            lock_type lk{ splk_ };
+            detail::waiter_guard wg{ consumer_waiters_ };
+            if ( is_closed() ) {
+                throw fiber_error{
+                        std::make_error_code( std::errc::operation_not_permitted),
+                        "boost fiber: channel is closed" };
+            }
+            if ( ! is_empty_() ) {
+                continue;
+            }
+            ctx->wait_link( waiting_consumers_);
+            wg.release();
+            // suspend this consumer
+            ctx->suspend( lk);
+        }
+    }
+
+    template< typename Rep, typename Period >
+    channel_op_status pop_wait_for( value_type & value,
+                                    std::chrono::duration< Rep, Period > const& timeout_duration) {
+        return pop_wait_until( value,
+                               std::chrono::steady_clock::now() + timeout_duration);
+    }
+
+    template< typename Clock, typename Duration >
+    channel_op_status pop_wait_until( value_type & value,
+                                      std::chrono::time_point< Clock, Duration > const& timeout_time_) {
+        std::chrono::steady_clock::time_point timeout_time( detail::convert( timeout_time_) );
+        context * ctx{ context::active() };
+        for (;;) {
+            if ( channel_op_status::success == try_pop_( value) ) {
+                notify_( waiting_producers_, producer_waiters_);
+                return channel_op_status::success;
+            }
+            BOOST_ASSERT( ! ctx->wait_is_linked() );
+            lock_type lk{ splk_ };
+            detail::waiter_guard wg{ consumer_waiters_ };
+            if ( is_closed() ) {
+                return channel_op_status::closed;
+            }
+            if ( ! is_empty_() ) {
+                continue;
+            }
+            ctx->wait_link( waiting_consumers_);
+            wg.release();
+            // suspend this consumer
+            if ( ! ctx->wait_until( timeout_time, lk) ) {
+                // relock local lk
+                lk.lock();
+                // remove from waiting-queue, unless a notifier did
+                if ( ctx->wait_is_linked() ) {
+                    ctx->wait_unlink();
+                    consumer_waiters_.leave();
+                }
+                return channel_op_status::timeout;
+            }
+        }
+    }
+
+    class iterator : public std::iterator< std::input_iterator_tag, typename std::remove_reference< value_type >::type > {
+    private:
+        typedef typename std::aligned_storage< sizeof( value_type), alignof( value_type) >::type  storage_type;
+
+        spsc_channel    *   chan_{ nullptr };
+        storage_type        storage_;
+
+        void increment_() {
+            BOOST_ASSERT( nullptr != chan_);
+            try {
+                ::new ( static_cast< void * >( std::addressof( storage_) ) ) value_type{ chan_->value_pop() };
+            } catch ( fiber_error const&) {
+                chan_ = nullptr;
+            }
+        }
+
+    public:
+        typedef typename iterator::pointer pointer_t;
+        typedef typename iterator::reference reference_t;
+
+        iterator() noexcept = default;
+
+        explicit iterator( spsc_channel * chan) noexcept :
+            chan_{ chan } {
+            increment_();
+        }
+
+        iterator( iterator const& other) noexcept :
+            chan_{ other.chan_ } {
+        }
+
+        iterator & operator=( iterator const& other) noexcept {
+            if ( this == & other) return * this;
+            chan_ = other.chan_;
+            return * this;
+        }
+
+        bool operator==( iterator const& other) const noexcept {
+            return other.chan_ == chan_;
+        }
+
+        bool operator!=( iterator const& other) const noexcept {
+            return other.chan_ != chan_;
+        }
+
+        iterator & operator++() {
+            increment_();
+            return * this;
+        }
+
+        iterator operator++( int) = delete;
+
+        reference_t operator*() noexcept {
+            return * reinterpret_cast< value_type * >( std::addressof( storage_) );
+        }
+
+        pointer_t operator->() noexcept {
+            return reinterpret_cast< value_type * >( std::addressof( storage_) );
+        }
+    };
+
+    friend class iterator;
+};
+
+template< typename T, typename Spinlock >
+typename spsc_channel< T, Spinlock >::iterator
+begin( spsc_channel< T, Spinlock > & chan) {
+    return typename spsc_channel< T, Spinlock >::iterator( & chan);
+}
+
+template< typename T, typename Spinlock >
+typename spsc_channel< T, Spinlock >::iterator
+end( spsc_channel< T, Spinlock > &) {
+    return typename spsc_channel< T, Spinlock >::iterator();
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SPSC_CHANNEL_H
@@ -14,7 +14,10 @@
 
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/lock_inheritance.hpp>
+#include <boost/fiber/detail/profile.hpp>
 #include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/lock_word.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -37,19 +40,29 @@ private:
 
     typedef context::wait_queue_t   wait_queue_t;
 
-    context                 *   owner_{ nullptr };
+    detail::lock_word           state_{};
     wait_queue_t                wait_queue_{};
     detail::spinlock            wait_queue_splk_{};
+    detail::lock_inheritance    inheritance_{};
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    detail::profile_record  *   profile_;
+#endif
 
     bool try_lock_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept;
 
 public:
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    timed_mutex();
+
+    ~timed_mutex();
+#else
     timed_mutex() = default;
 
     ~timed_mutex() {
-        BOOST_ASSERT( nullptr == owner_);
+        BOOST_ASSERT( nullptr == state_.owner() );
         BOOST_ASSERT( wait_queue_.empty() );
     }
+#endif
 
     timed_mutex( timed_mutex const&) = delete;
     timed_mutex & operator=( timed_mutex const&) = delete;
@@ -58,6 +71,9 @@ public:
 
     bool try_lock();
 
+    // try_lock() followed by yielding to the other ready fibers
+    bool try_lock_and_yield();
+
     template< typename Clock, typename Duration >
     bool try_lock_until( std::chrono::time_point< Clock, Duration > const& timeout_time_) {
         std::chrono::steady_clock::time_point timeout_time(
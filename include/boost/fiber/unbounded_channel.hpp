@@ -1,34 +1,35 @@
-
 //          Copyright Oliver Kowalke 2013.
 // Distributed under the Boost Software License, Version 1.0.
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 //
+// segmented queue based on the unbounded MPMC queue of crossbeam
+// (https://github.com/crossbeam-rs/crossbeam, SegQueue)
 
 #ifndef BOOST_FIBERS_UNBOUNDED_CHANNEL_H
 #define BOOST_FIBERS_UNBOUNDED_CHANNEL_H
 
-#warn "template unbounded_channel is deprecated"
-
 #include <atomic>
-#include <algorithm>
 #include <chrono>
 #include <cstddef>
-#include <deque>
+#include <cstdint>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <type_traits>
 #include <utility>
 
 #include <boost/config.hpp>
-#include <boost/intrusive_ptr.hpp>
 
-#include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/channel_op_status.hpp>
-#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/cpu_relax.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/detail/waiter_count.hpp>
 #include <boost/fiber/exceptions.hpp>
-#include <boost/fiber/mutex.hpp>
-#include <boost/fiber/operations.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -37,6 +38,9 @@
 namespace boost {
 namespace fibers {
 
+// the values are stored in segments of fixed size, linked into a list;
+// producers and consumers claim slots with a CAS on a global index, the
+// segments are allocated via Allocator and recycled by a per-channel pool
 template< typename T,
           typename Allocator = std::allocator< T >
 >
@@ -45,224 +49,563 @@ public:
     typedef T   value_type;
 
 private:
-    struct node {
-        typedef intrusive_ptr< node >                   ptr_t;
-        typedef typename std::allocator_traits< Allocator >::template rebind_alloc<
-            node
-        >                                               allocator_t;
-        typedef std::allocator_traits< allocator_t >    allocator_traits_t;
-
-#if ! defined(BOOST_FIBERS_NO_ATOMICS)
-        std::atomic< std::size_t >  use_count{ 0 };
-#else
-        std::size_t                 use_count{ 0 };
-#endif
-        allocator_t                 alloc;
-        T                           va;
-        ptr_t                       nxt{};
+    typedef typename std::aligned_storage< sizeof( T), alignof( T) >::type  storage_type;
+    typedef context::wait_queue_t                                           wait_queue_type;
+    typedef std::unique_lock< detail::spinlock >                            lock_type;
+
+    // an index is the position of a slot, shifted by one bit; the lowest
+    // bit of the consumer index tells that the segment of the consumer
+    // index is not the last one
+    static constexpr std::size_t shift = 1;
+    static constexpr std::size_t has_next = 1;
+    // positions per segment, the last position of a segment is never used
+    // for a value: an index pointing to it tells that the next segment is
+    // being installed
+    static constexpr std::size_t lap = 32;
+    static constexpr std::size_t segment_capacity = lap - 1;
+    // number of empty segments kept for reuse
+    static constexpr std::size_t pool_capacity = 4;
+
+    enum : std::uint32_t {
+        // the value has been stored
+        written = 1,
+        // the value has been consumed
+        read = 2,
+        // the segment is going to be released, the consumer of the slot
+        // has to continue the release
+        destroy = 4,
+        // constructing the value threw, the slot holds no value and is
+        // stepped over by its consumer
+        skipped = 8
+    };
 
-        node( T const& t, allocator_t const& alloc_) noexcept :
-            alloc{ alloc_ },
-            va{ t } {
-        }
+    struct slot {
+        std::atomic< std::uint32_t >    state{ 0 };
+        storage_type                    storage;
 
-        node( T && t, allocator_t const& alloc_) noexcept :
-            alloc{ alloc_ },
-            va{ std::move( t) } {
+        // leaves storage uninitialized, segments are constructed on reuse
+        slot() noexcept {
         }
 
-        friend
-        void intrusive_ptr_add_ref( node * p) noexcept {
-            ++p->use_count;
+        value_type * value() noexcept {
+            return reinterpret_cast< value_type * >( std::addressof( storage) );
         }
+    };
 
-        friend
-        void intrusive_ptr_release( node * p) noexcept {
-            if ( 0 == --p->use_count) {
-                allocator_t alloc( p->alloc);
-                allocator_traits_t::destroy( alloc, p);
-                allocator_traits_t::deallocate( alloc, p, 1);
-            }
+    struct segment {
+        std::atomic< segment * >        next{ nullptr };
+        slot                            slots[segment_capacity];
+
+        segment() noexcept {
         }
     };
 
-    using ptr_t = typename node::ptr_t;
-    using allocator_t = typename node::allocator_t;
-    using allocator_traits_t = typename node::allocator_traits_t;
+    typedef typename std::allocator_traits< Allocator >::template rebind_alloc<
+        segment
+    >                                                                       allocator_type;
+    typedef std::allocator_traits< allocator_type >                         allocator_traits_type;
+
+    // procuder cacheline
+    alignas(cache_alignment) std::atomic< std::size_t >     producer_idx_{ 0 };
+    std::atomic< segment * >                                producer_seg_{ nullptr };
+    // consumer cacheline
+    alignas(cache_alignment) std::atomic< std::size_t >     consumer_idx_{ 0 };
+    std::atomic< segment * >                                consumer_seg_{ nullptr };
+    // shared write cacheline
+    alignas(cache_alignment) std::atomic_bool               closed_{ false };
+    detail::waiter_count                                    consumer_waiters_{};
+    mutable detail::spinlock                                splk_{};
+    wait_queue_type                                         waiting_consumers_{};
+    // segment pool, touched once per segment
+    alignas(cache_alignment) std::atomic< segment * >       pool_[pool_capacity];
+    allocator_type                                          alloc_;
+    char                                                    pad_[cacheline_length];
+
+    static void backoff_( std::size_t & tests) noexcept {
+#if ! defined(BOOST_FIBERS_SPIN_SINGLE_CORE)
+        if ( BOOST_FIBERS_SPIN_MAX_TESTS > tests) {
+            ++tests;
+            cpu_relax();
+            return;
+        }
+#endif
+        // the other thread might have been preempted
+        std::this_thread::yield();
+    }
 
-    enum class queue_status {
-        open = 0,
-        closed
-    };
+    segment * allocate_segment_() {
+        segment * seg{ nullptr };
+        for ( std::atomic< segment * > & entry : pool_) {
+            if ( nullptr != entry.load( std::memory_order_relaxed) ) {
+                seg = entry.exchange( nullptr, std::memory_order_acquire);
+                if ( nullptr != seg) {
+                    break;
+                }
+            }
+        }
+        if ( nullptr == seg) {
+            seg = detail::convert( allocator_traits_type::allocate( alloc_, 1) );
+        }
+        allocator_traits_type::construct( alloc_, seg);
+        return seg;
+    }
 
-    allocator_t         alloc_;
-    queue_status        state_{ queue_status::open };
-    ptr_t               head_{};
-    ptr_t           *   tail_;
-    mutable mutex       mtx_{};
-    condition_variable  not_empty_cond_{};
+    void deallocate_segment_( segment * seg) noexcept {
+        allocator_traits_type::destroy( alloc_, seg);
+        allocator_traits_type::deallocate( alloc_, seg, 1);
+    }
 
-    bool is_closed_() const noexcept {
-        return queue_status::closed == state_;
+    // returns the segment to the pool, or to Allocator if the pool is full
+    void release_segment_( segment * seg) noexcept {
+        allocator_traits_type::destroy( alloc_, seg);
+        for ( std::atomic< segment * > & entry : pool_) {
+            segment * expected{ nullptr };
+            if ( entry.compare_exchange_strong( expected, seg,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed) ) {
+                return;
+            }
+        }
+        allocator_traits_type::deallocate( alloc_, seg, 1);
     }
 
-    void close_( std::unique_lock< mutex > & lk) noexcept {
-        state_ = queue_status::closed;
-        lk.unlock();
-        not_empty_cond_.notify_all();
+    // releases seg after all values have been consumed; slots from start
+    // on whose consumers did not finish take over the release
+    void destroy_segment_( segment * seg, std::size_t start) noexcept {
+        // the consumer of the last slot starts the release
+        for ( std::size_t i = start; i < segment_capacity - 1; ++i) {
+            slot & s = seg->slots[i];
+            if ( 0 == ( s.state.load( std::memory_order_acquire) & read) &&
+                 0 == ( s.state.fetch_or( destroy, std::memory_order_acq_rel) & read) ) {
+                return;
+            }
+        }
+        release_segment_( seg);
     }
 
     bool is_empty_() const noexcept {
-        return ! head_;
+        std::size_t head{ consumer_idx_.load( std::memory_order_seq_cst) };
+        std::size_t tail{ producer_idx_.load( std::memory_order_seq_cst) };
+        return ( head >> shift) == ( tail >> shift);
     }
 
-    channel_op_status push_( ptr_t new_node,
-                             std::unique_lock< mutex > & lk) noexcept {
-        if ( is_closed_() ) {
-            return channel_op_status::closed;
+    template< typename ValueType >
+    void push_( ValueType && value) {
+        std::size_t tests{ 0 };
+        std::size_t tail{ producer_idx_.load( std::memory_order_acquire) };
+        segment * seg{ producer_seg_.load( std::memory_order_acquire) };
+        segment * next_seg{ nullptr };
+        for (;;) {
+            std::size_t offset{ ( tail >> shift) % lap };
+            if ( segment_capacity == offset) {
+                // another producer is installing the next segment
+                backoff_( tests);
+                tail = producer_idx_.load( std::memory_order_acquire);
+                seg = producer_seg_.load( std::memory_order_acquire);
+                continue;
+            }
+            // allocate the next segment before claiming the last slot,
+            // the other producers wait till it is installed
+            if ( offset + 1 == segment_capacity && nullptr == next_seg) {
+                next_seg = allocate_segment_();
+            }
+            if ( producer_idx_.compare_exchange_weak( tail, tail + ( 1 << shift),
+                                                      std::memory_order_seq_cst,
+                                                      std::memory_order_acquire) ) {
+                if ( offset + 1 == segment_capacity) {
+                    // skip the last position of the segment
+                    producer_seg_.store( next_seg, std::memory_order_release);
+                    producer_idx_.store( tail + ( 2 << shift), std::memory_order_release);
+                    seg->next.store( next_seg, std::memory_order_release);
+                    next_seg = nullptr;
+                }
+                slot & s = seg->slots[offset];
+                try {
+                    ::new ( static_cast< void * >( std::addressof( s.storage) ) ) value_type( std::forward< ValueType >( value) );
+                } catch (...) {
+                    // the slot is claimed - its consumer waits for it
+                    s.state.fetch_or( written | skipped, std::memory_order_release);
+                    throw;
+                }
+                s.state.fetch_or( written, std::memory_order_release);
+                break;
+            }
+            seg = producer_seg_.load( std::memory_order_acquire);
+        }
+        if ( nullptr != next_seg) {
+            // another producer installed the next segment
+            release_segment_( next_seg);
         }
-        return push_and_notify_( new_node, lk);
     }
 
-    channel_op_status push_and_notify_( ptr_t new_node,
-                                        std::unique_lock< mutex > & lk) noexcept {
-        push_tail_( new_node);
-        lk.unlock();
-        not_empty_cond_.notify_one();
-        return channel_op_status::success;
+    // claims the next slot, nullptr if the channel is empty
+    slot * try_claim_slot_( segment *& seg, std::size_t & offset) noexcept {
+        std::size_t tests{ 0 };
+        std::size_t head{ consumer_idx_.load( std::memory_order_acquire) };
+        seg = consumer_seg_.load( std::memory_order_acquire);
+        for (;;) {
+            offset = ( head >> shift) % lap;
+            if ( segment_capacity == offset) {
+                // another consumer is moving to the next segment
+                backoff_( tests);
+                head = consumer_idx_.load( std::memory_order_acquire);
+                seg = consumer_seg_.load( std::memory_order_acquire);
+                continue;
+            }
+            std::size_t new_head{ head + ( 1 << shift) };
+            if ( 0 == ( new_head & has_next) ) {
+                std::atomic_thread_fence( std::memory_order_seq_cst);
+                std::size_t tail{ producer_idx_.load( std::memory_order_relaxed) };
+                if ( ( head >> shift) == ( tail >> shift) ) {
+                    return nullptr;
+                }
+                // producers already use a later segment
+                if ( ( head >> shift) / lap != ( tail >> shift) / lap) {
+                    new_head |= has_next;
+                }
+            }
+            if ( consumer_idx_.compare_exchange_weak( head, new_head,
+                                                      std::memory_order_seq_cst,
+                                                      std::memory_order_acquire) ) {
+                if ( offset + 1 == segment_capacity) {
+                    // move to the next segment, skipping its last position
+                    segment * next{ seg->next.load( std::memory_order_acquire) };
+                    while ( nullptr == next) {
+                        backoff_( tests);
+                        next = seg->next.load( std::memory_order_acquire);
+                    }
+                    std::size_t next_idx{ ( new_head & ~has_next) + ( 1 << shift) };
+                    if ( nullptr != next->next.load( std::memory_order_relaxed) ) {
+                        next_idx |= has_next;
+                    }
+                    consumer_seg_.store( next, std::memory_order_release);
+                    consumer_idx_.store( next_idx, std::memory_order_release);
+                }
+                slot * s{ & seg->slots[offset] };
+                // the producer claimed the slot but might not have stored
+                // the value yet
+                while ( 0 == ( s->state.load( std::memory_order_acquire) & written) ) {
+                    backoff_( tests);
+                }
+                return s;
+            }
+            seg = consumer_seg_.load( std::memory_order_acquire);
+        }
     }
 
-    void push_tail_( ptr_t new_node) noexcept {
-        * tail_ = new_node;
-        tail_ = & new_node->nxt;
+    // the value of the claimed slot has been moved and destroyed
+    void consumed_( segment * seg, std::size_t offset) noexcept {
+        if ( offset + 1 == segment_capacity) {
+            destroy_segment_( seg, 0);
+        } else if ( 0 != ( seg->slots[offset].state.fetch_or( read, std::memory_order_acq_rel) & destroy) ) {
+            destroy_segment_( seg, offset + 1);
+        }
     }
 
-    value_type value_pop_( std::unique_lock< mutex > & lk) {
-        BOOST_ASSERT( ! is_empty_() );
-        auto old_head = pop_head_();
-        return std::move( old_head->va);
+    // claims the slot of the next value, nullptr if the channel is empty
+    slot * try_claim_( segment *& seg, std::size_t & offset) noexcept {
+        for (;;) {
+            slot * s{ try_claim_slot_( seg, offset) };
+            if ( nullptr == s || 0 == ( s->state.load( std::memory_order_relaxed) & skipped) ) {
+                return s;
+            }
+            // the producer of the slot failed to construct the value
+            consumed_( seg, offset);
+        }
     }
 
-    ptr_t pop_head_() noexcept {
-        auto old_head = head_;
-        head_ = old_head->nxt;
-        if ( ! head_) {
-            tail_ = & head_;
+    bool try_pop_( value_type & value) {
+        segment * seg{ nullptr };
+        std::size_t offset{ 0 };
+        slot * s{ try_claim_( seg, offset) };
+        if ( nullptr == s) {
+            return false;
+        }
+        value = std::move( * s->value() );
+        s->value()->~value_type();
+        consumed_( seg, offset);
+        return true;
+    }
+
+    // readies one fiber blocked in pop()
+    void notify_consumer_() {
+        if ( ! consumer_waiters_.notify_needed() ) {
+            return;
+        }
+        lock_type lk{ splk_ };
+        if ( ! waiting_consumers_.empty() ) {
+            context * consumer_ctx{ & waiting_consumers_.front() };
+            waiting_consumers_.pop_front();
+            consumer_waiters_.leave();
+            lk.unlock();
+            context::active()->set_ready( consumer_ctx);
         }
-        old_head->nxt.reset();
-        return old_head;
     }
 
 public:
-    explicit unbounded_channel( Allocator const& alloc = Allocator() ) noexcept :
-        alloc_{ alloc },
-        tail_{ & head_ } {
+    explicit unbounded_channel( Allocator const& alloc = Allocator() ) :
+        alloc_{ alloc } {
+        for ( std::atomic< segment * > & entry : pool_) {
+            entry.store( nullptr, std::memory_order_relaxed);
+        }
+        segment * seg{ allocate_segment_() };
+        producer_seg_.store( seg, std::memory_order_relaxed);
+        consumer_seg_.store( seg, std::memory_order_relaxed);
+    }
+
+    ~unbounded_channel() {
+        close();
+        std::size_t head{ consumer_idx_.load( std::memory_order_relaxed) & ~has_next };
+        std::size_t tail{ producer_idx_.load( std::memory_order_relaxed) };
+        segment * seg{ consumer_seg_.load( std::memory_order_relaxed) };
+        for ( ; head != tail; head += ( 1 << shift) ) {
+            std::size_t offset{ ( head >> shift) % lap };
+            if ( segment_capacity > offset) {
+                if ( 0 == ( seg->slots[offset].state.load( std::memory_order_relaxed) & skipped) ) {
+                    seg->slots[offset].value()->~value_type();
+                }
+            } else {
+                segment * next{ seg->next.load( std::memory_order_relaxed) };
+                deallocate_segment_( seg);
+                seg = next;
+            }
+        }
+        deallocate_segment_( seg);
+        for ( std::atomic< segment * > & entry : pool_) {
+            segment * pooled{ entry.load( std::memory_order_relaxed) };
+            if ( nullptr != pooled) {
+                allocator_traits_type::deallocate( alloc_, pooled, 1);
+            }
+        }
     }
 
     unbounded_channel( unbounded_channel const&) = delete;
     unbounded_channel & operator=( unbounded_channel const&) = delete;
 
-    void close() noexcept {
-        std::unique_lock< mutex > lk( mtx_);
-        close_( lk);
+    bool is_closed() const noexcept {
+        return closed_.load( std::memory_order_acquire);
     }
 
-    channel_op_status push( value_type const& va) {
-        typename allocator_traits_t::pointer ptr{
-            allocator_traits_t::allocate( alloc_, 1) };
-        try {
-            allocator_traits_t::construct( alloc_, ptr, va, alloc_);
-        } catch (...) {
-            allocator_traits_t::deallocate( alloc_, ptr, 1);
-            throw;
-        }
-        std::unique_lock< mutex > lk( mtx_);
-        return push_( { detail::convert( ptr) }, lk);
+    void close() noexcept {
+        context * ctx{ context::active() };
+        lock_type lk{ splk_ };
+        closed_.store( true, std::memory_order_release);
+        // notify all waiting consumers
+        while ( ! waiting_consumers_.empty() ) {
+            context * consumer_ctx{ & waiting_consumers_.front() };
+            waiting_consumers_.pop_front();
+            consumer_waiters_.leave();
+            ctx->set_ready( consumer_ctx);
+        }
     }
 
-    channel_op_status push( value_type && va) {
-        typename allocator_traits_t::pointer ptr{
-            allocator_traits_t::allocate( alloc_, 1) };
-        try {
-            allocator_traits_t::construct(
-                    alloc_, ptr, std::move( va), alloc_);
-        } catch (...) {
-            allocator_traits_t::deallocate( alloc_, ptr, 1);
-            throw;
-        }
-        std::unique_lock< mutex > lk( mtx_);
-        return push_( { detail::convert( ptr) }, lk);
+    channel_op_status push( value_type const& value) {
+        if ( is_closed() ) {
+            return channel_op_status::closed;
+        }
+        push_( value);
+        // notify one waiting consumer
+        notify_consumer_();
+        return channel_op_status::success;
     }
 
-    channel_op_status pop( value_type & va) {
-        std::unique_lock< mutex > lk( mtx_);
-        not_empty_cond_.wait( lk,
-                              [this](){
-                                return is_closed_() || ! is_empty_();
-                              });
-        if ( is_closed_() && is_empty_() ) {
+    channel_op_status push( value_type && value) {
+        if ( is_closed() ) {
             return channel_op_status::closed;
         }
-        va = value_pop_( lk);
+        push_( std::move( value) );
+        // notify one waiting consumer
+        notify_consumer_();
         return channel_op_status::success;
     }
 
-    value_type value_pop() {
-        std::unique_lock< mutex > lk( mtx_);
-        not_empty_cond_.wait( lk,
-                              [this](){
-                                return is_closed_() || ! is_empty_();
-                              });
-        if ( is_closed_() && is_empty_() ) {
-            throw fiber_error(
-                    std::make_error_code( std::errc::operation_not_permitted),
-                    "boost fiber: queue is closed");
-        }
-        return value_pop_( lk);
+    channel_op_status try_pop( value_type & value) {
+        if ( try_pop_( value) ) {
+            return channel_op_status::success;
+        }
+        return is_closed() ? channel_op_status::closed : channel_op_status::empty;
     }
 
-    channel_op_status try_pop( value_type & va) {
-        std::unique_lock< mutex > lk( mtx_);
-        if ( is_closed_() && is_empty_() ) {
-            // let other fibers run
-            lk.unlock();
-            this_fiber::yield();
-            return channel_op_status::closed;
+    channel_op_status pop( value_type & value) {
+        context * ctx{ context::active() };
+        for (;;) {
+            if ( try_pop_( value) ) {
+                return channel_op_status::success;
+            }
+            BOOST_ASSERT( ! ctx->wait_is_linked() );
+            lock_type lk{ splk_ };
+            detail::waiter_guard wg{ consumer_waiters_ };
+            if ( ! is_empty_() ) {
+                continue;
+            }
+            if ( is_closed() ) {
+                return channel_op_status::closed;
+            }
+            ctx->wait_link( waiting_consumers_);
+            wg.release();
+            // suspend this consumer
+            ctx->suspend( lk);
         }
-        if ( is_empty_() ) {
-            // let other fibers run
-            lk.unlock();
-            this_fiber::yield();
-            return channel_op_status::empty;
+    }
+
+    value_type value_pop() {
+        context * ctx{ context::active() };
+        for (;;) {
+            segment * seg{ nullptr };
+            std::size_t offset{ 0 };
+            slot * s{ try_claim_( seg, offset) };
+            if ( nullptr != s) {
+                value_type value{ std::move( * s->value() ) };
+                s->value()->~value_type();
+                consumed_( seg, offset);
+                return std::move( value);
+            }
+            BOOST_ASSERT( ! ctx->wait_is_linked() );
+            lock_type lk{ splk_ };
+            detail::waiter_guard wg{ consumer_waiters_ };
+            if ( ! is_empty_() ) {
+                continue;
+            }
+            if ( is_closed() ) {
+                throw fiber_error{
+                        std::make_error_code( std::errc::operation_not_permitted),
+                        "boost fiber: channel is closed" };
+            }
+            ctx->wait_link( waiting_consumers_);
+            wg.release();
+            // suspend this consumer
+            ctx->suspend( lk);
         }
-        va = value_pop_( lk);
-        return channel_op_status::success;
     }
 
     template< typename Rep, typename Period >
-    channel_op_status pop_wait_for( value_type & va,
+    channel_op_status pop_wait_for( value_type & value,
                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
-        return pop_wait_until( va, std::chrono::steady_clock::now() + timeout_duration);
+        return pop_wait_until( value,
+                               std::chrono::steady_clock::now() + timeout_duration);
     }
 
     template< typename Clock, typename Duration >
-    channel_op_status pop_wait_until( value_type & va,
-                                      std::chrono::time_point< Clock, Duration > const& timeout_time) {
-        std::unique_lock< mutex > lk( mtx_);
-        if ( ! not_empty_cond_.wait_until( lk, timeout_time,
-                                           [this](){
-                                                 return is_closed_() || ! is_empty_();
-                                           })) {
-            return channel_op_status::timeout;
-        }
-        if ( is_closed_() && is_empty_() ) {
-            return channel_op_status::closed;
+    channel_op_status pop_wait_until( value_type & value,
+                                      std::chrono::time_point< Clock, Duration > const& timeout_time_) {
+        std::chrono::steady_clock::time_point timeout_time( detail::convert( timeout_time_) );
+        context * ctx{ context::active() };
+        for (;;) {
+            if ( try_pop_( value) ) {
+                return channel_op_status::success;
+            }
+            BOOST_ASSERT( ! ctx->wait_is_linked() );
+            lock_type lk{ splk_ };
+            detail::waiter_guard wg{ consumer_waiters_ };
+            if ( ! is_empty_() ) {
+                continue;
+            }
+            if ( is_closed() ) {
+                return channel_op_status::closed;
+            }
+            ctx->wait_link( waiting_consumers_);
+            wg.release();
+            // suspend this consumer
+            if ( ! ctx->wait_until( timeout_time, lk) ) {
+                // relock local lk
+                lk.lock();
+                // remove from waiting-queue, unless a notifier did
+                if ( ctx->wait_is_linked() ) {
+                    ctx->wait_unlink();
+                    consumer_waiters_.leave();
+                }
+                return channel_op_status::timeout;
+            }
         }
-        va = value_pop_( lk);
-        return channel_op_status::success;
     }
+
+    class iterator : public std::iterator< std::input_iterator_tag, typename std::remove_reference< value_type >::type > {
+    private:
+        typedef typename std::aligned_storage< sizeof( value_type), alignof( value_type) >::type  storage_type;
+
+        unbounded_channel   *   chan_{ nullptr };
+        storage_type            storage_;
+
+        void increment_() {
+            BOOST_ASSERT( nullptr != chan_);
+            try {
+                ::new ( static_cast< void * >( std::addressof( storage_) ) ) value_type{ chan_->value_pop() };
+            } catch ( fiber_error const&) {
+                chan_ = nullptr;
+            }
+        }
+
+    public:
+        typedef typename iterator::pointer pointer_t;
+        typedef typename iterator::reference reference_t;
+
+        iterator() noexcept = default;
+
+        explicit iterator( unbounded_channel * chan) noexcept :
+            chan_{ chan } {
+            increment_();
+        }
+
+        iterator( iterator const& other) noexcept :
+            chan_{ other.chan_ } {
+        }
+
+        iterator & operator=( iterator const& other) noexcept {
+            if ( this == & other) return * this;
+            chan_ = other.chan_;
+            return * this;
+        }
+
+        bool operator==( iterator const& other) const noexcept {
+            return other.chan_ == chan_;
+        }
+
+        bool operator!=( iterator const& other) const noexcept {
+            return other.chan_ != chan_;
+        }
+
+        iterator & operator++() {
+            increment_();
+            return * this;
+        }
+
+        iterator operator++( int) = delete;
+
+        reference_t operator*() noexcept {
+            return * reinterpret_cast< value_type * >( std::addressof( storage_) );
+        }
+
+        pointer_t operator->() noexcept {
+            return reinterpret_cast< value_type * >( std::addressof( storage_) );
+        }
+    };
+
+    friend class iterator;
 };
 
+template< typename T, typename Allocator >
+constexpr std::size_t unbounded_channel< T, Allocator >::shift;
+template< typename T, typename Allocator >
+constexpr std::size_t unbounded_channel< T, Allocator >::has_next;
+template< typename T, typename Allocator >
+constexpr std::size_t unbounded_channel< T, Allocator >::lap;
+template< typename T, typename Allocator >
+constexpr std::size_t unbounded_channel< T, Allocator >::segment_capacity;
+template< typename T, typename Allocator >
+constexpr std::size_t unbounded_channel< T, Allocator >::pool_capacity;
+
+template< typename T, typename Allocator >
+typename unbounded_channel< T, Allocator >::iterator
+begin( unbounded_channel< T, Allocator > & chan) {
+    return typename unbounded_channel< T, Allocator >::iterator( & chan);
+}
+
+template< typename T, typename Allocator >
+typename unbounded_channel< T, Allocator >::iterator
+end( unbounded_channel< T, Allocator > &) {
+    return typename unbounded_channel< T, Allocator >::iterator();
+}
+
 }}
 
 #ifdef BOOST_HAS_ABI_HEADERS
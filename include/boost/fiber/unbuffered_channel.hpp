@@ -12,6 +12,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <boost/config.hpp>
@@ -20,8 +21,11 @@
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/convert.hpp>
+#include <boost/fiber/detail/select_waiter.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/detail/waiter_count.hpp>
 #include <boost/fiber/exceptions.hpp>
+#include <boost/fiber/spinlock_policy.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -30,17 +34,24 @@
 namespace boost {
 namespace fibers {
 
-template< typename T >
+// Spinlock protects the wait-queues; defaults to the spinlock the library
+// was built with (see spinlock_policy)
+template< typename T, typename Spinlock = detail::spinlock >
 class unbuffered_channel {
 public:
     typedef T   value_type;
 
 private:
-    typedef context::wait_queue_t   wait_queue_type;
+    typedef context::wait_queue_t           wait_queue_type;
+    typedef std::unique_lock< Spinlock >    lock_type;
 
+    // lives on the stack of the producer; splk is held by the producer till
+    // it is suspended, a consumer acquires it before it resumes the producer
     struct alignas(cache_alignment) slot {
         value_type  value;
         context *   ctx;
+        Spinlock    splk{};
+        bool        consumed{ false };
 
         slot( value_type const& value_, context * ctx_) :
             value{ value_ },
@@ -57,9 +68,13 @@ private:
     alignas(cache_alignment) std::atomic< slot * >  slot_{ nullptr };
     // shared cacheline
     alignas(cache_alignment) std::atomic_bool       closed_{ false };
-    mutable detail::spinlock                        splk_{};
+    detail::waiter_count                            producer_waiters_{};
+    detail::waiter_count                            consumer_waiters_{};
+    mutable Spinlock                                splk_{};
     wait_queue_type                                 waiting_producers_{};
     wait_queue_type                                 waiting_consumers_{};
+    detail::select_queue                            select_producers_{};
+    detail::select_queue                            select_consumers_{};
     char                                            pad_[cacheline_length];
 
     bool is_empty_() {
@@ -92,6 +107,106 @@ private:
         }
     }
 
+    // readies one fiber blocked in push() or, if there is none, one select()
+    // with a push case on this channel
+    void notify_producer_() {
+        if ( ! producer_waiters_.notify_needed() ) {
+            return;
+        }
+        lock_type lk{ splk_ };
+        if ( ! waiting_producers_.empty() ) {
+            context * producer_ctx{ & waiting_producers_.front() };
+            waiting_producers_.pop_front();
+            producer_waiters_.leave();
+            lk.unlock();
+            context::active()->set_ready( producer_ctx);
+            return;
+        }
+        detail::select_notify_one( select_producers_, producer_waiters_);
+    }
+
+    // readies one fiber blocked in pop() or, if there is none, one select()
+    // with a pop case on this channel
+    void notify_consumer_() {
+        if ( ! consumer_waiters_.notify_needed() ) {
+            return;
+        }
+        lock_type lk{ splk_ };
+        if ( ! waiting_consumers_.empty() ) {
+            context * consumer_ctx{ & waiting_consumers_.front() };
+            waiting_consumers_.pop_front();
+            consumer_waiters_.leave();
+            lk.unlock();
+            context::active()->set_ready( consumer_ctx);
+            return;
+        }
+        detail::select_notify_one( select_consumers_, consumer_waiters_);
+    }
+
+    // operations of the select() cases (see select.hpp)
+    channel_op_status select_try_pop_( value_type & value) {
+        slot * s{ try_pop_() };
+        if ( nullptr == s) {
+            return is_closed() ? channel_op_status::closed : channel_op_status::empty;
+        }
+        // notify one waiting producer
+        notify_producer_();
+        // acquired as soon as the producer is suspended
+        lock_type slk{ s->splk };
+        // consume value
+        value = std::move( s->value);
+        s->consumed = true;
+        context * producer_ctx{ s->ctx };
+        slk.unlock();
+        // resume suspended producer
+        context::active()->set_ready( producer_ctx);
+        return channel_op_status::success;
+    }
+
+    // the case is chosen as soon as the slot is free, the value is handed
+    // over as by push() - the fiber waits till a consumer has taken it
+    template< typename ValueType >
+    channel_op_status select_try_push_( ValueType && value,
+                                        std::chrono::steady_clock::time_point const* timeout_time) {
+        if ( is_closed() ) {
+            return channel_op_status::closed;
+        }
+        if ( ! is_empty_() ) {
+            return channel_op_status::full;
+        }
+        return nullptr == timeout_time
+            ? push( std::forward< ValueType >( value) )
+            : push_wait_until( std::forward< ValueType >( value), * timeout_time);
+    }
+
+    // links w unless the case became ready meanwhile
+    bool select_arm_( detail::select_waiter & w, bool push) {
+        lock_type lk{ splk_ };
+        detail::waiter_count & waiters = push ? producer_waiters_ : consumer_waiters_;
+        waiters.enter();
+        if ( is_closed() || ( push ? is_empty_() : ! is_empty_() ) ) {
+            waiters.leave();
+            return false;
+        }
+        ( push ? select_producers_ : select_consumers_).push_back( w);
+        return true;
+    }
+
+    void select_disarm_( detail::select_waiter & w, bool push) noexcept {
+        // synchronizes with a notifier that might still access the
+        // select_state of w
+        lock_type lk{ splk_ };
+        if ( w.is_linked() ) {
+            w.unlink();
+            ( push ? producer_waiters_ : consumer_waiters_).leave();
+        }
+    }
+
+    template< typename >
+    friend class detail::select_pop_case;
+    template< typename, typename >
+    friend class detail::select_push_case;
+
 public:
     unbuffered_channel() = default;
 
@@ -101,8 +216,12 @@ public:
         if ( nullptr != ( s = try_pop_() ) ) {
             BOOST_ASSERT( nullptr != s);
             BOOST_ASSERT( nullptr != s->ctx);
+            lock_type slk{ s->splk };
+            s->consumed = true;
+            context * producer_ctx{ s->ctx };
+            slk.unlock();
             // value will be destructed in the context of the waiting fiber
-            context::active()->set_ready( s->ctx);
+            context::active()->set_ready( producer_ctx);
         }
     }
 
@@ -115,20 +234,24 @@ public:
 
     void close() noexcept {
         context * ctx{ context::active() };
-        detail::spinlock_lock lk{ splk_ };
+        lock_type lk{ splk_ };
         closed_.store( true, std::memory_order_release);
         // notify all waiting producers
         while ( ! waiting_producers_.empty() ) {
             context * producer_ctx{ & waiting_producers_.front() };
             waiting_producers_.pop_front();
+            producer_waiters_.leave();
             ctx->set_ready( producer_ctx);
         }
         // notify all waiting consumers
         while ( ! waiting_consumers_.empty() ) {
             context * consumer_ctx{ & waiting_consumers_.front() };
             waiting_consumers_.pop_front();
+            consumer_waiters_.leave();
             ctx->set_ready( consumer_ctx);
         }
+        detail::select_notify_all( select_producers_, producer_waiters_);
+        detail::select_notify_all( select_consumers_, consumer_waiters_);
     }
 
     channel_op_status push( value_type const& value) {
@@ -138,21 +261,19 @@ public:
             if ( is_closed() ) {
                 return channel_op_status::closed;
             }
+            lock_type slk{ s.splk };
             if ( try_push_( & s) ) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 // suspend till value has been consumed
-                ctx->suspend( lk);
+                ctx->suspend( slk);
                 // resumed, value has been consumed
                 return channel_op_status::success;
             } else {
+                slk.unlock();
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ producer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -160,6 +281,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                wg.release();
                 // suspend this producer
                 ctx->suspend( lk);
                 // resumed, slot mabye free
@@ -174,21 +296,19 @@ public:
             if ( is_closed() ) {
                 return channel_op_status::closed;
             }
+            lock_type slk{ s.splk };
             if ( try_push_( & s) ) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 // suspend till value has been consumed
-                ctx->suspend( lk);
+                ctx->suspend( slk);
                 // resumed, value has been consumed
                 return channel_op_status::success;
             } else {
+                slk.unlock();
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ producer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -196,6 +316,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                wg.release();
                 // suspend this producer
                 ctx->suspend( lk);
                 // resumed, slot mabye free
@@ -227,31 +348,36 @@ public:
             if ( is_closed() ) {
                 return channel_op_status::closed;
             }
+            lock_type slk{ s.splk };
             if ( try_push_( & s) ) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 // suspend this producer
-                if ( ! ctx->wait_until( timeout_time, lk) ) {
+                if ( ! ctx->wait_until( timeout_time, slk) ) {
+                    // relock local slk
+                    slk.lock();
                     // clear slot
                     slot * nil_slot{ nullptr }, * own_slot{ & s };
-                    slot_.compare_exchange_strong( own_slot, nil_slot, std::memory_order_acq_rel);
-                    // relock local lk
-                    lk.lock();
-                    // remove from waiting-queue
-                    ctx->wait_unlink();
-                    // resumed, value has not been consumed
-                    return channel_op_status::timeout;
+                    if ( slot_.compare_exchange_strong( own_slot, nil_slot, std::memory_order_acq_rel) ) {
+                        // resumed, value has not been consumed
+                        return channel_op_status::timeout;
+                    }
+                    // a consumer has taken the slot, s must outlive its access
+                    // if the value has been consumed already, the wake-up
+                    // of the consumer races with the timeout: it might reach
+                    // this fiber after push_wait_until() returned - a
+                    // spurious wake-up, as with the other timed waits
+                    if ( ! s.consumed) {
+                        ctx->suspend( slk);
+                    }
                 }
                 // resumed, value has been consumed
                 return channel_op_status::success;
             } else {
+                slk.unlock();
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ producer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -259,12 +385,16 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                wg.release();
                 // suspend this producer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
                     lk.lock();
-                    // remove from waiting-queue
-                    ctx->wait_unlink();
+                    // remove from waiting-queue, unless a notifier did
+                    if ( ctx->wait_is_linked() ) {
+                        ctx->wait_unlink();
+                        producer_waiters_.leave();
+                    }
                     return channel_op_status::timeout;
                 }
                 // resumed, slot maybe free
@@ -282,31 +412,36 @@ public:
             if ( is_closed() ) {
                 return channel_op_status::closed;
             }
+            lock_type slk{ s.splk };
             if ( try_push_( & s) ) {
-                detail::spinlock_lock lk{ splk_ };
                 // notify one waiting consumer
-                if ( ! waiting_consumers_.empty() ) {
-                    context * consumer_ctx{ & waiting_consumers_.front() };
-                    waiting_consumers_.pop_front();
-                    ctx->set_ready( consumer_ctx);
-                }
+                notify_consumer_();
                 // suspend this producer
-                if ( ! ctx->wait_until( timeout_time, lk) ) {
+                if ( ! ctx->wait_until( timeout_time, slk) ) {
+                    // relock local slk
+                    slk.lock();
                     // clear slot
                     slot * nil_slot{ nullptr }, * own_slot{ & s };
-                    slot_.compare_exchange_strong( own_slot, nil_slot, std::memory_order_acq_rel);
-                    // relock local lk
-                    lk.lock();
-                    // remove from waiting-queue
-                    ctx->wait_unlink();
-                    // resumed, value has not been consumed
-                    return channel_op_status::timeout;
+                    if ( slot_.compare_exchange_strong( own_slot, nil_slot, std::memory_order_acq_rel) ) {
+                        // resumed, value has not been consumed
+                        return channel_op_status::timeout;
+                    }
+                    // a consumer has taken the slot, s must outlive its access
+                    // if the value has been consumed already, the wake-up
+                    // of the consumer races with the timeout: it might reach
+                    // this fiber after push_wait_until() returned - a
+                    // spurious wake-up, as with the other timed waits
+                    if ( ! s.consumed) {
+                        ctx->suspend( slk);
+                    }
                 }
                 // resumed, value has been consumed
                 return channel_op_status::success;
             } else {
+                slk.unlock();
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ producer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -314,12 +449,16 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_producers_);
+                wg.release();
                 // suspend this producer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
                     lk.lock();
-                    // remove from waiting-queue
-                    ctx->wait_unlink();
+                    // remove from waiting-queue, unless a notifier did
+                    if ( ctx->wait_is_linked() ) {
+                        ctx->wait_unlink();
+                        producer_waiters_.leave();
+                    }
                     return channel_op_status::timeout;
                 }
                 // resumed, slot maybe free
@@ -332,24 +471,22 @@ public:
         slot * s{ nullptr };
         for (;;) {
             if ( nullptr != ( s = try_pop_() ) ) {
-                {
-                    detail::spinlock_lock lk{ splk_ };
-                    // notify one waiting producer
-                    if ( ! waiting_producers_.empty() ) {
-                        context * producer_ctx{ & waiting_producers_.front() };
-                        waiting_producers_.pop_front();
-                        lk.unlock();
-                        ctx->set_ready( producer_ctx);
-                    }
-                }
+                // notify one waiting producer
+                notify_producer_();
+                // acquired as soon as the producer is suspended
+                lock_type slk{ s->splk };
                 // consume value
                 value = std::move( s->value);
+                s->consumed = true;
+                context * producer_ctx{ s->ctx };
+                slk.unlock();
                 // resume suspended producer
-                ctx->set_ready( s->ctx);
+                ctx->set_ready( producer_ctx);
                 return channel_op_status::success;
             } else {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ consumer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -357,6 +494,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                wg.release();
                 // suspend this consumer
                 ctx->suspend( lk);
                 // resumed, slot mabye set
@@ -369,24 +507,22 @@ public:
         slot * s{ nullptr };
         for (;;) {
             if ( nullptr != ( s = try_pop_() ) ) {
-                {
-                    detail::spinlock_lock lk{ splk_ };
-                    // notify one waiting producer
-                    if ( ! waiting_producers_.empty() ) {
-                        context * producer_ctx{ & waiting_producers_.front() };
-                        waiting_producers_.pop_front();
-                        lk.unlock();
-                        ctx->set_ready( producer_ctx);
-                    }
-                }
+                // notify one waiting producer
+                notify_producer_();
+                // acquired as soon as the producer is suspended
+                lock_type slk{ s->splk };
                 // consume value
                 value_type value{ std::move( s->value) };
+                s->consumed = true;
+                context * producer_ctx{ s->ctx };
+                slk.unlock();
                 // resume suspended producer
-                ctx->set_ready( s->ctx);
+                ctx->set_ready( producer_ctx);
                 return std::move( value);
             } else {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ consumer_waiters_ };
                 if ( is_closed() ) {
                     throw fiber_error{
                             std::make_error_code( std::errc::operation_not_permitted),
@@ -396,6 +532,7 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                wg.release();
                 // suspend this consumer
                 ctx->suspend( lk);
                 // resumed, slot mabye set
@@ -418,24 +555,22 @@ public:
         slot * s{ nullptr };
         for (;;) {
             if ( nullptr != ( s = try_pop_() ) ) {
-                {
-                    detail::spinlock_lock lk{ splk_ };
-                    // notify one waiting producer
-                    if ( ! waiting_producers_.empty() ) {
-                        context * producer_ctx{ & waiting_producers_.front() };
-                        waiting_producers_.pop_front();
-                        lk.unlock();
-                        ctx->set_ready( producer_ctx);
-                    }
-                }
+                // notify one waiting producer
+                notify_producer_();
+                // acquired as soon as the producer is suspended
+                lock_type slk{ s->splk };
                 // consume value
                 value = std::move( s->value);
+                s->consumed = true;
+                context * producer_ctx{ s->ctx };
+                slk.unlock();
                 // resume suspended producer
-                ctx->set_ready( s->ctx);
+                ctx->set_ready( producer_ctx);
                 return channel_op_status::success;
             } else {
                 BOOST_ASSERT( ! ctx->wait_is_linked() );
-                detail::spinlock_lock lk{ splk_ };
+                lock_type lk{ splk_ };
+                detail::waiter_guard wg{ consumer_waiters_ };
                 if ( is_closed() ) {
                     return channel_op_status::closed;
                 }
@@ -443,12 +578,16 @@ public:
                     continue;
                 }
                 ctx->wait_link( waiting_consumers_);
+                wg.release();
                 // suspend this consumer
                 if ( ! ctx->wait_until( timeout_time, lk) ) {
                     // relock local lk
                     lk.lock();
-                    // remove from waiting-queue
-                    ctx->wait_unlink();
+                    // remove from waiting-queue, unless a notifier did
+                    if ( ctx->wait_is_linked() ) {
+                        ctx->wait_unlink();
+                        consumer_waiters_.leave();
+                    }
                     return channel_op_status::timeout;
                 }
             }
@@ -477,7 +616,7 @@ public:
 
         iterator() noexcept = default;
 
-        explicit iterator( unbuffered_channel< T > * chan) noexcept :
+        explicit iterator( unbuffered_channel * chan) noexcept :
             chan_{ chan } {
             increment_();
         }
@@ -519,16 +658,16 @@ public:
     friend class iterator;
 };
 
-template< typename T >
-typename unbuffered_channel< T >::iterator
-begin( unbuffered_channel< T > & chan) {
-    return typename unbuffered_channel< T >::iterator( & chan);
+template< typename T, typename Spinlock >
+typename unbuffered_channel< T, Spinlock >::iterator
+begin( unbuffered_channel< T, Spinlock > & chan) {
+    return typename unbuffered_channel< T, Spinlock >::iterator( & chan);
 }
 
-template< typename T >
-typename unbuffered_channel< T >::iterator
-end( unbuffered_channel< T > &) {
-    return typename unbuffered_channel< T >::iterator();
+template< typename T, typename Spinlock >
+typename unbuffered_channel< T, Spinlock >::iterator
+end( unbuffered_channel< T, Spinlock > &) {
+    return typename unbuffered_channel< T, Spinlock >::iterator();
 }
 
 }}
@@ -0,0 +1,102 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// compares mutex::try_lock() with mutex::try_lock_and_yield()
+// fibers update counters protected by striped locks; a stripe is acquired
+// optimistically via try-lock, on failure the next stripe is tried and
+// finally lock() is called
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+struct stripe {
+    boost::fibers::mutex    mtx{};
+    std::uint64_t           value{ 0 };
+};
+
+template< typename TryLock >
+void worker( std::vector< stripe > & stripes, std::size_t seed, std::size_t ops, TryLock try_lock) {
+    std::uint64_t x = seed * 2654435761u + 1;
+    for ( std::size_t i = 0; i < ops; ++i) {
+        // xorshift - picks a stripe
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        std::size_t idx = x % stripes.size();
+        stripe * s = nullptr;
+        for ( std::size_t j = 0; j < 2; ++j) {
+            stripe & candidate = stripes[( idx + j) % stripes.size()];
+            if ( try_lock( candidate.mtx) ) {
+                s = & candidate;
+                break;
+            }
+        }
+        if ( nullptr == s) {
+            s = & stripes[idx];
+            s->mtx.lock();
+        }
+        ++s->value;
+        if ( 0 == i % 32) {
+            // keep the lock held across a suspension now and then,
+            // so that try-lock fails occasionally
+            boost::this_fiber::yield();
+        }
+        s->mtx.unlock();
+    }
+}
+
+template< typename TryLock >
+duration_type measure( std::size_t fibers, std::size_t stripes_count, std::size_t ops, TryLock try_lock) {
+    std::vector< stripe > stripes( stripes_count);
+    std::vector< boost::fibers::fiber > workers;
+    time_point_type start{ clock_type::now() };
+    for ( std::size_t i = 0; i < fibers; ++i) {
+        workers.emplace_back( worker< TryLock >, std::ref( stripes), i, ops, try_lock);
+    }
+    for ( boost::fibers::fiber & f : workers) {
+        f.join();
+    }
+    duration_type duration = clock_type::now() - start;
+    std::uint64_t total = 0;
+    for ( stripe & s : stripes) {
+        total += s.value;
+    }
+    if ( total != fibers * ops) {
+        throw std::runtime_error( "lost update");
+    }
+    return duration;
+}
+
+int main() {
+    try {
+        std::size_t fibers{ 100 };
+        std::size_t stripes{ 16 };
+        std::size_t ops{ 10000 };
+        duration_type d1 = measure( fibers, stripes, ops,
+                [](boost::fibers::mutex & mtx){ return mtx.try_lock(); });
+        duration_type d2 = measure( fibers, stripes, ops,
+                [](boost::fibers::mutex & mtx){ return mtx.try_lock_and_yield(); });
+        std::size_t n = fibers * ops;
+        std::cout << "try_lock():           " << std::chrono::duration_cast< std::chrono::nanoseconds >( d1).count() / n << " ns/op" << std::endl;
+        std::cout << "try_lock_and_yield(): " << std::chrono::duration_cast< std::chrono::nanoseconds >( d2).count() / n << " ns/op" << std::endl;
+        std::cout << "done." << std::endl;
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
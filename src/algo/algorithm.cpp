@@ -6,7 +6,16 @@
 
 #include "boost/fiber/algo/algorithm.hpp"
 
+#include <boost/predef.h>
+
 #include "boost/fiber/context.hpp"
+#include "boost/fiber/detail/parker.hpp"
+
+#if BOOST_OS_LINUX && defined(BOOST_FIBERS_TIMER_SLACK)
+extern "C" {
+#include <sys/prctl.h>
+}
+#endif
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -28,6 +37,18 @@ algorithm_with_properties_base::set_properties( context * ctx, fiber_properties
     ctx->set_properties( props);
 }
 
+}
+
+namespace detail {
+
+parker::parker() noexcept {
+#if BOOST_OS_LINUX && defined(BOOST_FIBERS_TIMER_SLACK)
+    // the kernel delays timed wake-ups of this thread by up to the timer
+    // slack (default 50us) in order to coalesce them
+    ::prctl( PR_SET_TIMERSLACK, static_cast< unsigned long >( BOOST_FIBERS_TIMER_SLACK), 0, 0, 0);
+#endif
+}
+
 }}}
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -0,0 +1,302 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/algo/epoll.hpp"
+
+#if BOOST_OS_LINUX
+
+#include <cerrno>
+#include <climits>
+#include <system_error>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <boost/assert.hpp>
+
+#include "boost/fiber/exceptions.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+namespace {
+
+thread_local epoll * instance_{ nullptr };
+
+// number of picks after which pending I/O is polled even though
+// fibers are ready; prevents ready fibers from starving I/O waiters
+constexpr std::size_t poll_interval = 64;
+
+constexpr int max_events = 64;
+
+}
+
+epoll::epoll() {
+    epfd_ = ::epoll_create1( EPOLL_CLOEXEC);
+    if ( -1 == epfd_) {
+        throw fiber_error(
+                std::error_code( errno, std::system_category() ),
+                "boost fiber: epoll_create1() failed");
+    }
+    evfd_ = ::eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ( -1 == evfd_) {
+        std::error_code ec( errno, std::system_category() );
+        ::close( epfd_);
+        throw fiber_error( ec, "boost fiber: eventfd() failed");
+    }
+    ::epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = evfd_;
+    if ( -1 == ::epoll_ctl( epfd_, EPOLL_CTL_ADD, evfd_, & ev) ) {
+        std::error_code ec( errno, std::system_category() );
+        ::close( evfd_);
+        ::close( epfd_);
+        throw fiber_error( ec, "boost fiber: epoll_ctl() failed");
+    }
+    instance_ = this;
+}
+
+epoll::~epoll() {
+    BOOST_ASSERT( 0 == waiting_);
+    if ( this == instance_) {
+        instance_ = nullptr;
+    }
+    ::close( evfd_);
+    ::close( epfd_);
+}
+
+epoll *
+epoll::instance() noexcept {
+    return instance_;
+}
+
+bool
+epoll::arm_( int fd, waiters & w) noexcept {
+    ::epoll_event ev{};
+    ev.events = EPOLLONESHOT;
+    if ( nullptr != w.reader) {
+        ev.events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if ( nullptr != w.writer) {
+        ev.events |= EPOLLOUT;
+    }
+    ev.data.fd = fd;
+    int op = w.registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if ( -1 == ::epoll_ctl( epfd_, op, fd, & ev) ) {
+        // the descriptor might have been closed (dropping the registration)
+        // or reused since the last wait
+        if ( ( EPOLL_CTL_MOD == op && ENOENT == errno) ||
+             ( EPOLL_CTL_ADD == op && EEXIST == errno) ) {
+            op = EPOLL_CTL_MOD == op ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+            if ( -1 == ::epoll_ctl( epfd_, op, fd, & ev) ) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    w.registered = true;
+    return true;
+}
+
+void
+epoll::poll_( int timeout) noexcept {
+    ::epoll_event evs[max_events];
+    int n = ::epoll_wait( epfd_, evs, max_events, timeout);
+    context * active_ctx = context::active();
+    for ( int i = 0; i < n; ++i) {
+        int fd = evs[i].data.fd;
+        std::uint32_t events = evs[i].events;
+        if ( evfd_ == fd) {
+            std::uint64_t cnt;
+            while ( -1 != ::read( evfd_, & cnt, sizeof( cnt) ) ) {
+            }
+            // cleared after draining; a notify() racing with the read
+            // signals fibers the dispatcher collects before blocking again
+            notified_.store( false, std::memory_order_release);
+            continue;
+        }
+        if ( wakefd_ == fd) {
+            continue;
+        }
+        BOOST_ASSERT( 0 <= fd);
+        BOOST_ASSERT( static_cast< std::size_t >( fd) < fds_.size() );
+        waiters & w = fds_[fd];
+        if ( nullptr != w.reader &&
+             0 != ( events & ( EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR) ) ) {
+            context * ctx = w.reader;
+            w.reader = nullptr;
+            --waiting_;
+            active_ctx->set_ready( ctx);
+        }
+        if ( nullptr != w.writer &&
+             0 != ( events & ( EPOLLOUT | EPOLLHUP | EPOLLERR) ) ) {
+            context * ctx = w.writer;
+            w.writer = nullptr;
+            --waiting_;
+            active_ctx->set_ready( ctx);
+        }
+        // EPOLLONESHOT disabled the descriptor - rearm for the other direction
+        if ( ( nullptr != w.reader || nullptr != w.writer) && ! arm_( fd, w) ) {
+            // cannot watch the descriptor any longer; let the waiter
+            // retry its operation and observe the error
+            if ( nullptr != w.reader) {
+                active_ctx->set_ready( w.reader);
+                w.reader = nullptr;
+                --waiting_;
+            }
+            if ( nullptr != w.writer) {
+                active_ctx->set_ready( w.writer);
+                w.writer = nullptr;
+                --waiting_;
+            }
+        }
+    }
+}
+
+void
+epoll::wait_( int fd, bool write) {
+    BOOST_ASSERT( this == instance_);
+    if ( 0 > fd) {
+        throw fiber_error(
+                std::make_error_code( std::errc::bad_file_descriptor),
+                "boost fiber: invalid file descriptor");
+    }
+    if ( static_cast< std::size_t >( fd) >= fds_.size() ) {
+        fds_.resize( fd + 1);
+    }
+    waiters & w = fds_[fd];
+    context * & slot = write ? w.writer : w.reader;
+    if ( nullptr != slot) {
+        throw fiber_error(
+                std::make_error_code( std::errc::device_or_resource_busy),
+                "boost fiber: file descriptor already waited on");
+    }
+    context * active_ctx = context::active();
+    slot = active_ctx;
+    if ( ! arm_( fd, w) ) {
+        std::error_code ec( errno, std::system_category() );
+        slot = nullptr;
+        throw fiber_error( ec, "boost fiber: epoll_ctl() failed");
+    }
+    ++waiting_;
+    // resumed by poll_() from pick_next() or suspend_until()
+    active_ctx->suspend();
+}
+
+void
+epoll::watch_( int fd) {
+    BOOST_ASSERT( -1 == wakefd_);
+    ::epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if ( -1 == ::epoll_ctl( epfd_, EPOLL_CTL_ADD, fd, & ev) ) {
+        throw fiber_error(
+                std::error_code( errno, std::system_category() ),
+                "boost fiber: epoll_ctl() failed");
+    }
+    wakefd_ = fd;
+}
+
+void
+epoll::awakened( context * ctx) noexcept {
+    BOOST_ASSERT( nullptr != ctx);
+
+    BOOST_ASSERT( ! ctx->ready_is_linked() );
+    ctx->ready_link( rqueue_);
+}
+
+context *
+epoll::pick_next() noexcept {
+    if ( 0 < waiting_ && 0 == ++picks_ % poll_interval) {
+        poll_( 0);
+    }
+    context * victim = rqueue_.pop();
+    BOOST_ASSERT( nullptr == victim || ! victim->ready_is_linked() );
+    return victim;
+}
+
+bool
+epoll::has_ready_fibers() const noexcept {
+    return ! rqueue_.empty();
+}
+
+void
+epoll::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    int timeout = -1;
+    if ( (std::chrono::steady_clock::time_point::max)() != time_point) {
+        std::chrono::steady_clock::duration d = time_point - std::chrono::steady_clock::now();
+        if ( std::chrono::steady_clock::duration::zero() >= d) {
+            timeout = 0;
+        } else {
+            // round up - waking early would only cause another round trip
+            auto ms = std::chrono::duration_cast< std::chrono::milliseconds >(
+                    d + std::chrono::milliseconds( 1) - std::chrono::steady_clock::duration( 1) ).count();
+            timeout = INT_MAX < ms ? INT_MAX : static_cast< int >( ms);
+        }
+    }
+    poll_( timeout);
+}
+
+void
+epoll::notify() noexcept {
+    if ( ! notified_.exchange( true, std::memory_order_acq_rel) ) {
+        std::uint64_t cnt = 1;
+        while ( -1 == ::write( evfd_, & cnt, sizeof( cnt) ) && EINTR == errno) {
+        }
+    }
+}
+
+void
+epoll::wait_readable( int fd) {
+    wait_( fd, false);
+}
+
+void
+epoll::wait_writable( int fd) {
+    wait_( fd, true);
+}
+
+}
+
+namespace {
+
+algo::epoll * epoll_instance() {
+    algo::epoll * algo = algo::epoll::instance();
+    if ( nullptr == algo) {
+        throw fiber_error(
+                std::make_error_code( std::errc::operation_not_supported),
+                "boost fiber: epoll is not the scheduling algorithm of this thread");
+    }
+    return algo;
+}
+
+}
+
+}
+
+namespace this_fiber {
+
+void wait_readable( int fd) {
+    fibers::epoll_instance()->wait_readable( fd);
+}
+
+void wait_writable( int fd) {
+    fibers::epoll_instance()->wait_writable( fd);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_OS_LINUX
@@ -0,0 +1,448 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/algo/io_uring.hpp"
+
+#if BOOST_OS_LINUX
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <boost/assert.hpp>
+
+#include "boost/fiber/type.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+namespace {
+
+thread_local algo::io_uring * instance_{ nullptr };
+
+// an operation submitted by a suspended fiber; lives on its stack
+struct operation {
+    context     *   ctx;
+    int             res;
+};
+
+int io_uring_setup( unsigned int entries, ::io_uring_params * p) noexcept {
+    return static_cast< int >( ::syscall( __NR_io_uring_setup, entries, p) );
+}
+
+int io_uring_enter( int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags) noexcept {
+    return static_cast< int >( ::syscall( __NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0) );
+}
+
+// readiness based execution of an operation: retried after
+// algo::epoll reported the descriptor ready
+template< typename Fn >
+::ssize_t retry( int fd, bool write, Fn && fn) {
+    for (;;) {
+        ::ssize_t r = fn();
+        if ( 0 <= r) {
+            return r;
+        }
+        if ( EINTR == errno) {
+            continue;
+        }
+        algo::epoll * algo = algo::epoll::instance();
+        if ( ( EAGAIN == errno || EWOULDBLOCK == errno) && nullptr != algo) {
+            if ( write) {
+                algo->wait_writable( fd);
+            } else {
+                algo->wait_readable( fd);
+            }
+            continue;
+        }
+        return -errno;
+    }
+}
+
+::ssize_t fallback_read( int fd, void * buf, std::size_t len, std::int64_t offset) {
+    return retry( fd, false, [=](){
+        return -1 == offset ? ::read( fd, buf, len) : ::pread( fd, buf, len, offset);
+    });
+}
+
+::ssize_t fallback_write( int fd, void const* buf, std::size_t len, std::int64_t offset) {
+    return retry( fd, true, [=](){
+        return -1 == offset ? ::write( fd, buf, len) : ::pwrite( fd, buf, len, offset);
+    });
+}
+
+int fallback_fsync( int fd, bool datasync) {
+    return static_cast< int >( retry( fd, true, [=](){
+        return static_cast< ::ssize_t >( datasync ? ::fdatasync( fd) : ::fsync( fd) );
+    }) );
+}
+
+int fallback_accept( int fd, ::sockaddr * addr, ::socklen_t * addrlen, int flags) {
+    return static_cast< int >( retry( fd, false, [=](){
+        return static_cast< ::ssize_t >( ::accept4( fd, addr, addrlen, flags) );
+    }) );
+}
+
+template< typename T >
+T result( T r) noexcept {
+    if ( 0 > r) {
+        errno = static_cast< int >( -r);
+        return -1;
+    }
+    return r;
+}
+
+}
+
+namespace algo {
+
+io_uring::io_uring( unsigned int entries) {
+    if ( 0 == entries) {
+        instance_ = this;
+        return;
+    }
+    ::io_uring_params p;
+    std::memset( & p, 0, sizeof( p) );
+    ring_fd_ = io_uring_setup( entries, & p);
+    if ( -1 == ring_fd_) {
+        // not supported by the kernel or forbidden - use the fallback
+        instance_ = this;
+        return;
+    }
+    // IORING_FEAT_RW_CUR_POS implies IORING_OP_READ/WRITE/ACCEPT,
+    // IORING_FEAT_NODROP that completions never get lost
+    if ( 0 == ( p.features & IORING_FEAT_RW_CUR_POS) ||
+         0 == ( p.features & IORING_FEAT_NODROP) ) {
+        ::close( ring_fd_);
+        ring_fd_ = -1;
+        instance_ = this;
+        return;
+    }
+    sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof( unsigned int);
+    cq_ring_size_ = p.cq_off.cqes + p.cq_entries * sizeof( ::io_uring_cqe);
+    bool single_mmap = 0 != ( p.features & IORING_FEAT_SINGLE_MMAP);
+    if ( single_mmap && cq_ring_size_ > sq_ring_size_) {
+        sq_ring_size_ = cq_ring_size_;
+    }
+    void * sq = ::mmap( nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    void * cq = MAP_FAILED;
+    void * sqes = MAP_FAILED;
+    if ( MAP_FAILED != sq) {
+        sq_ring_ = sq;
+        cq = single_mmap
+            ? sq
+            : ::mmap( nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    }
+    if ( MAP_FAILED != cq) {
+        cq_ring_ = cq;
+        sqes_size_ = p.sq_entries * sizeof( ::io_uring_sqe);
+        sqes = ::mmap( nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    }
+    if ( MAP_FAILED == sqes) {
+        unmap_();
+        ::close( ring_fd_);
+        ring_fd_ = -1;
+        instance_ = this;
+        return;
+    }
+    sqes_ = static_cast< ::io_uring_sqe * >( sqes);
+    char * sq_ptr = static_cast< char * >( sq_ring_);
+    sq_head_ = reinterpret_cast< unsigned int * >( sq_ptr + p.sq_off.head);
+    sq_tail_ = reinterpret_cast< unsigned int * >( sq_ptr + p.sq_off.tail);
+    sq_flags_ = reinterpret_cast< unsigned int * >( sq_ptr + p.sq_off.flags);
+    sq_array_ = reinterpret_cast< unsigned int * >( sq_ptr + p.sq_off.array);
+    sq_mask_ = * reinterpret_cast< unsigned int * >( sq_ptr + p.sq_off.ring_mask);
+    sq_entries_ = * reinterpret_cast< unsigned int * >( sq_ptr + p.sq_off.ring_entries);
+    char * cq_ptr = static_cast< char * >( cq_ring_);
+    cq_head_ = reinterpret_cast< unsigned int * >( cq_ptr + p.cq_off.head);
+    cq_tail_ = reinterpret_cast< unsigned int * >( cq_ptr + p.cq_off.tail);
+    cq_mask_ = * reinterpret_cast< unsigned int * >( cq_ptr + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast< ::io_uring_cqe * >( cq_ptr + p.cq_off.cqes);
+    try {
+        // the ring descriptor becomes readable if completions are available
+        watch_( ring_fd_);
+    } catch (...) {
+        unmap_();
+        ::close( ring_fd_);
+        throw;
+    }
+    instance_ = this;
+}
+
+io_uring::~io_uring() {
+    BOOST_ASSERT( 0 == inflight_);
+    if ( this == instance_) {
+        instance_ = nullptr;
+    }
+    if ( has_ring() ) {
+        unmap_();
+        ::close( ring_fd_);
+    }
+}
+
+io_uring *
+io_uring::instance() noexcept {
+    return instance_;
+}
+
+void
+io_uring::unmap_() noexcept {
+    if ( nullptr != sqes_) {
+        ::munmap( sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+    if ( nullptr != cq_ring_ && cq_ring_ != sq_ring_) {
+        ::munmap( cq_ring_, cq_ring_size_);
+    }
+    cq_ring_ = nullptr;
+    if ( nullptr != sq_ring_) {
+        ::munmap( sq_ring_, sq_ring_size_);
+        sq_ring_ = nullptr;
+    }
+}
+
+::io_uring_sqe *
+io_uring::get_sqe_() noexcept {
+    for (;;) {
+        unsigned int tail = * sq_tail_;
+        if ( tail - __atomic_load_n( sq_head_, __ATOMIC_ACQUIRE) < sq_entries_) {
+            ::io_uring_sqe * sqe = & sqes_[tail & sq_mask_];
+            std::memset( sqe, 0, sizeof( ::io_uring_sqe) );
+            return sqe;
+        }
+        // submission queue full - hand the batch to the kernel
+        submit_();
+        if ( * sq_tail_ - __atomic_load_n( sq_head_, __ATOMIC_ACQUIRE) == sq_entries_) {
+            // the kernel refuses new submissions until completions are reaped
+            reap_();
+            context::active()->yield();
+        }
+    }
+}
+
+void
+io_uring::submit_() noexcept {
+    while ( 0 < pending_) {
+        int n = io_uring_enter( ring_fd_, pending_, 0, 0);
+        if ( 0 > n) {
+            if ( EINTR == errno) {
+                continue;
+            }
+            // EAGAIN/EBUSY: retried on the next dispatch round
+            return;
+        }
+        BOOST_ASSERT( static_cast< unsigned int >( n) <= pending_);
+        pending_ -= n;
+        if ( 0 == n) {
+            return;
+        }
+    }
+}
+
+bool
+io_uring::reap_() noexcept {
+    bool readied = false;
+    context * active_ctx = context::active();
+    for (;;) {
+        unsigned int head = * cq_head_;
+        unsigned int tail = __atomic_load_n( cq_tail_, __ATOMIC_ACQUIRE);
+        for ( ; head != tail; ++head) {
+            ::io_uring_cqe * cqe = & cqes_[head & cq_mask_];
+            operation * op = reinterpret_cast< operation * >( static_cast< std::uintptr_t >( cqe->user_data) );
+            op->res = cqe->res;
+            --inflight_;
+            active_ctx->set_ready( op->ctx);
+            readied = true;
+        }
+        __atomic_store_n( cq_head_, head, __ATOMIC_RELEASE);
+#if defined(IORING_SQ_CQ_OVERFLOW)
+        // completions did not fit into the CQ ring; let the kernel flush them
+        if ( 0 != ( __atomic_load_n( sq_flags_, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) ) {
+            io_uring_enter( ring_fd_, 0, 0, IORING_ENTER_GETEVENTS);
+            continue;
+        }
+#endif
+        return readied;
+    }
+}
+
+int
+io_uring::execute_( ::io_uring_sqe * sqe) noexcept {
+    operation op{ context::active(), 0 };
+    sqe->user_data = reinterpret_cast< std::uintptr_t >( & op);
+    unsigned int tail = * sq_tail_;
+    sq_array_[tail & sq_mask_] = tail & sq_mask_;
+    __atomic_store_n( sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++pending_;
+    ++inflight_;
+    // submitted once per dispatch round by pick_next()/suspend_until(),
+    // resumed by reap_()
+    op.ctx->suspend();
+    return op.res;
+}
+
+context *
+io_uring::pick_next() noexcept {
+    context * victim = epoll::pick_next();
+    if ( has_ring() ) {
+        if ( nullptr == victim || victim->is_context( type::dispatcher_context) ) {
+            // the dispatcher closes a round over the ready fibers; everything
+            // they submitted meanwhile is passed to the kernel in one batch
+            submit_();
+        }
+        // completions are reaped by the dispatcher only - the fiber calling
+        // pick_next() might be the one whose operation just completed
+        if ( 0 < inflight_ &&
+             context::active()->is_context( type::dispatcher_context) &&
+             reap_() &&
+             nullptr == victim) {
+            victim = epoll::pick_next();
+        }
+    }
+    return victim;
+}
+
+void
+io_uring::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    if ( has_ring() ) {
+        submit_();
+        if ( 0 < inflight_ && reap_() ) {
+            return;
+        }
+    }
+    // blocks until a completion arrives (ring_fd_ is watched), an fd becomes
+    // ready, the deadline is reached or notify() is called
+    epoll::suspend_until( time_point);
+    if ( has_ring() && 0 < inflight_) {
+        reap_();
+    }
+}
+
+::ssize_t
+io_uring::read( int fd, void * buf, std::size_t len, std::int64_t offset) {
+    if ( ! has_ring() ) {
+        return fallback_read( fd, buf, len, offset);
+    }
+    ::io_uring_sqe * sqe = get_sqe_();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast< std::uintptr_t >( buf);
+    sqe->len = UINT_MAX < len ? UINT_MAX : static_cast< unsigned int >( len);
+    sqe->off = static_cast< std::uint64_t >( offset);
+    return execute_( sqe);
+}
+
+::ssize_t
+io_uring::write( int fd, void const* buf, std::size_t len, std::int64_t offset) {
+    if ( ! has_ring() ) {
+        return fallback_write( fd, buf, len, offset);
+    }
+    ::io_uring_sqe * sqe = get_sqe_();
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast< std::uintptr_t >( buf);
+    sqe->len = UINT_MAX < len ? UINT_MAX : static_cast< unsigned int >( len);
+    sqe->off = static_cast< std::uint64_t >( offset);
+    return execute_( sqe);
+}
+
+int
+io_uring::fsync( int fd, bool datasync) {
+    if ( ! has_ring() ) {
+        return fallback_fsync( fd, datasync);
+    }
+    ::io_uring_sqe * sqe = get_sqe_();
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->fd = fd;
+    sqe->fsync_flags = datasync ? IORING_FSYNC_DATASYNC : 0;
+    return execute_( sqe);
+}
+
+int
+io_uring::accept( int fd, ::sockaddr * addr, ::socklen_t * addrlen, int flags) {
+    if ( ! has_ring() ) {
+        return fallback_accept( fd, addr, addrlen, flags);
+    }
+    ::io_uring_sqe * sqe = get_sqe_();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast< std::uintptr_t >( addr);
+    sqe->addr2 = reinterpret_cast< std::uintptr_t >( addrlen);
+    sqe->accept_flags = static_cast< std::uint32_t >( flags);
+    return execute_( sqe);
+}
+
+}
+
+namespace io {
+
+::ssize_t read( int fd, void * buf, std::size_t len) {
+    algo::io_uring * algo = algo::io_uring::instance();
+    return result( nullptr != algo
+            ? algo->read( fd, buf, len, -1)
+            : fallback_read( fd, buf, len, -1) );
+}
+
+::ssize_t pread( int fd, void * buf, std::size_t len, ::off_t offset) {
+    algo::io_uring * algo = algo::io_uring::instance();
+    return result( nullptr != algo
+            ? algo->read( fd, buf, len, offset)
+            : fallback_read( fd, buf, len, offset) );
+}
+
+::ssize_t write( int fd, void const* buf, std::size_t len) {
+    algo::io_uring * algo = algo::io_uring::instance();
+    return result( nullptr != algo
+            ? algo->write( fd, buf, len, -1)
+            : fallback_write( fd, buf, len, -1) );
+}
+
+::ssize_t pwrite( int fd, void const* buf, std::size_t len, ::off_t offset) {
+    algo::io_uring * algo = algo::io_uring::instance();
+    return result( nullptr != algo
+            ? algo->write( fd, buf, len, offset)
+            : fallback_write( fd, buf, len, offset) );
+}
+
+int fsync( int fd) {
+    algo::io_uring * algo = algo::io_uring::instance();
+    return result( nullptr != algo
+            ? algo->fsync( fd, false)
+            : fallback_fsync( fd, false) );
+}
+
+int fdatasync( int fd) {
+    algo::io_uring * algo = algo::io_uring::instance();
+    return result( nullptr != algo
+            ? algo->fsync( fd, true)
+            : fallback_fsync( fd, true) );
+}
+
+int accept( int fd, ::sockaddr * addr, ::socklen_t * addrlen, int flags) {
+    algo::io_uring * algo = algo::io_uring::instance();
+    return result( nullptr != algo
+            ? algo->accept( fd, addr, addrlen, flags)
+            : fallback_accept( fd, addr, addrlen, flags) );
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_OS_LINUX
@@ -26,13 +26,8 @@ round_robin::awakened( context * ctx) noexcept {
 
 context *
 round_robin::pick_next() noexcept {
-    context * victim{ nullptr };
-    if ( ! rqueue_.empty() ) {
-        victim = & rqueue_.front();
-        rqueue_.pop_front();
-        BOOST_ASSERT( nullptr != victim);
-        BOOST_ASSERT( ! victim->ready_is_linked() );
-    }
+    context * victim = rqueue_.pop();
+    BOOST_ASSERT( nullptr == victim || ! victim->ready_is_linked() );
     return victim;
 }
 
@@ -43,23 +38,12 @@ round_robin::has_ready_fibers() const noexcept {
 
 void
 round_robin::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
-    if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
-        std::unique_lock< std::mutex > lk( mtx_);
-        cnd_.wait( lk, [&](){ return flag_; });
-        flag_ = false;
-    } else {
-        std::unique_lock< std::mutex > lk( mtx_);
-        cnd_.wait_until( lk, time_point, [&](){ return flag_; });
-        flag_ = false;
-    }
+    parker_.park_until( time_point);
 }
 
 void
 round_robin::notify() noexcept {
-    std::unique_lock< std::mutex > lk( mtx_);
-    flag_ = true;
-    lk.unlock();
-    cnd_.notify_all();
+    parker_.unpark();
 }
 
 }}}
@@ -0,0 +1,123 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/atomic_wait.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/assert.hpp>
+#include <boost/intrusive/list.hpp>
+
+#include "boost/fiber/context.hpp"
+#include "boost/fiber/detail/spinlock.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+static_assert( 0 == ( BOOST_FIBERS_ATOMIC_WAIT_BUCKETS & ( BOOST_FIBERS_ATOMIC_WAIT_BUCKETS - 1) ),
+               "BOOST_FIBERS_ATOMIC_WAIT_BUCKETS must be a power of two");
+
+// a fiber parked on an address; lives on the stack of the waiting fiber
+struct atomic_waiter {
+    typedef intrusive::list_member_hook<
+        intrusive::tag< atomic_waiter >,
+        intrusive::link_mode< intrusive::safe_link >
+    >                           hook_type;
+
+    hook_type                   hook{};
+    context                 *   ctx;
+    void const              *   addr;
+
+    atomic_waiter( context * ctx_, void const* addr_) noexcept :
+        ctx{ ctx_ },
+        addr{ addr_ } {
+    }
+};
+
+// addresses hashing to the same bucket share its wait-queue
+struct alignas(cache_alignment) atomic_wait_bucket {
+    typedef intrusive::list<
+        atomic_waiter,
+        intrusive::member_hook<
+            atomic_waiter, atomic_waiter::hook_type, & atomic_waiter::hook >,
+        intrusive::constant_time_size< false >
+    >                           queue_type;
+
+    // number of fibers in the wait-queue (or about to enter it); lets
+    // notify return without touching the spinlock if nobody waits
+    std::atomic< std::size_t >  waiters{ 0 };
+    spinlock                    splk{};
+    queue_type                  queue{};
+};
+
+atomic_wait_bucket buckets[BOOST_FIBERS_ATOMIC_WAIT_BUCKETS];
+
+atomic_wait_bucket & bucket_for( void const* addr) noexcept {
+    // fibonacci hashing - spreads neighbouring addresses
+    const std::uint64_t h = static_cast< std::uint64_t >( reinterpret_cast< std::uintptr_t >( addr) )
+        * 0x9e3779b97f4a7c15ull;
+    return buckets[( h >> 32) & ( BOOST_FIBERS_ATOMIC_WAIT_BUCKETS - 1)];
+}
+
+}
+
+void atomic_wait( void const* addr, atomic_wait_check const& chk) noexcept {
+    atomic_wait_bucket & b = bucket_for( addr);
+    context * active_ctx = context::active();
+    atomic_waiter w{ active_ctx, addr };
+    spinlock_lock lk{ b.splk };
+    // announce the waiter before the value is checked again: either the
+    // notifier sees the count or the check sees the new value
+    b.waiters.fetch_add( 1, std::memory_order_seq_cst);
+    if ( chk.changed() ) {
+        b.waiters.fetch_sub( 1, std::memory_order_relaxed);
+        return;
+    }
+    b.queue.push_back( w);
+    // unlocked by the dispatcher after the switch; the notifier unlinks w
+    active_ctx->suspend( lk);
+    BOOST_ASSERT( ! w.hook.is_linked() );
+}
+
+void atomic_notify( void const* addr, bool all) noexcept {
+    atomic_wait_bucket & b = bucket_for( addr);
+    if ( 0 == b.waiters.load( std::memory_order_seq_cst) ) {
+        return;
+    }
+    context::wait_queue_t woken;
+    spinlock_lock lk{ b.splk };
+    atomic_wait_bucket::queue_type::iterator e = b.queue.end();
+    for ( atomic_wait_bucket::queue_type::iterator i = b.queue.begin(); i != e;) {
+        if ( addr != i->addr) {
+            ++i;
+            continue;
+        }
+        context * ctx = i->ctx;
+        // the waiter might resume as soon as it is readied - the node is
+        // not touched afterwards
+        i = b.queue.erase( i);
+        b.waiters.fetch_sub( 1, std::memory_order_relaxed);
+        ctx->wait_link( woken);
+        if ( ! all) {
+            break;
+        }
+    }
+    context::active()->set_ready_all( woken);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -1,4 +1,3 @@
-
 //          Copyright Oliver Kowalke 2013.
 // Distributed under the Boost Software License, Version 1.0.
 //    (See accompanying file LICENSE_1_0.txt or copy at
@@ -6,9 +5,12 @@
 
 #include "boost/fiber/barrier.hpp"
 
-#include <mutex>
 #include <system_error>
+#include <utility>
+
+#include <boost/assert.hpp>
 
+#include "boost/fiber/detail/cpu_relax.hpp"
 #include "boost/fiber/exceptions.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -18,29 +20,124 @@
 namespace boost {
 namespace fibers {
 
+constexpr std::uint64_t barrier::count_mask;
+constexpr std::uint64_t barrier::releasing_bit;
+constexpr unsigned int barrier::phase_shift;
+
 barrier::barrier( std::size_t initial) :
-	initial_{ initial },
-	current_{ initial_ } {
+    barrier{ initial, std::function< void() >{} } {
+}
+
+barrier::barrier( std::size_t initial, std::function< void() > completion) :
+    state_{ initial },
+    expected_{ initial },
+    completion_{ std::move( completion) } {
     if ( 0 == initial) {
         throw fiber_error( std::make_error_code( std::errc::invalid_argument),
                            "boost fiber: zero initial barrier count");
     }
+    if ( max() < initial) {
+        throw fiber_error( std::make_error_code( std::errc::invalid_argument),
+                           "boost fiber: barrier count exceeds max()");
+    }
+}
+
+bool
+barrier::arrive_( std::size_t n, std::uint32_t & phase) noexcept {
+    BOOST_ASSERT( 0 < n);
+    const std::uint64_t value = state_.fetch_sub( n, std::memory_order_acq_rel);
+    BOOST_ASSERT( n <= ( value & count_mask) );
+    phase = static_cast< std::uint32_t >( value >> phase_shift);
+    if ( n != ( value & count_mask) ) {
+        return false;
+    }
+    // a fiber of this phase might still be the completer of the previous
+    // phase, releasing its waiters
+    wait_released_();
+    // all fibers of this phase arrived - no concurrent modification of
+    // state_ until the next phase is published
+    if ( completion_) {
+        completion_();
+    }
+    const std::uint64_t next = static_cast< std::uint64_t >( static_cast< std::uint32_t >( phase + 1) );
+    wait_queue_type waiters;
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    // waiters check the phase with the spinlock held - only fibers of this
+    // phase are linked; fibers arriving for the next phase are linked after
+    // the swap
+    waiters.swap( wait_queue_);
+    state_.store( ( next << phase_shift) | releasing_bit | expected_.load( std::memory_order_relaxed),
+                  std::memory_order_release);
+    lk.unlock();
+    // last access to the barrier - from here on fibers may return from
+    // wait() and destroy it
+    state_.fetch_and( ~releasing_bit, std::memory_order_release);
+    context::active()->set_ready_all( waiters);
+    return true;
+}
+
+void
+barrier::wait_released_() const noexcept {
+    while ( 0 != ( state_.load( std::memory_order_acquire) & releasing_bit) ) {
+        cpu_relax();
+    }
+}
+
+void
+barrier::wait_( std::uint32_t phase) noexcept {
+    if ( phase != static_cast< std::uint32_t >( state_.load( std::memory_order_acquire) >> phase_shift) ) {
+        // the phase was completed - the completer might not be done with
+        // the barrier yet
+        wait_released_();
+        return;
+    }
+    context * active_ctx = context::active();
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    if ( phase != static_cast< std::uint32_t >( state_.load( std::memory_order_acquire) >> phase_shift) ) {
+        lk.unlock();
+        wait_released_();
+        return;
+    }
+    BOOST_ASSERT( ! active_ctx->wait_is_linked() );
+    active_ctx->wait_link( wait_queue_);
+    // suspend this fiber
+    active_ctx->suspend( lk);
+    BOOST_ASSERT( ! active_ctx->wait_is_linked() );
 }
 
 bool
 barrier::wait() {
-	std::unique_lock< mutex > lk( mtx_);
-	const bool cycle = cycle_;
-	if ( 0 == --current_) {
-		cycle_ = ! cycle_;
-		current_ = initial_;
-        lk.unlock(); // no pessimization
-		cond_.notify_all();
-		return true;
-	} else {
-        cond_.wait( lk, [&](){ return cycle != cycle_; });
-	}
-	return false;
+    std::uint32_t phase;
+    if ( arrive_( 1, phase) ) {
+        return true;
+    }
+    wait_( phase);
+    return false;
+}
+
+barrier::arrival_token
+barrier::arrive( std::size_t n) noexcept {
+    std::uint32_t phase;
+    arrive_( n, phase);
+    return arrival_token{ phase };
+}
+
+void
+barrier::wait( arrival_token && token) noexcept {
+    wait_( token.phase_);
+}
+
+void
+barrier::arrive_and_wait() noexcept {
+    wait();
+}
+
+void
+barrier::arrive_and_drop() noexcept {
+    // takes effect before this arrival can complete the phase
+    expected_.fetch_sub( 1, std::memory_order_relaxed);
+    std::uint32_t phase;
+    arrive_( 1, phase);
 }
 
 }}
@@ -6,6 +6,8 @@
 
 #include "boost/fiber/condition_variable.hpp"
 
+#include <exception>
+
 #include "boost/fiber/context.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -15,6 +17,26 @@
 namespace boost {
 namespace fibers {
 
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+condition_variable_any::condition_variable_any() :
+    profile_{ detail::profile_register( this, "condition_variable_any", BOOST_FIBERS_RETURN_ADDRESS() ) } {
+}
+
+condition_variable_any::~condition_variable_any() {
+    BOOST_ASSERT( wait_queue_.empty() );
+    detail::profile_unregister( profile_);
+}
+
+condition_variable::condition_variable() :
+    profile_{ detail::profile_register( this, "condition_variable", BOOST_FIBERS_RETURN_ADDRESS() ) } {
+}
+
+condition_variable::~condition_variable() {
+    BOOST_ASSERT( wait_queue_.empty() );
+    detail::profile_unregister( profile_);
+}
+#endif
+
 void
 condition_variable_any::notify_one() noexcept {
     // get one context' from wait-queue
@@ -40,6 +62,115 @@ condition_variable_any::notify_all() noexcept {
     }
 }
 
+
+void
+condition_variable::wait_( mutex & mtx) {
+    context * ctx = context::active();
+    BOOST_FIBERS_PROFILE( const std::int64_t start = detail::profile_now(); )
+    // atomically release mtx and block on *this
+    // store this fiber in waiting-queue
+    detail::spinlock_lock lk( wait_queue_splk_);
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    BOOST_ASSERT( wait_queue_.empty() || & mtx == mtx_);
+    mtx_ = & mtx;
+    ctx->wait_link( wait_queue_);
+    mtx.unlock();
+    // suspend this fiber; notify_*() removed it from the waiting-queue
+    ctx->suspend( lk);
+    BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
+    // the lock might already have been handed over
+    try {
+        mtx.relock_( ctx);
+    } catch (...) {
+        std::terminate();
+    }
+    // post-conditions
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+}
+
+cv_status
+condition_variable::wait_until_( mutex & mtx, std::chrono::steady_clock::time_point const& timeout_time) {
+    cv_status status = cv_status::no_timeout;
+    context * ctx = context::active();
+    BOOST_FIBERS_PROFILE( const std::int64_t start = detail::profile_now(); )
+    // atomically release mtx and block on *this
+    // store this fiber in waiting-queue
+    detail::spinlock_lock lk( wait_queue_splk_);
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    BOOST_ASSERT( wait_queue_.empty() || & mtx == mtx_);
+    mtx_ = & mtx;
+    ctx->wait_link( wait_queue_);
+    mtx.unlock();
+    // suspend this fiber
+    if ( ! ctx->wait_until( timeout_time, lk) ) {
+        lk.lock();
+        // ctx might have been moved to the wait-queue of mtx meanwhile
+        wait_queue_t::iterator e = wait_queue_.end();
+        for ( wait_queue_t::iterator i = wait_queue_.begin(); i != e; ++i) {
+            if ( ctx == & ( * i) ) {
+                // remove from waiting-queue
+                wait_queue_.erase( i);
+                status = cv_status::timeout;
+                break;
+            }
+        }
+        lk.unlock();
+    }
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    if ( cv_status::timeout == status) {
+        detail::profile_waited( profile_, start);
+    } else {
+        detail::profile_acquired( profile_, start);
+    }
+#endif
+    // the lock might already have been handed over
+    try {
+        mtx.relock_( ctx);
+    } catch (...) {
+        std::terminate();
+    }
+    // post-conditions
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    return status;
+}
+
+void
+condition_variable::notify_one() noexcept {
+    // get one context' from wait-queue
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( wait_queue_.empty() ) {
+        return;
+    }
+    wait_queue_t waiters;
+    context * ctx = & wait_queue_.front();
+    wait_queue_.pop_front();
+    waiters.push_back( * ctx);
+    // move the context to the wait-queue of the mutex if the mutex is
+    // locked (usually by the notifying fiber); it is resumed as owner
+    if ( ! mtx_->requeue_( waiters) ) {
+        waiters.pop_front();
+        context::active()->set_ready( ctx);
+    }
+}
+
+void
+condition_variable::notify_all() noexcept {
+    // get all context' from wait-queue
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( wait_queue_.empty() ) {
+        return;
+    }
+    wait_queue_t waiters;
+    waiters.swap( wait_queue_);
+    // move all context' to the wait-queue of the mutex if the mutex is
+    // locked (usually by the notifying fiber): instead of waking all to
+    // let them block on the mutex again, they get the lock handed over
+    // by mutex::unlock() one after another
+    if ( ! mtx_->requeue_( waiters) ) {
+        context::active()->set_ready_all( waiters);
+    }
+}
+
 }}
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -10,6 +10,7 @@
 #include <mutex>
 #include <new>
 
+#include "boost/fiber/detail/context_ring_queue.hpp"
 #include "boost/fiber/exceptions.hpp"
 #include "boost/fiber/scheduler.hpp"
 
@@ -262,7 +263,7 @@ context::resume() noexcept {
 }
 
 void
-context::resume( detail::spinlock_lock & lk) noexcept {
+context::resume( detail::lock_ref const& lk) noexcept {
     context * prev = this;
     // context_initializer::active_ will point to `this`
     // prev will point to previous active context
@@ -295,7 +296,7 @@ context::suspend() noexcept {
 }
 
 void
-context::suspend( detail::spinlock_lock & lk) noexcept {
+context::suspend( detail::lock_ref const& lk) noexcept {
     get_scheduler()->suspend( lk);
 }
 
@@ -397,7 +398,7 @@ context::wait_until( std::chrono::steady_clock::time_point const& tp) noexcept {
 
 bool
 context::wait_until( std::chrono::steady_clock::time_point const& tp,
-                     detail::spinlock_lock & lk) noexcept {
+                     detail::lock_ref const& lk) noexcept {
     BOOST_ASSERT( nullptr != get_scheduler() );
     BOOST_ASSERT( this == context_initializer::active_);
     return get_scheduler()->wait_until( this, tp, lk);
@@ -426,6 +427,59 @@ context::set_ready( context * ctx) noexcept {
 #endif
 }
 
+void
+context::set_ready_all( wait_queue_t & queue) noexcept {
+    while ( ! queue.empty() ) {
+        context * ctx = & queue.front();
+        queue.pop_front();
+        BOOST_ASSERT( this != ctx);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+        if ( scheduler_ == ctx->get_scheduler() ) {
+            get_scheduler()->set_ready( ctx);
+            continue;
+        }
+        set_remote_ready_( ctx, queue);
+#else
+        get_scheduler()->set_ready( ctx);
+#endif
+    }
+}
+
+void
+context::set_remote_ready_all( wait_queue_t & queue) noexcept {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    while ( ! queue.empty() ) {
+        context * ctx = & queue.front();
+        queue.pop_front();
+        set_remote_ready_( ctx, queue);
+    }
+#else
+    // all contexts belong to the scheduler of this thread
+    context::active()->set_ready_all( queue);
+#endif
+}
+
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+void
+context::set_remote_ready_( context * ctx, wait_queue_t & queue) noexcept {
+    scheduler * sched = ctx->get_scheduler();
+    // collect the other contexts of this scheduler
+    context * last = ctx;
+    wait_queue_t::iterator e = queue.end();
+    for ( wait_queue_t::iterator i = queue.begin(); i != e;) {
+        if ( sched == i->get_scheduler() ) {
+            context * nxt = & ( * i);
+            i = queue.erase( i);
+            last->remote_nxt_.store( nxt, std::memory_order_relaxed);
+            last = nxt;
+        } else {
+            ++i;
+        }
+    }
+    sched->set_remote_ready( ctx, last);
+}
+#endif
+
 void *
 context::get_fss_data( void const * vp) const {
     uintptr_t key( reinterpret_cast< uintptr_t >( vp) );
@@ -480,7 +534,7 @@ context::terminated_is_linked() const noexcept {
 
 bool
 context::ready_is_linked() const noexcept {
-    return ready_hook_.is_linked();
+    return ready_hook_.is_linked() || nullptr != ready_ring_;
 }
 
 bool
@@ -498,9 +552,18 @@ context::worker_unlink() noexcept {
     worker_hook_.unlink();
 }
 
+void
+context::ready_link( detail::context_ring_queue & ring) noexcept {
+    ring.push( this);
+}
+
 void
 context::ready_unlink() noexcept {
-    ready_hook_.unlink();
+    if ( nullptr != ready_ring_) {
+        ready_ring_->erase( this);
+    } else {
+        ready_hook_.unlink();
+    }
 }
 
 void
@@ -0,0 +1,138 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/counting_semaphore.hpp"
+
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+constexpr std::size_t counting_semaphore::waiters_bit;
+constexpr std::size_t counting_semaphore::permit_one;
+
+bool
+counting_semaphore::acquire_or_wait_() noexcept {
+    std::size_t value = value_.load( std::memory_order_relaxed);
+    for (;;) {
+        if ( permit_one <= value) {
+            if ( value_.compare_exchange_weak(
+                        value, value - permit_one,
+                        std::memory_order_acquire, std::memory_order_relaxed) ) {
+                return true;
+            }
+        } else if ( 0 != ( value & waiters_bit) ||
+                    value_.compare_exchange_weak(
+                        value, waiters_bit,
+                        std::memory_order_relaxed, std::memory_order_relaxed) ) {
+            return false;
+        }
+    }
+}
+
+bool
+counting_semaphore::try_acquire_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept {
+    if ( std::chrono::steady_clock::now() > timeout_time) {
+        return false;
+    }
+    // fast path: permits available
+    if ( try_acquire() ) {
+        return true;
+    }
+    context * ctx = context::active();
+    // store this fiber in order to be notified later
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( acquire_or_wait_() ) {
+        // released in the meantime
+        return true;
+    }
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    ctx->wait_link( wait_queue_);
+    // suspend this fiber until notified or timed-out
+    if ( ! ctx->wait_until( timeout_time, lk) ) {
+        lk.lock();
+        if ( ctx->wait_is_linked() ) {
+            // remove fiber from wait-queue
+            ctx->wait_unlink();
+            if ( wait_queue_.empty() ) {
+                value_.fetch_and( ~waiters_bit, std::memory_order_relaxed);
+            }
+            return false;
+        }
+        // a permit was handed over while timing out
+    }
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    return true;
+}
+
+void
+counting_semaphore::acquire() {
+    // fast path: permits available
+    if ( try_acquire() ) {
+        return;
+    }
+    context * ctx = context::active();
+    // store this fiber in order to be notified later
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( acquire_or_wait_() ) {
+        // released in the meantime
+        return;
+    }
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    ctx->wait_link( wait_queue_);
+    // suspend this fiber; the permit is handed over on wakeup
+    ctx->suspend( lk);
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+}
+
+bool
+counting_semaphore::try_acquire() noexcept {
+    std::size_t value = value_.load( std::memory_order_relaxed);
+    while ( permit_one <= value) {
+        if ( value_.compare_exchange_weak(
+                    value, value - permit_one,
+                    std::memory_order_acquire, std::memory_order_relaxed) ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+counting_semaphore::release( std::size_t n) noexcept {
+    // fast path: no waiters
+    std::size_t value = value_.load( std::memory_order_relaxed);
+    while ( 0 == ( value & waiters_bit) ) {
+        if ( value_.compare_exchange_weak(
+                    value, value + n * permit_one,
+                    std::memory_order_release, std::memory_order_relaxed) ) {
+            return;
+        }
+    }
+    // no permits available while fibers are waiting; acquire() and
+    // release() are serialized by the spinlock till the bit is cleared
+    detail::spinlock_lock lk( wait_queue_splk_);
+    wait_queue_t woken;
+    for ( ; 0 < n && ! wait_queue_.empty(); --n) {
+        context * ctx = & wait_queue_.front();
+        wait_queue_.pop_front();
+        woken.push_back( * ctx);
+    }
+    value_.store( wait_queue_.empty() ? n * permit_one : waiters_bit,
+                  std::memory_order_release);
+    // still under the spinlock: a timed-out waiter has to see that it
+    // got a permit
+    context::active()->set_ready_all( woken);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
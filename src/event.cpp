@@ -0,0 +1,153 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/event.hpp"
+
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+constexpr std::size_t event::set_bit;
+constexpr std::size_t event::waiters_bit;
+
+bool
+event::consume_or_wait_() noexcept {
+    std::size_t value = value_.load( std::memory_order_relaxed);
+    for (;;) {
+        if ( 0 != ( value & set_bit) ) {
+            if ( manual_reset_ ||
+                 value_.compare_exchange_weak(
+                    value, value & ~set_bit,
+                    std::memory_order_acquire, std::memory_order_relaxed) ) {
+                return true;
+            }
+        } else if ( 0 != ( value & waiters_bit) ||
+                    value_.compare_exchange_weak(
+                        value, value | waiters_bit,
+                        std::memory_order_relaxed, std::memory_order_relaxed) ) {
+            return false;
+        }
+    }
+}
+
+bool
+event::wait_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept {
+    // fast path: event is set
+    if ( try_wait() ) {
+        return true;
+    }
+    if ( std::chrono::steady_clock::now() > timeout_time) {
+        return false;
+    }
+    context * ctx = context::active();
+    // store this fiber in order to be notified later
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( consume_or_wait_() ) {
+        // set in the meantime
+        return true;
+    }
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    ctx->wait_link( wait_queue_);
+    // suspend this fiber until notified or timed-out
+    if ( ! ctx->wait_until( timeout_time, lk) ) {
+        lk.lock();
+        if ( ctx->wait_is_linked() ) {
+            // remove fiber from wait-queue
+            ctx->wait_unlink();
+            if ( wait_queue_.empty() ) {
+                value_.fetch_and( ~waiters_bit, std::memory_order_relaxed);
+            }
+            return false;
+        }
+        // the event was set while timing out
+    }
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    return true;
+}
+
+void
+event::set() noexcept {
+    // fast path: no waiters
+    std::size_t value = value_.load( std::memory_order_relaxed);
+    while ( 0 == ( value & waiters_bit) ) {
+        if ( 0 != ( value & set_bit) ||
+             value_.compare_exchange_weak(
+                value, value | set_bit,
+                std::memory_order_release, std::memory_order_relaxed) ) {
+            return;
+        }
+    }
+    detail::spinlock_lock lk( wait_queue_splk_);
+    wait_queue_t woken;
+    if ( manual_reset_) {
+        // the event stays signaled, all waiters pass
+        woken.swap( wait_queue_);
+        value_.store( set_bit, std::memory_order_release);
+    } else if ( ! wait_queue_.empty() ) {
+        // consumed by the first waiter
+        context * ctx = & wait_queue_.front();
+        wait_queue_.pop_front();
+        woken.push_back( * ctx);
+        value_.store( wait_queue_.empty() ? 0 : waiters_bit, std::memory_order_release);
+    } else {
+        // the last waiter timed out meanwhile
+        value_.store( set_bit, std::memory_order_release);
+    }
+    // still under the spinlock: a timed-out waiter has to see that the
+    // event was passed to it
+    context::active()->set_ready_all( woken);
+}
+
+void
+event::reset() noexcept {
+    value_.fetch_and( ~set_bit, std::memory_order_relaxed);
+}
+
+void
+event::wait() {
+    // fast path: event is set
+    if ( try_wait() ) {
+        return;
+    }
+    context * ctx = context::active();
+    // store this fiber in order to be notified later
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( consume_or_wait_() ) {
+        // set in the meantime
+        return;
+    }
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    ctx->wait_link( wait_queue_);
+    // suspend this fiber
+    ctx->suspend( lk);
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+}
+
+bool
+event::try_wait() noexcept {
+    std::size_t value = value_.load( std::memory_order_acquire);
+    if ( manual_reset_) {
+        return 0 != ( value & set_bit);
+    }
+    while ( 0 != ( value & set_bit) ) {
+        if ( value_.compare_exchange_weak(
+                    value, value & ~set_bit,
+                    std::memory_order_acquire, std::memory_order_relaxed) ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,64 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/eventcount.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+constexpr std::uint64_t eventcount::waiter_one;
+constexpr std::uint64_t eventcount::epoch_one;
+constexpr std::uint64_t eventcount::waiters_mask;
+
+void
+eventcount::notify_( bool all) noexcept {
+    wait_queue_t waiters;
+    std::uint64_t n = 0;
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    if ( all) {
+        waiters.swap( wait_queue_);
+        n = waiters.size();
+    } else if ( ! wait_queue_.empty() ) {
+        context * ctx = & wait_queue_.front();
+        wait_queue_.pop_front();
+        waiters.push_back( * ctx);
+        n = 1;
+    }
+    // a new epoch lets the fibers between prepare_wait() and commit_wait()
+    // return; the woken fibers are removed from the waiter count here, so
+    // that they do not touch the eventcount after being resumed
+    state_.fetch_add( epoch_one - n * waiter_one, std::memory_order_release);
+    lk.unlock();
+    // the notifier might be a thread without fiber scheduler
+    context::set_remote_ready_all( waiters);
+}
+
+void
+eventcount::commit_wait( key k) noexcept {
+    context * active_ctx = context::active();
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    if ( k.epoch_ != static_cast< std::uint32_t >( state_.load( std::memory_order_acquire) >> 32) ) {
+        // notified since prepare_wait()
+        lk.unlock();
+        state_.fetch_sub( waiter_one, std::memory_order_seq_cst);
+        return;
+    }
+    BOOST_ASSERT( ! active_ctx->wait_is_linked() );
+    active_ctx->wait_link( wait_queue_);
+    // suspend this fiber; notify_*() removed it from the wait-queue
+    // and from the waiter count
+    active_ctx->suspend( lk);
+    BOOST_ASSERT( ! active_ctx->wait_is_linked() );
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
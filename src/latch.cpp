@@ -0,0 +1,99 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/latch.hpp"
+
+#include <system_error>
+
+#include "boost/fiber/detail/cpu_relax.hpp"
+#include "boost/fiber/exceptions.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+constexpr std::ptrdiff_t latch::waiters_bit;
+constexpr std::ptrdiff_t latch::count_one;
+
+latch::latch( std::ptrdiff_t expected) :
+    value_{ expected * count_one } {
+    if ( 0 > expected || max() < expected) {
+        throw fiber_error( std::make_error_code( std::errc::invalid_argument),
+                           "boost fiber: latch count out of range");
+    }
+}
+
+void
+latch::release_() noexcept {
+    wait_queue_t waiters;
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    waiters.swap( wait_queue_);
+    lk.unlock();
+    // last access to the latch - from here on fibers may return from
+    // wait() and destroy it
+    value_.store( 0, std::memory_order_release);
+    // released in one batch per scheduler
+    context::active()->set_ready_all( waiters);
+}
+
+void
+latch::count_down( std::ptrdiff_t n) noexcept {
+    BOOST_ASSERT( 0 <= n);
+    if ( 0 == n) {
+        return;
+    }
+    const std::ptrdiff_t value = value_.fetch_sub( n * count_one, std::memory_order_acq_rel);
+    BOOST_ASSERT( n * count_one <= value);
+    if ( ( n * count_one | waiters_bit) == value) {
+        // counted down to zero and fibers are waiting
+        release_();
+    }
+}
+
+void
+latch::wait() noexcept {
+    context * active_ctx = context::active();
+    for (;;) {
+        std::ptrdiff_t value = value_.load( std::memory_order_acquire);
+        if ( 0 == value) {
+            return;
+        }
+        if ( waiters_bit != value) {
+            detail::spinlock_lock lk{ wait_queue_splk_ };
+            value = value_.load( std::memory_order_acquire);
+            while ( count_one <= value) {
+                if ( 0 != ( value & waiters_bit) ||
+                     value_.compare_exchange_weak(
+                        value, value | waiters_bit,
+                        std::memory_order_acquire, std::memory_order_acquire) ) {
+                    BOOST_ASSERT( ! active_ctx->wait_is_linked() );
+                    active_ctx->wait_link( wait_queue_);
+                    // suspend this fiber
+                    active_ctx->suspend( lk);
+                    BOOST_ASSERT( ! active_ctx->wait_is_linked() );
+                    return;
+                }
+            }
+        }
+        // counted down to zero, the waiting fibers are being released -
+        // the latch must not be left before release_() is done with it
+        cpu_relax();
+    }
+}
+
+void
+latch::arrive_and_wait( std::ptrdiff_t n) noexcept {
+    count_down( n);
+    wait();
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -7,6 +7,7 @@
 #include "boost/fiber/mutex.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <functional>
 #include <system_error>
 
@@ -20,60 +21,216 @@
 namespace boost {
 namespace fibers {
 
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+mutex::mutex() :
+    profile_{ detail::profile_register( this, "mutex", BOOST_FIBERS_RETURN_ADDRESS() ) } {
+}
+
+mutex::mutex( mutex_mode mode) :
+    barging_{ mutex_mode::barging == mode },
+    profile_{ detail::profile_register( this, "mutex", BOOST_FIBERS_RETURN_ADDRESS() ) } {
+}
+
+mutex::~mutex() {
+    BOOST_ASSERT( nullptr == state_.owner() );
+    BOOST_ASSERT( wait_queue_.empty() );
+    detail::profile_unregister( profile_);
+}
+#endif
+
+bool
+mutex::requeue_( wait_queue_t & waiters) noexcept {
+    BOOST_ASSERT( ! waiters.empty() );
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( ! state_.wait_if_owned() ) {
+        return false;
+    }
+    // let the algorithm of the owner know about the waiters
+    // (priority inheritance); the hook must run in the thread of the waiter
+    // in barging mode the lock might be released while a woken waiter is
+    // about to compete for it
+    context * owner = state_.owner();
+    scheduler * sched = context::active()->get_scheduler();
+    for ( context & waiter : waiters) {
+        if ( nullptr != owner && sched == waiter.get_scheduler() ) {
+            inheritance_.contended( owner, & waiter);
+        }
+    }
+    wait_queue_.splice( wait_queue_.end(), waiters);
+    return true;
+}
+
+void
+mutex::relock_( context * ctx) {
+    // fast path: handed over by unlock()
+    if ( ctx == state_.owner() ) {
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
+        return;
+    }
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( ctx->wait_is_linked() ) {
+        // moved to the wait-queue while timing out
+        BOOST_FIBERS_PROFILE( const std::int64_t start = detail::profile_now(); )
+        ctx->suspend( lk);
+        BOOST_ASSERT( ! ctx->wait_is_linked() );
+        if ( ctx != state_.owner() ) {
+            // barging mode: woken, not handed over
+            wait_( ctx, true);
+        }
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
+        return;
+    }
+    if ( ctx == state_.owner() ) {
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
+        return;
+    }
+    lk.unlock();
+    // readied without ownership
+    lock();
+}
+
+void
+mutex::wait_( context * ctx, bool woken) {
+    std::chrono::steady_clock::time_point start{};
+    if ( barging_) {
+        start = std::chrono::steady_clock::now();
+    }
+    for (;;) {
+        // store this fiber in order to be notified later
+        detail::spinlock_lock lk( wait_queue_splk_);
+        bool front = woken;
+        if ( woken &&
+             ! starving_.load( std::memory_order_relaxed) &&
+             std::chrono::steady_clock::now() - start >
+                std::chrono::microseconds( BOOST_FIBERS_MUTEX_STARVATION_THRESHOLD) ) {
+            // lost the race against barging fibers for too long
+            starving_.store( true, std::memory_order_relaxed);
+        }
+        // a woken fiber competes for the lock even if the mutex is starving,
+        // it would have got the lock handed over in FIFO mode
+        if ( state_.acquire_or_wait( ctx,
+                    barging_ && ( woken || ! starving_.load( std::memory_order_relaxed) ) ) ) {
+            // released in the meantime
+            inheritance_.acquired( ctx, wait_queue_);
+            return;
+        }
+        BOOST_ASSERT( ! ctx->wait_is_linked() );
+        // let the algorithm of the owner know about the waiter
+        // (priority inheritance)
+        inheritance_.contended( state_.owner(), ctx);
+        if ( front) {
+            // keep the place in the queue
+            wait_queue_.push_front( * ctx);
+        } else {
+            ctx->wait_link( wait_queue_);
+        }
+        // suspend this fiber
+        ctx->suspend( lk);
+        BOOST_ASSERT( ! ctx->wait_is_linked() );
+        if ( ctx == state_.owner() ) {
+            // handed over
+            if ( barging_ &&
+                 std::chrono::steady_clock::now() - start <=
+                    std::chrono::microseconds( BOOST_FIBERS_MUTEX_STARVATION_THRESHOLD) ) {
+                starving_.store( false, std::memory_order_relaxed);
+            }
+            return;
+        }
+        // barging mode: woken by unlock(), compete for the lock
+        BOOST_ASSERT( barging_);
+        woken = true;
+    }
+}
+
 void
 mutex::lock() {
     context * ctx = context::active();
-    // store this fiber in order to be notified later
-    detail::spinlock_lock lk( wait_queue_splk_);
-    if ( ctx == owner_) {
+    // fast path: lock-word is free
+    if ( state_.try_acquire( ctx) ) {
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
+        return;
+    }
+    if ( ctx == state_.owner() ) {
         throw lock_error(
                 std::make_error_code( std::errc::resource_deadlock_would_occur),
                 "boost fiber: a deadlock is detected");
-    } else if ( nullptr == owner_) {
-        owner_ = ctx;
+    }
+    BOOST_FIBERS_PROFILE( const std::int64_t start = detail::profile_now(); )
+    // barging mode: take a released lock even if fibers are waiting
+    if ( barging_ &&
+         ! starving_.load( std::memory_order_relaxed) &&
+         state_.try_barge( ctx) ) {
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
+        return;
+    }
+    // the owner might run in another thread and release the lock soon
+    if ( state_.spin( ctx) ) {
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
         return;
     }
-    BOOST_ASSERT( ! ctx->wait_is_linked() );
-    ctx->wait_link( wait_queue_);
-    // suspend this fiber
-    ctx->suspend( lk);
-    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    wait_( ctx, false);
+    BOOST_ASSERT( ctx == state_.owner() );
+    BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
 }
 
 bool
 mutex::try_lock() {
     context * ctx = context::active();
-    detail::spinlock_lock lk( wait_queue_splk_);
-    if ( ctx == owner_) {
+    if ( ctx == state_.owner() ) {
         throw lock_error(
                 std::make_error_code( std::errc::resource_deadlock_would_occur),
                 "boost fiber: a deadlock is detected");
-    } else if ( nullptr == owner_) {
-        owner_ = ctx;
     }
-    lk.unlock();
+    if ( ! state_.try_acquire( ctx) ) {
+        return false;
+    }
+    BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
+    return true;
+}
+
+bool
+mutex::try_lock_and_yield() {
+    bool locked = try_lock();
     // let other fiber release the lock
     context::active()->yield();
-    return ctx == owner_;
+    return locked;
 }
 
 void
 mutex::unlock() {
     context * ctx = context::active();
-    detail::spinlock_lock lk( wait_queue_splk_);
-    if ( ctx != owner_) {
+    // only the hold time of the owner is recorded - unlock() by any other
+    // fiber throws below
+    BOOST_FIBERS_PROFILE(
+        if ( ctx == state_.owner() ) {
+            detail::profile_released( profile_);
+        } )
+    // fast path: no waiters
+    if ( state_.try_release( ctx) ) {
+        return;
+    }
+    if ( ctx != state_.owner() ) {
         throw lock_error(
                 std::make_error_code( std::errc::operation_not_permitted),
                 "boost fiber: no  privilege to perform the operation");
     }
+    detail::spinlock_lock lk( wait_queue_splk_);
     if ( ! wait_queue_.empty() ) {
-        context * ctx = & wait_queue_.front();
+        context * waiter = & wait_queue_.front();
         wait_queue_.pop_front();
-        owner_ = ctx;
-        context::active()->set_ready( ctx);
+        inheritance_.released( ctx, waiter);
+        if ( barging_ && ! starving_.load( std::memory_order_relaxed) ) {
+            // release the lock, the woken fiber has to compete for it
+            state_.hand_over( nullptr, ! wait_queue_.empty() );
+            context::active()->set_ready( waiter);
+            return;
+        }
+        state_.hand_over( waiter, ! wait_queue_.empty() );
+        inheritance_.acquired( waiter, wait_queue_);
+        context::active()->set_ready( waiter);
     } else {
-        owner_ = nullptr;
-        return;
+        state_.hand_over( nullptr, false);
+        starving_.store( false, std::memory_order_relaxed);
     }
 }
 
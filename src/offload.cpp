@@ -0,0 +1,148 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/offload.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include <boost/assert.hpp>
+
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+// elastic pool of helper threads; threads are started on demand (up to
+// BOOST_FIBERS_OFFLOAD_MAX_THREADS) and exit after being idle for a while
+class offload_pool {
+private:
+    std::mutex                  mtx_{};
+    std::condition_variable     cnd_{};
+    // FIFO of pending tasks, linked via offload_task::nxt
+    offload_task            *   head_{ nullptr };
+    offload_task            *   tail_{ nullptr };
+    std::size_t                 pending_{ 0 };
+    std::size_t                 threads_{ 0 };
+    std::size_t                 idle_{ 0 };
+    bool                        shutdown_{ false };
+
+    static constexpr std::chrono::seconds idle_timeout{ 10 };
+
+    static void complete_( offload_task * task) noexcept {
+        context * ctx = task->ctx;
+        {
+            // wait till the calling fiber is suspended
+            spinlock_lock lk( task->splk);
+        }
+        // task lives on the stack of ctx - not touched from here on
+        // the scheduler coalesces the notifications of consecutive
+        // completions until its dispatcher drained the remote ready-queue
+        ctx->get_scheduler()->set_remote_ready( ctx);
+    }
+
+    void worker_() noexcept {
+        std::unique_lock< std::mutex > lk( mtx_);
+        for (;;) {
+            while ( nullptr == head_ && ! shutdown_) {
+                ++idle_;
+                bool timeout = std::cv_status::timeout == cnd_.wait_for( lk, idle_timeout);
+                --idle_;
+                if ( timeout && nullptr == head_) {
+                    break;
+                }
+            }
+            if ( nullptr == head_) {
+                break;
+            }
+            offload_task * task = head_;
+            head_ = task->nxt;
+            if ( nullptr == head_) {
+                tail_ = nullptr;
+            }
+            --pending_;
+            lk.unlock();
+            task->run();
+            complete_( task);
+            lk.lock();
+        }
+        --threads_;
+        cnd_.notify_all();
+    }
+
+public:
+    ~offload_pool() {
+        std::unique_lock< std::mutex > lk( mtx_);
+        shutdown_ = true;
+        cnd_.notify_all();
+        cnd_.wait( lk, [this](){ return 0 == threads_; });
+    }
+
+    void submit( offload_task * task) {
+        std::unique_lock< std::mutex > lk( mtx_);
+        if ( pending_ >= idle_ && threads_ < BOOST_FIBERS_OFFLOAD_MAX_THREADS) {
+            // all idle threads are already claimed by pending tasks
+            try {
+                std::thread t( [this](){ worker_(); });
+                t.detach();
+                ++threads_;
+            } catch ( std::system_error const&) {
+                // running threads will execute the task eventually
+                if ( 0 == threads_) {
+                    throw;
+                }
+            }
+        }
+        BOOST_ASSERT( 0 < threads_);
+        task->nxt = nullptr;
+        if ( nullptr == tail_) {
+            head_ = task;
+        } else {
+            tail_->nxt = task;
+        }
+        tail_ = task;
+        ++pending_;
+        lk.unlock();
+        cnd_.notify_one();
+    }
+};
+
+constexpr std::chrono::seconds offload_pool::idle_timeout;
+
+offload_pool & pool() {
+    static offload_pool instance;
+    return instance;
+}
+
+}
+
+void offload( offload_task * task) {
+    BOOST_ASSERT( nullptr != task);
+    context * active_ctx = context::active();
+    task->ctx = active_ctx;
+    // the helper thread must not signal the fiber before it is suspended
+    spinlock_lock lk( task->splk);
+    pool().submit( task);
+    // unlocked by the dispatcher after the switch
+    active_ctx->suspend( lk);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,101 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/once.hpp"
+
+#include "boost/fiber/detail/cpu_relax.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+bool
+once_flag::begin_() {
+    context * active_ctx = context::active();
+    for (;;) {
+        std::uint32_t state = state_.load( std::memory_order_acquire);
+        switch ( state) {
+        case done:
+            return false;
+        case idle:
+            if ( state_.compare_exchange_weak(
+                        state, running,
+                        std::memory_order_acquire, std::memory_order_relaxed) ) {
+                return true;
+            }
+            break;
+        case completing:
+            // the waiters are being released - the flag must not be left
+            // before complete_() is done with it
+            cpu_relax();
+            break;
+        default: {
+                // running in another fiber, wait for it
+                detail::spinlock_lock lk{ wait_queue_splk_ };
+                state = state_.load( std::memory_order_relaxed);
+                if ( contended == state ||
+                     ( running == state &&
+                       state_.compare_exchange_strong(
+                            state, contended, std::memory_order_relaxed) ) ) {
+                    BOOST_ASSERT( ! active_ctx->wait_is_linked() );
+                    active_ctx->wait_link( wait_queue_);
+                    // suspend this fiber
+                    active_ctx->suspend( lk);
+                    BOOST_ASSERT( ! active_ctx->wait_is_linked() );
+                }
+            }
+            // re-check: done, or the initializer threw
+            break;
+        }
+    }
+}
+
+void
+once_flag::complete_() noexcept {
+    std::uint32_t state = running;
+    if ( state_.compare_exchange_strong(
+                state, done,
+                std::memory_order_release, std::memory_order_relaxed) ) {
+        // no waiters
+        return;
+    }
+    BOOST_ASSERT( contended == state);
+    wait_queue_t waiters;
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    state_.store( completing, std::memory_order_relaxed);
+    waiters.swap( wait_queue_);
+    lk.unlock();
+    // last access to the flag - from here on it might be destroyed
+    state_.store( done, std::memory_order_release);
+    // released in one batch per scheduler
+    context::active()->set_ready_all( waiters);
+}
+
+void
+once_flag::abort_() noexcept {
+    std::uint32_t state = running;
+    if ( state_.compare_exchange_strong(
+                state, idle,
+                std::memory_order_release, std::memory_order_relaxed) ) {
+        return;
+    }
+    BOOST_ASSERT( contended == state);
+    wait_queue_t waiters;
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    waiters.swap( wait_queue_);
+    state_.store( idle, std::memory_order_release);
+    lk.unlock();
+    // the waiters compete for running the initializer
+    context::active()->set_ready_all( waiters);
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,222 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/profiler.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+#include "boost/fiber/detail/profile.hpp"
+
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+# include <map>
+# include <memory>
+# include <mutex>
+# include <unordered_map>
+# include <utility>
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+namespace detail {
+
+namespace {
+
+void add( profiler::entry & e, profile_record const& r) noexcept {
+    e.acquisitions += r.acquisitions.load( std::memory_order_relaxed);
+    e.contentions += r.contentions.load( std::memory_order_relaxed);
+    e.wait_total += std::chrono::nanoseconds( r.wait_total.load( std::memory_order_relaxed) );
+    e.wait_max = (std::max)( e.wait_max,
+            std::chrono::nanoseconds( r.wait_max.load( std::memory_order_relaxed) ) );
+    e.hold_total += std::chrono::nanoseconds( r.hold_total.load( std::memory_order_relaxed) );
+}
+
+// the live records and the totals of the destroyed primitives per
+// construction site; only touched at construction, destruction and by
+// the profiler API - never on the lock paths
+class profile_registry {
+private:
+    struct live {
+        std::unique_ptr< profile_record >   record;
+        std::string                         name;
+    };
+
+    typedef std::pair< std::string, void const * >  site_key;
+
+    std::mutex                                      mtx_{};
+    std::unordered_map< void const *, live >        live_{};
+    std::map< site_key, profiler::entry >           dead_{};
+
+public:
+    profile_record * add_live( void const* object, char const* kind, void const* site) {
+        std::unique_ptr< profile_record > r{ new profile_record{ kind, object, site } };
+        profile_record * result = r.get();
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        live & l = live_[object];
+        l.record = std::move( r);
+        l.name.clear();
+        return result;
+    }
+
+    void remove_live( profile_record * r) noexcept {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        auto i = live_.find( r->object);
+        if ( live_.end() == i || i->second.record.get() != r) {
+            return;
+        }
+        try {
+            profiler::entry & e = dead_[site_key{ r->kind, r->site }];
+            e.kind = r->kind;
+            e.site = r->site;
+            if ( e.name.empty() ) {
+                e.name = i->second.name;
+            }
+            add( e, * r);
+        } catch (...) {
+            // statistics of this instance are lost
+        }
+        live_.erase( i);
+    }
+
+    void set_name( void const* object, std::string const& name) {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        auto i = live_.find( object);
+        if ( live_.end() != i) {
+            i->second.name = name;
+        }
+    }
+
+    std::vector< profiler::entry > snapshot() {
+        std::vector< profiler::entry > result;
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        result.reserve( live_.size() + dead_.size() );
+        for ( auto const& l : live_) {
+            profiler::entry e;
+            e.kind = l.second.record->kind;
+            e.object = l.first;
+            e.site = l.second.record->site;
+            e.name = l.second.name;
+            add( e, * l.second.record);
+            result.push_back( std::move( e) );
+        }
+        for ( auto const& d : dead_) {
+            result.push_back( d.second);
+        }
+        return result;
+    }
+
+    void reset() {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        for ( auto & l : live_) {
+            profile_record & r = * l.second.record;
+            r.acquisitions.store( 0, std::memory_order_relaxed);
+            r.contentions.store( 0, std::memory_order_relaxed);
+            r.wait_total.store( 0, std::memory_order_relaxed);
+            r.wait_max.store( 0, std::memory_order_relaxed);
+            r.hold_total.store( 0, std::memory_order_relaxed);
+        }
+        dead_.clear();
+    }
+};
+
+profile_registry & registry() {
+    // never destroyed - primitives with static storage duration might
+    // unregister after the end of main()
+    static profile_registry * instance = new profile_registry{};
+    return * instance;
+}
+
+}
+
+profile_record * profile_register( void const* object, char const* kind, void const* site) {
+    return registry().add_live( object, kind, site);
+}
+
+void profile_unregister( profile_record * r) noexcept {
+    registry().remove_live( r);
+}
+
+}
+#endif
+
+namespace profiler {
+
+bool enabled() noexcept {
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void set_name( void const* object, std::string const& name) {
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    detail::registry().set_name( object, name);
+#else
+    (void)object;
+    (void)name;
+#endif
+}
+
+std::vector< entry > snapshot() {
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    return detail::registry().snapshot();
+#else
+    return std::vector< entry >{};
+#endif
+}
+
+void dump( std::ostream & os) {
+    std::vector< entry > entries = snapshot();
+    std::sort( entries.begin(), entries.end(),
+               []( entry const& l, entry const& r) {
+                    return l.wait_total > r.wait_total;
+               });
+    os << std::left
+       << std::setw( 22) << "kind"
+       << std::setw( 20) << "object"
+       << std::setw( 20) << "site"
+       << std::right
+       << std::setw( 14) << "acquisitions"
+       << std::setw( 14) << "contentions"
+       << std::setw( 16) << "wait total[us]"
+       << std::setw( 14) << "wait max[us]"
+       << std::setw( 16) << "hold total[us]"
+       << "  name\n";
+    for ( entry const& e : entries) {
+        os << std::left
+           << std::setw( 22) << e.kind
+           << std::setw( 20) << e.object
+           << std::setw( 20) << e.site
+           << std::right
+           << std::setw( 14) << e.acquisitions
+           << std::setw( 14) << e.contentions
+           << std::setw( 16) << std::chrono::duration_cast< std::chrono::microseconds >( e.wait_total).count()
+           << std::setw( 14) << std::chrono::duration_cast< std::chrono::microseconds >( e.wait_max).count()
+           << std::setw( 16) << std::chrono::duration_cast< std::chrono::microseconds >( e.hold_total).count()
+           << "  " << e.name << '\n';
+    }
+}
+
+void reset() {
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    detail::registry().reset();
+#endif
+}
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
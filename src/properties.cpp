@@ -8,6 +8,7 @@
 #include <boost/assert.hpp>
 
 #include "boost/fiber/algo/algorithm.hpp"
+#include "boost/fiber/detail/lock_inheritance.hpp"
 #include "boost/fiber/scheduler.hpp"
 #include "boost/fiber/context.hpp"
 
@@ -33,6 +34,109 @@ fiber_properties::notify() noexcept {
     }
 }
 
+//static
+fiber_properties *
+fiber_properties::attach_( context * ctx) noexcept {
+    fiber_properties * props = ctx->get_properties();
+    if ( nullptr != props) {
+        return props;
+    }
+    // only an algorithm_with_properties creates properties
+    algo::algorithm_with_properties_base * algo =
+        dynamic_cast< algo::algorithm_with_properties_base * >( ctx->get_scheduler()->algo_.get() );
+    if ( nullptr == algo) {
+        return nullptr;
+    }
+    return algo->attach_properties_( ctx);
+}
+
+bool
+fiber_properties::lock_contended( context * owner, context * waiter) noexcept {
+    BOOST_ASSERT( nullptr != owner);
+    BOOST_ASSERT( nullptr != waiter);
+    // Both fibers must be managed by the same algorithm instance: the hook
+    // runs on the waiter's thread and must not touch another thread's
+    // algorithm (or cast properties of a different PROPS type).
+    if ( owner->get_scheduler() != waiter->get_scheduler() ) {
+        return false;
+    }
+    // A fiber which has never been passed to awakened() has no properties
+    // yet: a fiber launched with launch::dispatch runs - and might acquire
+    // the mutex - before it becomes ready for the first time.
+    fiber_properties * owner_props = attach_( owner);
+    fiber_properties * waiter_props = attach_( waiter);
+    // Only fibers managed by an algorithm_with_properties carry properties.
+    if ( nullptr == owner_props || nullptr == waiter_props ||
+         nullptr == owner_props->algo_ || owner_props->algo_ != waiter_props->algo_) {
+        return false;
+    }
+    return static_cast< algo::algorithm_with_properties_base * >( owner_props->algo_)->
+        lock_contended_( owner, owner_props, waiter, waiter_props);
+}
+
+void
+fiber_properties::lock_released( context * owner) noexcept {
+    BOOST_ASSERT( nullptr != owner);
+    fiber_properties * owner_props = owner->get_properties();
+    if ( nullptr == owner_props || nullptr == owner_props->algo_) {
+        return;
+    }
+    static_cast< algo::algorithm_with_properties_base * >( owner_props->algo_)->
+        lock_released_( owner, owner_props);
+}
+
+namespace detail {
+
+void
+lock_inheritance::contended( context * owner, context * waiter) noexcept {
+    if ( fiber_properties::lock_contended( owner, waiter) ) {
+        // the owner inherited from waiter - it is the most urgent waiter
+        // reported so far
+        booster_ = waiter;
+    }
+}
+
+void
+lock_inheritance::released( context * owner, context * waiter) noexcept {
+    // the owner might have inherited a priority from the waiters
+    fiber_properties::lock_released( owner);
+    if ( waiter == booster_) {
+        booster_ = nullptr;
+    }
+}
+
+void
+lock_inheritance::acquired( context * new_owner, context::wait_queue_t & waiters) noexcept {
+    if ( waiters.empty() ) {
+        booster_ = nullptr;
+        return;
+    }
+    // the remaining waiters are now blocked on the new owner - report the
+    // booster of the previous owner, or the next waiter in line
+    context * waiter = nullptr != booster_ ? booster_ : & waiters.front();
+    booster_ = nullptr;
+    contended( new_owner, waiter);
+}
+
+void
+lock_inheritance::withdrawn( context * owner, context * waiter, context::wait_queue_t & waiters) noexcept {
+    if ( waiter != booster_) {
+        return;
+    }
+    booster_ = nullptr;
+    if ( nullptr == owner) {
+        return;
+    }
+    // drop the priority inherited from waiter and re-evaluate against the
+    // next waiter in line
+    fiber_properties::lock_released( owner);
+    if ( ! waiters.empty() ) {
+        contended( owner, & waiters.front() );
+    }
+}
+
+}
+
 }}                                  // boost::fibers
 
 #ifdef BOOST_HAS_ABI_HEADERS
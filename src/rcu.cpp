@@ -0,0 +1,234 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/rcu.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/intrusive/list.hpp>
+
+#include "boost/fiber/context.hpp"
+#include "boost/fiber/detail/spinlock.hpp"
+#include "boost/fiber/fiber.hpp"
+#include "boost/fiber/operations.hpp"
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+// schedulers of all threads that entered a read-side section; the list
+// is only touched when a thread starts reading, when its scheduler is
+// destroyed and by synchronize_rcu()
+class rcu_domain {
+public:
+    typedef std::vector< std::pair< scheduler *, std::uint64_t > >    snapshot_t;
+
+private:
+    typedef intrusive::list<
+                scheduler,
+                intrusive::member_hook<
+                    scheduler, intrusive::list_member_hook<>, & scheduler::rcu_hook_ >,
+                intrusive::constant_time_size< false > >    readers_t;
+
+    spinlock                    splk_{};
+    readers_t                   readers_{};
+
+    bool is_registered_( scheduler * sched) const noexcept {
+        for ( scheduler const& reader : readers_) {
+            if ( sched == & reader) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    static rcu_domain & instance() noexcept {
+        // never destroyed - threads might exit after the end of main();
+        // constructed in static storage, the first rcu_read_lock() must
+        // not fail
+        static std::aligned_storage< sizeof( rcu_domain), alignof( rcu_domain) >::type storage;
+        static rcu_domain * domain = ::new ( static_cast< void * >( & storage) ) rcu_domain{};
+        return * domain;
+    }
+
+    static void quiescent( scheduler * sched) noexcept {
+        sched->rcu_advance_( sched->rcu_epoch_.load( std::memory_order_relaxed) + 2);
+    }
+
+    static bool is_reader( scheduler * sched) noexcept {
+        return sched->rcu_reader_;
+    }
+
+    void add( scheduler * sched) noexcept {
+        spinlock_lock lk{ splk_ };
+        readers_.push_back( * sched);
+        // read only by the thread of sched
+        sched->rcu_reader_ = true;
+    }
+
+    void remove( scheduler * sched) noexcept {
+        spinlock_lock lk{ splk_ };
+        if ( sched->rcu_hook_.is_linked() ) {
+            readers_.erase( readers_.iterator_to( * sched) );
+        }
+    }
+
+    // the epochs of the other schedulers that currently run a fiber
+    void snapshot( scheduler * self, snapshot_t & busy) {
+        spinlock_lock lk{ splk_ };
+        for ( scheduler & sched : readers_) {
+            if ( self == & sched) {
+                // the other fibers of this thread are suspended
+                continue;
+            }
+            const std::uint64_t epoch = sched.rcu_epoch_.load( std::memory_order_acquire);
+            if ( 0 == ( epoch & 1) ) {
+                busy.emplace_back( & sched, epoch);
+            }
+        }
+    }
+
+    // drops the schedulers that passed a quiescent state (or are gone);
+    // returns true if none is left
+    bool poll( snapshot_t & busy) noexcept {
+        spinlock_lock lk{ splk_ };
+        snapshot_t::iterator e = busy.end();
+        for ( snapshot_t::iterator i = busy.begin(); i != e;) {
+            // a scheduler that is gone must not be dereferenced
+            if ( ! is_registered_( i->first) ||
+                 i->second != i->first->rcu_epoch_.load( std::memory_order_acquire) ) {
+                i = busy.erase( i);
+                e = busy.end();
+            } else {
+                ++i;
+            }
+        }
+        return busy.empty();
+    }
+};
+#endif
+
+void rcu_unregister( scheduler * sched) noexcept {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    rcu_domain::instance().remove( sched);
+#else
+    (void)sched;
+#endif
+}
+
+namespace {
+
+// callbacks of call_rcu() waiting for the next grace period; shared with
+// the helper fiber (which might migrate to another thread)
+struct rcu_callbacks {
+    spinlock                                splk{};
+    std::vector< std::function< void() > >  pending{};
+    bool                                    running{ false };
+};
+
+void rcu_reclaim( std::shared_ptr< rcu_callbacks > cbs) {
+    std::vector< std::function< void() > > batch;
+    for (;;) {
+        {
+            spinlock_lock lk{ cbs->splk };
+            if ( cbs->pending.empty() ) {
+                cbs->running = false;
+                return;
+            }
+            batch.swap( cbs->pending);
+        }
+        // one grace period for all callbacks queued meanwhile
+        synchronize_rcu();
+        for ( std::function< void() > & fn : batch) {
+            fn();
+        }
+        batch.clear();
+    }
+}
+
+}
+
+}
+
+void rcu_read_lock() noexcept {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    scheduler * sched = context::active()->get_scheduler();
+    if ( BOOST_UNLIKELY( ! detail::rcu_domain::is_reader( sched) ) ) {
+        detail::rcu_domain::instance().add( sched);
+    }
+#endif
+}
+
+void rcu_quiescent_state() noexcept {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    scheduler * sched = context::active()->get_scheduler();
+    if ( detail::rcu_domain::is_reader( sched) ) {
+        detail::rcu_domain::quiescent( sched);
+    }
+#endif
+}
+
+void synchronize_rcu() {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    // order the updates of the caller before reading the epochs
+    std::atomic_thread_fence( std::memory_order_seq_cst);
+    detail::rcu_domain & domain = detail::rcu_domain::instance();
+    detail::rcu_domain::snapshot_t busy;
+    domain.snapshot( context::active()->get_scheduler(), busy);
+    std::chrono::microseconds delay{ 10 };
+    for ( std::size_t i = 0; ! domain.poll( busy); ++i) {
+        if ( 8 > i) {
+            // let the other fibers of this thread run
+            this_fiber::yield();
+        } else {
+            // readers of other threads need to pass their scheduler
+            this_fiber::sleep_for( delay);
+            delay = (std::min)( 2 * delay, std::chrono::microseconds{ 1000 });
+        }
+    }
+#endif
+}
+
+void call_rcu( std::function< void() > fn) {
+    static thread_local std::shared_ptr< detail::rcu_callbacks > cbs{
+        std::make_shared< detail::rcu_callbacks >() };
+    {
+        detail::spinlock_lock lk{ cbs->splk };
+        cbs->pending.push_back( std::move( fn) );
+        if ( cbs->running) {
+            return;
+        }
+        cbs->running = true;
+    }
+    try {
+        fiber{ launch::post, & detail::rcu_reclaim, cbs }.detach();
+    } catch (...) {
+        detail::spinlock_lock lk{ cbs->splk };
+        cbs->running = false;
+        throw;
+    }
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
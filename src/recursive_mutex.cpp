@@ -19,9 +19,23 @@
 namespace boost {
 namespace fibers {
 
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+recursive_mutex::recursive_mutex() :
+    profile_{ detail::profile_register( this, "recursive_mutex", BOOST_FIBERS_RETURN_ADDRESS() ) } {
+}
+
+recursive_mutex::~recursive_mutex() {
+    BOOST_ASSERT( nullptr == owner_);
+    BOOST_ASSERT( 0 == count_);
+    BOOST_ASSERT( wait_queue_.empty() );
+    detail::profile_unregister( profile_);
+}
+#endif
+
 void
 recursive_mutex::lock() {
     context * ctx = context::active();
+    BOOST_FIBERS_PROFILE( const std::int64_t start = detail::profile_now(); )
     // store this fiber in order to be notified later
     detail::spinlock_lock lk( wait_queue_splk_);
     if ( ctx == owner_) {
@@ -30,13 +44,18 @@ recursive_mutex::lock() {
     } else if ( nullptr == owner_) {
         owner_ = ctx;
         count_ = 1;
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
         return;
     }
     BOOST_ASSERT( ! ctx->wait_is_linked() );
+    // let the algorithm of the owner know about the waiter
+    // (priority inheritance)
+    inheritance_.contended( owner_, ctx);
     ctx->wait_link( wait_queue_);
     // suspend this fiber
     ctx->suspend( lk);
     BOOST_ASSERT( ! ctx->wait_is_linked() );
+    BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
 }
 
 bool
@@ -46,13 +65,19 @@ recursive_mutex::try_lock() noexcept {
     if ( nullptr == owner_) {
         owner_ = ctx;
         count_ = 1;
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
     } else if ( ctx == owner_) {
         ++count_;
     }
-    lk.unlock();
+    return ctx == owner_;
+}
+
+bool
+recursive_mutex::try_lock_and_yield() noexcept {
+    bool locked = try_lock();
     // let other fiber release the lock
     context::active()->yield();
-    return ctx == owner_;
+    return locked;
 }
 
 void
@@ -65,12 +90,15 @@ recursive_mutex::unlock() {
                 "boost fiber: no  privilege to perform the operation");
     }
     if ( 0 == --count_) {
+        BOOST_FIBERS_PROFILE( detail::profile_released( profile_); )
         if ( ! wait_queue_.empty() ) {
-            context * ctx = & wait_queue_.front();
+            context * waiter = & wait_queue_.front();
             wait_queue_.pop_front();
-            owner_ = ctx;
+            inheritance_.released( ctx, waiter);
+            owner_ = waiter;
             count_ = 1;
-            context::active()->set_ready( ctx);
+            inheritance_.acquired( waiter, wait_queue_);
+            context::active()->set_ready( waiter);
         } else {
             owner_ = nullptr;
             return;
@@ -19,12 +19,26 @@
 namespace boost {
 namespace fibers {
 
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+recursive_timed_mutex::recursive_timed_mutex() :
+    profile_{ detail::profile_register( this, "recursive_timed_mutex", BOOST_FIBERS_RETURN_ADDRESS() ) } {
+}
+
+recursive_timed_mutex::~recursive_timed_mutex() {
+    BOOST_ASSERT( nullptr == owner_);
+    BOOST_ASSERT( 0 == count_);
+    BOOST_ASSERT( wait_queue_.empty() );
+    detail::profile_unregister( profile_);
+}
+#endif
+
 bool
 recursive_timed_mutex::try_lock_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept {
     if ( std::chrono::steady_clock::now() > timeout_time) {
         return false;
     }
     context * ctx = context::active();
+    BOOST_FIBERS_PROFILE( const std::int64_t start = detail::profile_now(); )
     // store this fiber in order to be notified later
     detail::spinlock_lock lk( wait_queue_splk_);
     if ( ctx == owner_) {
@@ -33,24 +47,36 @@ recursive_timed_mutex::try_lock_until_( std::chrono::steady_clock::time_point co
     } else if ( nullptr == owner_) {
         owner_ = ctx;
         count_ = 1;
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
         return true;
     }
     BOOST_ASSERT( ! ctx->wait_is_linked() );
+    // let the algorithm of the owner know about the waiter
+    // (priority inheritance)
+    inheritance_.contended( owner_, ctx);
     ctx->wait_link( wait_queue_);
     // suspend this fiber until notified or timed-out
     if ( ! context::active()->wait_until( timeout_time, lk) ) {
-        // remove fiber from wait-queue 
         lk.lock();
-        ctx->wait_unlink();
-        return false;
+        if ( ctx->wait_is_linked() ) {
+            // remove fiber from wait-queue
+            ctx->wait_unlink();
+            // the owner might have inherited the priority of this fiber
+            inheritance_.withdrawn( owner_, ctx, wait_queue_);
+            BOOST_FIBERS_PROFILE( detail::profile_waited( profile_, start); )
+            return false;
+        }
+        // the lock was handed over while timing out
     }
     BOOST_ASSERT( ! ctx->wait_is_linked() );
+    BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
     return ctx == owner_;
 }
 
 void
 recursive_timed_mutex::lock() {
     context * ctx = context::active();
+    BOOST_FIBERS_PROFILE( const std::int64_t start = detail::profile_now(); )
     // store this fiber in order to be notified later
     detail::spinlock_lock lk( wait_queue_splk_);
     if ( ctx == owner_) {
@@ -59,13 +85,18 @@ recursive_timed_mutex::lock() {
     } else if ( nullptr == owner_) {
         owner_ = ctx;
         count_ = 1;
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
         return;
     }
     BOOST_ASSERT( ! ctx->wait_is_linked() );
+    // let the algorithm of the owner know about the waiter
+    // (priority inheritance)
+    inheritance_.contended( owner_, ctx);
     ctx->wait_link( wait_queue_);
     // suspend this fiber
     ctx->suspend( lk);
     BOOST_ASSERT( ! ctx->wait_is_linked() );
+    BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
 }
 
 bool
@@ -75,13 +106,19 @@ recursive_timed_mutex::try_lock() noexcept {
     if ( nullptr == owner_) {
         owner_ = ctx;
         count_ = 1;
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
     } else if ( ctx == owner_) {
         ++count_;
     }
-    lk.unlock();
+    return ctx == owner_;
+}
+
+bool
+recursive_timed_mutex::try_lock_and_yield() noexcept {
+    bool locked = try_lock();
     // let other fiber release the lock
     context::active()->yield();
-    return ctx == owner_;
+    return locked;
 }
 
 void
@@ -94,12 +131,15 @@ recursive_timed_mutex::unlock() {
                 "boost fiber: no  privilege to perform the operation");
     }
     if ( 0 == --count_) {
+        BOOST_FIBERS_PROFILE( detail::profile_released( profile_); )
         if ( ! wait_queue_.empty() ) {
-            context * ctx = & wait_queue_.front();
+            context * waiter = & wait_queue_.front();
             wait_queue_.pop_front();
-            owner_ = ctx;
+            inheritance_.released( ctx, waiter);
+            owner_ = waiter;
             count_ = 1;
-            context::active()->set_ready( ctx);
+            inheritance_.acquired( waiter, wait_queue_);
+            context::active()->set_ready( waiter);
         } else {
             owner_ = nullptr;
             return;
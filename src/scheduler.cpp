@@ -14,6 +14,7 @@
 #include "boost/fiber/algo/round_robin.hpp"
 #include "boost/fiber/context.hpp"
 #include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/rcu.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -22,8 +23,25 @@
 namespace boost {
 namespace fibers {
 
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+void
+scheduler::rcu_advance_( std::uint64_t epoch) noexcept {
+    // written only by this thread; the release publishes the end of the
+    // read-side sections, the fence orders the read-side sections
+    // entered afterwards behind updates synchronize_rcu() waits for
+    rcu_epoch_.store( epoch, std::memory_order_release);
+    std::atomic_thread_fence( std::memory_order_seq_cst);
+}
+#endif
+
 context *
 scheduler::get_next_() noexcept {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    if ( rcu_reader_) {
+        // the active fiber leaves the thread - quiescent state
+        rcu_advance_( rcu_epoch_.load( std::memory_order_relaxed) + 2);
+    }
+#endif
     context * ctx = algo_->pick_next();
     //BOOST_ASSERT( nullptr == ctx);
     //BOOST_ASSERT( this == ctx->get_scheduler() );
@@ -57,6 +75,8 @@ scheduler::release_terminated_() noexcept {
 void
 scheduler::remote_ready2ready_() noexcept {
     context * ctx = nullptr;
+    // contexts pushed from now on need another notification
+    remote_notified_.exchange( false, std::memory_order_acq_rel);
     // get context from remote ready-queue
     while ( nullptr != ( ctx = remote_ready_queue_.pop() ) ) {
         // store context in local queues
@@ -115,6 +135,11 @@ scheduler::~scheduler() {
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
 #endif
     BOOST_ASSERT( sleep_queue_.empty() );
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    if ( rcu_reader_) {
+        detail::rcu_unregister( this);
+    }
+#endif
     // set active context to nullptr
     context::reset_active();
     // deallocate dispatcher-context
@@ -163,7 +188,18 @@ scheduler::dispatch() noexcept {
                 suspend_time = i->tp_;
             }
             // no ready context, wait till signaled
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+            if ( rcu_reader_) {
+                // no fiber runs while idle - quiescent state
+                rcu_advance_( rcu_epoch_.load( std::memory_order_relaxed) | 1);
+            }
+#endif
             algo_->suspend_until( suspend_time);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+            if ( rcu_reader_) {
+                rcu_advance_( rcu_epoch_.load( std::memory_order_relaxed) + 1);
+            }
+#endif
         }
     }
     // release termianted context'
@@ -210,7 +246,18 @@ scheduler::dispatch() noexcept {
                 suspend_time = i->tp_;
             }
             // no ready context, wait till signaled
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+            if ( rcu_reader_) {
+                // no fiber runs while idle - quiescent state
+                rcu_advance_( rcu_epoch_.load( std::memory_order_relaxed) | 1);
+            }
+#endif
             algo_->suspend_until( suspend_time);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+            if ( rcu_reader_) {
+                rcu_advance_( rcu_epoch_.load( std::memory_order_relaxed) + 1);
+            }
+#endif
         }
     }
     // release termianted context'
@@ -254,8 +301,22 @@ scheduler::set_remote_ready( context * ctx) noexcept {
     // scheduler::dispatcher() has to take care
     // push new context to remote ready-queue
     remote_ready_queue_.push( ctx);
-    // notify scheduler
-    algo_->notify();
+    // notify scheduler; a pending notification covers ctx too because
+    // the dispatcher drains the queue before it suspends again
+    if ( ! remote_notified_.exchange( true, std::memory_order_acq_rel) ) {
+        algo_->notify();
+    }
+}
+
+void
+scheduler::set_remote_ready( context * first, context * last) noexcept {
+    BOOST_ASSERT( nullptr != first);
+    BOOST_ASSERT( nullptr != last);
+    // one push and at most one notification for the whole batch
+    remote_ready_queue_.push( first, last);
+    if ( ! remote_notified_.exchange( true, std::memory_order_acq_rel) ) {
+        algo_->notify();
+    }
 }
 #endif
 
@@ -350,7 +411,7 @@ scheduler::wait_until( context * active_ctx,
 bool
 scheduler::wait_until( context * active_ctx,
                        std::chrono::steady_clock::time_point const& sleep_tp,
-                       detail::spinlock_lock & lk) noexcept {
+                       detail::lock_ref const& lk) noexcept {
     BOOST_ASSERT( nullptr != active_ctx);
     //BOOST_ASSERT( main_ctx_ == active_ctx || dispatcher_ctx_.get() == active_ctx || active_ctx->worker_is_linked() );
     BOOST_ASSERT( ! active_ctx->is_terminated() );
@@ -384,7 +445,7 @@ scheduler::suspend() noexcept {
 }
 
 void
-scheduler::suspend( detail::spinlock_lock & lk) noexcept {
+scheduler::suspend( detail::lock_ref const& lk) noexcept {
     // resume another context
     get_next_()->resume( lk);
 }
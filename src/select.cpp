@@ -0,0 +1,103 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/select.hpp"
+
+#include "boost/fiber/context.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+constexpr std::size_t select_state::none;
+
+bool
+select_state::fire( std::size_t index) noexcept {
+    spinlock_lock lk{ splk };
+    if ( none != fired) {
+        return false;
+    }
+    fired = index;
+    if ( sleeping) {
+        // readied while splk is held: a timed-out select() has to
+        // acquire splk before it claims the timeout
+        context::active()->set_ready( ctx);
+    }
+    return true;
+}
+
+select_result
+select_( select_case ** cases, select_waiter * waiters, std::size_t n,
+         std::chrono::steady_clock::time_point const* timeout_time) {
+    context * active_ctx = context::active();
+    select_state state{ active_ctx };
+    for ( std::size_t i = 0; i < n; ++i) {
+        waiters[i].state = & state;
+        waiters[i].index = i;
+    }
+    std::size_t woken = select_state::none;
+    for (;;) {
+        for ( std::size_t j = 0; j < n; ++j) {
+            // the case the fiber was woken for goes first, otherwise its
+            // notification would be lost if another case wins
+            std::size_t i = n > woken ? ( woken + j) % n : j;
+            channel_op_status status = cases[i]->try_complete( timeout_time);
+            if ( channel_op_status::success == status ||
+                 channel_op_status::closed == status) {
+                return select_result{ i, status };
+            }
+            if ( channel_op_status::timeout == status) {
+                return select_result{ n, status };
+            }
+        }
+        // no case is ready, link one waiter into each channel
+        state.fired = select_state::none;
+        state.sleeping = false;
+        std::size_t armed = 0;
+        while ( armed < n && cases[armed]->arm( waiters[armed]) ) {
+            ++armed;
+        }
+        bool timed_out = false;
+        if ( n == armed) {
+            spinlock_lock lk{ state.splk };
+            // a channel might have fired while the waiters were linked
+            if ( select_state::none == state.fired) {
+                state.sleeping = true;
+                if ( nullptr == timeout_time) {
+                    // suspend this fiber once for all cases
+                    active_ctx->suspend( lk);
+                } else if ( ! active_ctx->wait_until( * timeout_time, lk) ) {
+                    // relock local lk
+                    lk.lock();
+                    if ( select_state::none == state.fired) {
+                        // from now on the channels pass their notifications
+                        // on to other waiters
+                        state.fired = n;
+                        timed_out = true;
+                    }
+                }
+            }
+        }
+        // afterwards no channel references state
+        for ( std::size_t i = 0; i < armed; ++i) {
+            cases[i]->disarm( waiters[i]);
+        }
+        if ( timed_out) {
+            return select_result{ n, channel_op_status::timeout };
+        }
+        woken = state.fired;
+    }
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,159 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/shared_mutex.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <system_error>
+
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+void
+shared_mutex::wake_readers_() noexcept {
+    // all waiting readers become shared owners at once, a writer queued
+    // behind them keeps new readers out
+    const std::size_t n = static_cast< std::size_t >(
+            std::distance( readers_queue_.begin(), readers_queue_.end() ) );
+    state_.hand_over_shared( n, ! writers_queue_.empty() );
+    context * active_ctx = context::active();
+    while ( ! readers_queue_.empty() ) {
+        context * ctx = & readers_queue_.front();
+        readers_queue_.pop_front();
+        active_ctx->set_ready( ctx);
+    }
+}
+
+void
+shared_mutex::wake_writer_() noexcept {
+    context * ctx = & writers_queue_.front();
+    writers_queue_.pop_front();
+    state_.hand_over( ctx, ! writers_queue_.empty() || ! readers_queue_.empty() );
+    context::active()->set_ready( ctx);
+}
+
+void
+shared_mutex::lock() {
+    context * ctx = context::active();
+    // fast path: neither readers nor a writer
+    if ( state_.try_acquire( ctx) ) {
+        return;
+    }
+    if ( ctx == state_.owner() ) {
+        throw lock_error(
+                std::make_error_code( std::errc::resource_deadlock_would_occur),
+                "boost fiber: a deadlock is detected");
+    }
+    // store this fiber in order to be notified later
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( state_.acquire_or_wait( ctx) ) {
+        // released in the meantime
+        return;
+    }
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    ctx->wait_link( writers_queue_);
+    // suspend this fiber
+    ctx->suspend( lk);
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    BOOST_ASSERT( ctx == state_.owner() );
+}
+
+bool
+shared_mutex::try_lock() {
+    context * ctx = context::active();
+    if ( ctx == state_.owner() ) {
+        throw lock_error(
+                std::make_error_code( std::errc::resource_deadlock_would_occur),
+                "boost fiber: a deadlock is detected");
+    }
+    return state_.try_acquire( ctx);
+}
+
+void
+shared_mutex::unlock() {
+    context * ctx = context::active();
+    if ( ctx != state_.owner() ) {
+        throw lock_error(
+                std::make_error_code( std::errc::operation_not_permitted),
+                "boost fiber: no  privilege to perform the operation");
+    }
+    // fast path: no waiters
+    if ( state_.try_release() ) {
+        return;
+    }
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( ! readers_queue_.empty() ) {
+        // readers blocked by this writer are preferred to the other writers
+        wake_readers_();
+    } else if ( ! writers_queue_.empty() ) {
+        wake_writer_();
+    } else {
+        state_.release();
+    }
+}
+
+void
+shared_mutex::lock_shared() {
+    // fast path: no writer owns or waits
+    if ( state_.try_acquire_shared() ) {
+        return;
+    }
+    context * ctx = context::active();
+    if ( ctx == state_.owner() ) {
+        throw lock_error(
+                std::make_error_code( std::errc::resource_deadlock_would_occur),
+                "boost fiber: a deadlock is detected");
+    }
+    // store this fiber in order to be notified later
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( state_.acquire_shared_or_wait() ) {
+        // released in the meantime
+        return;
+    }
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+    ctx->wait_link( readers_queue_);
+    // suspend this fiber; the shared ownership is passed on wakeup
+    ctx->suspend( lk);
+    BOOST_ASSERT( ! ctx->wait_is_linked() );
+}
+
+bool
+shared_mutex::try_lock_shared() {
+    return state_.try_acquire_shared();
+}
+
+void
+shared_mutex::unlock_shared() {
+    // fast path: no waiters
+    if ( state_.try_release_shared() ) {
+        return;
+    }
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( 0 < state_.release_shared() ) {
+        // the last shared owner wakes up the waiters
+        return;
+    }
+    if ( ! writers_queue_.empty() ) {
+        wake_writer_();
+    } else if ( ! readers_queue_.empty() ) {
+        wake_readers_();
+    } else {
+        state_.clear_waiters();
+    }
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
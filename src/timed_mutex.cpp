@@ -19,85 +19,159 @@
 namespace boost {
 namespace fibers {
 
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+timed_mutex::timed_mutex() :
+    profile_{ detail::profile_register( this, "timed_mutex", BOOST_FIBERS_RETURN_ADDRESS() ) } {
+}
+
+timed_mutex::~timed_mutex() {
+    BOOST_ASSERT( nullptr == state_.owner() );
+    BOOST_ASSERT( wait_queue_.empty() );
+    detail::profile_unregister( profile_);
+}
+#endif
+
 bool
 timed_mutex::try_lock_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept {
     if ( std::chrono::steady_clock::now() > timeout_time) {
         return false;
     }
     context * ctx = context::active();
+    // fast path: lock-word is free
+    if ( state_.try_acquire( ctx) ) {
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
+        return true;
+    }
+    BOOST_FIBERS_PROFILE( const std::int64_t start = detail::profile_now(); )
+    // the owner might run in another thread and release the lock soon
+    if ( state_.spin( ctx) ) {
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
+        return true;
+    }
     // store this fiber in order to be notified later
     detail::spinlock_lock lk( wait_queue_splk_);
-    if ( nullptr == owner_) {
-        owner_ = ctx;
+    if ( state_.acquire_or_wait( ctx) ) {
+        // released in the meantime
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
         return true;
     }
     BOOST_ASSERT( ! ctx->wait_is_linked() );
+    // let the algorithm of the owner know about the waiter
+    // (priority inheritance)
+    inheritance_.contended( state_.owner(), ctx);
     ctx->wait_link( wait_queue_);
     // suspend this fiber until notified or timed-out
     if ( ! context::active()->wait_until( timeout_time, lk) ) {
-        // remove fiber from wait-queue 
         lk.lock();
-        ctx->wait_unlink();
-        return false;
+        if ( ctx->wait_is_linked() ) {
+            // remove fiber from wait-queue
+            ctx->wait_unlink();
+            if ( wait_queue_.empty() ) {
+                state_.clear_waiters();
+            }
+            // the owner might have inherited the priority of this fiber
+            inheritance_.withdrawn( state_.owner(), ctx, wait_queue_);
+            BOOST_FIBERS_PROFILE( detail::profile_waited( profile_, start); )
+            return false;
+        }
+        // the lock was handed over while timing out
     }
     BOOST_ASSERT( ! ctx->wait_is_linked() );
+    BOOST_ASSERT( ctx == state_.owner() );
+    BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
     return true;
 }
 
 void
 timed_mutex::lock() {
     context * ctx = context::active();
-    // store this fiber in order to be notified later
-    detail::spinlock_lock lk( wait_queue_splk_);
-    if ( ctx == owner_) {
+    // fast path: lock-word is free
+    if ( state_.try_acquire( ctx) ) {
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
+        return;
+    }
+    if ( ctx == state_.owner() ) {
         throw lock_error(
                 std::make_error_code( std::errc::resource_deadlock_would_occur),
                 "boost fiber: a deadlock is detected");
-    } else if ( nullptr == owner_) {
-        owner_ = ctx;
+    }
+    BOOST_FIBERS_PROFILE( const std::int64_t start = detail::profile_now(); )
+    // the owner might run in another thread and release the lock soon
+    if ( state_.spin( ctx) ) {
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
+        return;
+    }
+    // store this fiber in order to be notified later
+    detail::spinlock_lock lk( wait_queue_splk_);
+    if ( state_.acquire_or_wait( ctx) ) {
+        // released in the meantime
+        BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
         return;
     }
     BOOST_ASSERT( ! ctx->wait_is_linked() );
+    // let the algorithm of the owner know about the waiter
+    // (priority inheritance)
+    inheritance_.contended( state_.owner(), ctx);
     ctx->wait_link( wait_queue_);
     // suspend this fiber
     ctx->suspend( lk);
     BOOST_ASSERT( ! ctx->wait_is_linked() );
+    BOOST_ASSERT( ctx == state_.owner() );
+    BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_, start); )
 }
 
 bool
 timed_mutex::try_lock() {
     context * ctx = context::active();
-    detail::spinlock_lock lk( wait_queue_splk_);
-    if ( ctx == owner_) {
+    if ( ctx == state_.owner() ) {
         throw lock_error(
                 std::make_error_code( std::errc::resource_deadlock_would_occur),
                 "boost fiber: a deadlock is detected");
-    } else if ( nullptr == owner_) {
-        owner_ = ctx;
     }
-    lk.unlock();
+    if ( ! state_.try_acquire( ctx) ) {
+        return false;
+    }
+    BOOST_FIBERS_PROFILE( detail::profile_acquired( profile_); )
+    return true;
+}
+
+bool
+timed_mutex::try_lock_and_yield() {
+    bool locked = try_lock();
     // let other fiber release the lock
     context::active()->yield();
-    return ctx == owner_;
+    return locked;
 }
 
 void
 timed_mutex::unlock() {
     context * ctx = context::active();
-    detail::spinlock_lock lk( wait_queue_splk_);
-    if ( ctx != owner_) {
+    // only the hold time of the owner is recorded - unlock() by any other
+    // fiber throws below
+    BOOST_FIBERS_PROFILE(
+        if ( ctx == state_.owner() ) {
+            detail::profile_released( profile_);
+        } )
+    // fast path: no waiters
+    if ( state_.try_release( ctx) ) {
+        return;
+    }
+    if ( ctx != state_.owner() ) {
         throw lock_error(
                 std::make_error_code( std::errc::operation_not_permitted),
                 "boost fiber: no  privilege to perform the operation");
     }
+    detail::spinlock_lock lk( wait_queue_splk_);
     if ( ! wait_queue_.empty() ) {
-        context * ctx = & wait_queue_.front();
+        context * waiter = & wait_queue_.front();
         wait_queue_.pop_front();
-        owner_ = ctx;
-        context::active()->set_ready( ctx);
+        inheritance_.released( ctx, waiter);
+        state_.hand_over( waiter, ! wait_queue_.empty() );
+        inheritance_.acquired( waiter, wait_queue_);
+        context::active()->set_ready( waiter);
     } else {
-        owner_ = nullptr;
-        return;
+        // the last waiter timed out meanwhile
+        state_.hand_over( nullptr, false);
     }
 }
 
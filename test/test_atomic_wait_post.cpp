@@ -0,0 +1,151 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::chrono::milliseconds ms;
+
+void test_wait_changed() {
+    std::atomic< int > value{ 1 };
+    // returns immediately - the value differs from old
+    boost::fibers::atomic_wait( & value, 0);
+    // nobody waits
+    boost::fibers::atomic_notify_one( & value);
+    boost::fibers::atomic_notify_all( & value);
+    BOOST_CHECK_EQUAL( 1, value.load() );
+}
+
+void do_test_notify_one() {
+    std::atomic< int > value{ 0 };
+    int woken = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 3; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [&value,&woken](){
+            boost::fibers::atomic_wait( & value, 0);
+            ++woken;
+        });
+    }
+    // let all fibers block
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 0, woken);
+    // a notification without a change of the value parks the fiber again
+    boost::fibers::atomic_notify_all( & value);
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 0, woken);
+    value = 1;
+    boost::fibers::atomic_notify_one( & value);
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 1, woken);
+    boost::fibers::atomic_notify_one( & value);
+    boost::fibers::atomic_notify_one( & value);
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 3, woken);
+}
+
+void test_notify_one() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_notify_one).join();
+}
+
+void do_test_notify_address() {
+    // only the waiters of the notified address are woken, even if both
+    // addresses hash to the same bucket
+    std::atomic< int > values[2];
+    values[0] = 0;
+    values[1] = 0;
+    bool woken[2] = { false, false };
+    boost::fibers::fiber f0( boost::fibers::launch::post, [&values,&woken](){
+        boost::fibers::atomic_wait( & values[0], 0);
+        woken[0] = true;
+    });
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&values,&woken](){
+        boost::fibers::atomic_wait( & values[1], 0);
+        woken[1] = true;
+    });
+    boost::this_fiber::yield();
+    values[1] = 1;
+    boost::fibers::atomic_notify_all( & values[1]);
+    f1.join();
+    BOOST_CHECK( ! woken[0]);
+    BOOST_CHECK( woken[1]);
+    values[0] = 1;
+    boost::fibers::atomic_notify_all( & values[0]);
+    f0.join();
+    BOOST_CHECK( woken[0]);
+}
+
+void test_notify_address() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_notify_address).join();
+}
+
+void test_notify_all_mt() {
+    std::atomic< int > value{ 0 };
+    std::atomic< int > woken{ 0 };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i) {
+        threads.emplace_back( [&value,&woken](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int i = 0; i < 4; ++i) {
+                fibers.emplace_back( boost::fibers::launch::post, [&value,&woken](){
+                    boost::fibers::atomic_wait( & value, 0);
+                    ++woken;
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    std::this_thread::sleep_for( ms( 10) );
+    value = 1;
+    boost::fibers::atomic_notify_all( & value);
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( 16, woken.load() );
+}
+
+void test_ping_pong_mt() {
+    std::atomic< int > turn{ 0 };
+    auto player = [&turn]( int self) {
+        boost::fibers::fiber( boost::fibers::launch::post, [&turn,self](){
+            for ( int i = 0; i < 1000; ++i) {
+                int value = turn.load();
+                while ( value % 2 != self) {
+                    boost::fibers::atomic_wait( & turn, value);
+                    value = turn.load();
+                }
+                ++turn;
+                boost::fibers::atomic_notify_one( & turn);
+            }
+        }).join();
+    };
+    std::thread t0( player, 0);
+    std::thread t1( player, 1);
+    t0.join();
+    t1.join();
+    BOOST_CHECK_EQUAL( 2000, turn.load() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: atomic_wait test suite");
+
+    test->add( BOOST_TEST_CASE( & test_wait_changed) );
+    test->add( BOOST_TEST_CASE( & test_notify_one) );
+    test->add( BOOST_TEST_CASE( & test_notify_address) );
+    test->add( BOOST_TEST_CASE( & test_notify_all_mt) );
+    test->add( BOOST_TEST_CASE( & test_ping_pong_mt) );
+
+	return test;
+}
@@ -6,8 +6,11 @@
 //
 // This test is based on the tests of Boost.Thread
 
+#include <atomic>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -61,11 +64,180 @@ void test_barrier() {
     BOOST_CHECK_EQUAL( 5, value2);
 }
 
+void do_test_barrier_completion() {
+    int phases = 0;
+    int arrived = 0;
+    bool complete = true;
+    boost::fibers::barrier b( 3, [&phases,&arrived,&complete](){
+        // runs before any fiber of the phase is released
+        complete = complete && 3 == arrived;
+        arrived = 0;
+        ++phases;
+    });
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 3; ++i) {
+        fibers.emplace_back( boost::fibers::launch::dispatch, [&b,&arrived](){
+            for ( int j = 0; j < 4; ++j) {
+                ++arrived;
+                b.arrive_and_wait();
+            }
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 4, phases);
+    BOOST_CHECK( complete);
+}
+
+void test_barrier_completion() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_barrier_completion).join();
+}
+
+void do_test_barrier_split_phase() {
+    boost::fibers::barrier b( 2);
+    bool done = false;
+    boost::fibers::barrier::arrival_token token = b.arrive();
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&b,&done](){
+        done = true;
+        // completes the phase - does not block
+        BOOST_CHECK( b.wait() );
+    });
+    b.wait( std::move( token) );
+    BOOST_CHECK( done);
+    f.join();
+    // a token of a completed phase does not block
+    boost::fibers::barrier::arrival_token t1 = b.arrive();
+    b.arrive();
+    b.wait( std::move( t1) );
+}
+
+void test_barrier_split_phase() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_barrier_split_phase).join();
+}
+
+void do_test_barrier_arrive_and_drop() {
+    int phases = 0;
+    boost::fibers::barrier b( 3, [&phases](){ ++phases; });
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&b](){
+        b.arrive_and_wait();
+        b.arrive_and_drop();
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&b](){
+        b.arrive_and_wait();
+        b.arrive_and_wait();
+        // f1 left the barrier
+        b.arrive_and_wait();
+    });
+    b.arrive_and_wait();
+    b.arrive_and_wait();
+    b.arrive_and_wait();
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 3, phases);
+}
+
+void test_barrier_arrive_and_drop() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_barrier_arrive_and_drop).join();
+}
+
+void test_barrier_mt() {
+    std::atomic< int > counter{ 0 };
+    bool failed = false;
+    int phases = 0;
+    boost::fibers::barrier b( 4 * 8, [&counter,&failed,&phases](){
+        // every fiber incremented the counter once per phase
+        if ( 4 * 8 * ( phases + 1) != counter.load() ) {
+            failed = true;
+        }
+        ++phases;
+    });
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i) {
+        threads.emplace_back( [&b,&counter](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int i = 0; i < 8; ++i) {
+                fibers.emplace_back( boost::fibers::launch::dispatch, [&b,&counter](){
+                    for ( int j = 0; j < 100; ++j) {
+                        ++counter;
+                        b.arrive_and_wait();
+                    }
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK( ! failed);
+    BOOST_CHECK_EQUAL( 100, phases);
+}
+
+void test_barrier_mt_phases() {
+    // no fiber may leave arrive_and_wait() before its phase completed
+    std::atomic< int > phases{ 0 };
+    std::atomic< bool > failed{ false };
+    boost::fibers::barrier b( 4 * 4, [&phases](){ ++phases; });
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i) {
+        threads.emplace_back( [&b,&phases,&failed](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int k = 0; k < 4; ++k) {
+                fibers.emplace_back( boost::fibers::launch::dispatch, [&b,&phases,&failed](){
+                    for ( int j = 0; j < 1000; ++j) {
+                        b.arrive_and_wait();
+                        if ( j + 1 > phases.load() ) {
+                            failed = true;
+                        }
+                    }
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK( ! failed);
+    BOOST_CHECK_EQUAL( 1000, phases.load() );
+}
+
+void test_barrier_mt_destroy() {
+    // the last fiber leaving the barrier destroys it
+    for ( int i = 0; i < 1000; ++i) {
+        boost::fibers::barrier * b = new boost::fibers::barrier( 2);
+        std::atomic< int > left{ 0 };
+        auto fn = [b,&left](){
+            boost::fibers::fiber( boost::fibers::launch::dispatch, [b,&left](){
+                b->arrive_and_wait();
+                if ( 1 == left.fetch_add( 1) ) {
+                    delete b;
+                }
+            }).join();
+        };
+        std::thread t1( fn);
+        std::thread t2( fn);
+        t1.join();
+        t2.join();
+    }
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: barrier test suite");
 
     test->add( BOOST_TEST_CASE( & test_barrier) );
+    test->add( BOOST_TEST_CASE( & test_barrier_completion) );
+    test->add( BOOST_TEST_CASE( & test_barrier_split_phase) );
+    test->add( BOOST_TEST_CASE( & test_barrier_arrive_and_drop) );
+    test->add( BOOST_TEST_CASE( & test_barrier_mt) );
+    test->add( BOOST_TEST_CASE( & test_barrier_mt_phases) );
+    test->add( BOOST_TEST_CASE( & test_barrier_mt_destroy) );
 
     return test;
 }
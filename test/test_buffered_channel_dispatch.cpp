@@ -4,9 +4,13 @@
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+#include <atomic>
 #include <chrono>
+#include <iterator>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/assert.hpp>
@@ -45,6 +49,55 @@ struct moveable {
     }
 };
 
+// copy construction throws if requested
+struct throwing {
+    int     value;
+    bool    fail;
+
+    throwing( int v, bool f = false) :
+        value( v),
+        fail( f) {
+    }
+
+    throwing( throwing const& other) :
+        value( other.value),
+        fail( other.fail) {
+        if ( fail) {
+            throw std::runtime_error("copy failed");
+        }
+    }
+
+    throwing & operator=( throwing const&) = default;
+};
+
+// output iterator appending to a vector, throws once limit elements have
+// been written
+struct throwing_inserter : public std::iterator< std::output_iterator_tag, void, void, void, void > {
+    std::vector< int >  *   out;
+    std::size_t             limit;
+
+    throwing_inserter( std::vector< int > & o, std::size_t l) :
+        out( & o),
+        limit( l) {
+    }
+
+    throwing_inserter & operator=( int v) {
+        if ( limit == out->size() ) {
+            throw std::runtime_error("insert failed");
+        }
+        out->push_back( v);
+        return * this;
+    }
+
+    throwing_inserter & operator*() {
+        return * this;
+    }
+
+    throwing_inserter & operator++() {
+        return * this;
+    }
+};
+
 void test_zero_wm() {
     bool thrown = false;
     try {
@@ -493,6 +546,188 @@ void test_rangefor() {
     BOOST_CHECK_EQUAL( 12, vec[6]);
 }
 
+void test_push_n_pop_n() {
+    boost::fibers::buffered_channel< int > chan{ 4 };
+    std::vector< int > in{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    std::vector< int > out;
+    std::size_t pushed = 0;
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&chan,&in,&pushed](){
+        // more elements than slots - blocks until the consumer made room
+        pushed = chan.push_n( in.begin(), in.end() );
+        chan.close();
+    });
+    int buffer[3];
+    std::size_t n = 0;
+    while ( 0 != ( n = chan.pop_n( buffer, 3) ) ) {
+        BOOST_CHECK( 3 >= n);
+        out.insert( out.end(), buffer, buffer + n);
+    }
+    f.join();
+    BOOST_CHECK_EQUAL( 10u, pushed);
+    BOOST_CHECK( in == out);
+}
+
+void test_push_n_closed() {
+    boost::fibers::buffered_channel< int > chan{ 4 };
+    std::vector< int > in{ 1, 2, 3, 4, 5, 6 };
+    std::size_t pushed = 0;
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&chan,&in,&pushed](){
+        pushed = chan.push_n( in.begin(), in.end() );
+    });
+    boost::this_fiber::yield();
+    chan.close();
+    f.join();
+    // the channel was full after four elements
+    BOOST_CHECK_EQUAL( 4u, pushed);
+    // elements pushed before close() can be popped
+    std::vector< int > out;
+    BOOST_CHECK_EQUAL( 4u, chan.pop_n( std::back_inserter( out), 16) );
+    BOOST_CHECK_EQUAL( 0u, chan.pop_n( std::back_inserter( out), 16) );
+    BOOST_CHECK_EQUAL( 4u, out.size() );
+    BOOST_CHECK_EQUAL( 0u, chan.push_n( in.begin(), in.end() ) );
+}
+
+void test_push_n_pop_n_moveable() {
+    boost::fibers::buffered_channel< std::string > chan{ 8 };
+    std::vector< std::string > in{ "abc", "def", "ghi" };
+    BOOST_CHECK_EQUAL( 3u, chan.push_n(
+            std::make_move_iterator( in.begin() ), std::make_move_iterator( in.end() ) ) );
+    std::vector< std::string > out;
+    BOOST_CHECK_EQUAL( 3u, chan.pop_n( std::back_inserter( out), 8) );
+    BOOST_CHECK( "abc" == out[0]);
+    BOOST_CHECK( "def" == out[1]);
+    BOOST_CHECK( "ghi" == out[2]);
+}
+
+void test_push_n_throws() {
+    boost::fibers::buffered_channel< throwing > chan{ 8 };
+    std::vector< throwing > in{ throwing{ 1 }, throwing{ 2 }, throwing{ 3, true }, throwing{ 4 }, throwing{ 5 } };
+    bool thrown = false;
+    try {
+        chan.push_n( in.begin(), in.end() );
+    } catch ( std::runtime_error const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+    // the elements copied before the exception can be popped, the rest of
+    // the claimed slots is stepped over
+    std::vector< throwing > out;
+    BOOST_CHECK_EQUAL( 2u, chan.pop_n( std::back_inserter( out), 8) );
+    BOOST_CHECK_EQUAL( 1, out[0].value);
+    BOOST_CHECK_EQUAL( 2, out[1].value);
+    throwing t{ 0 };
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == chan.try_pop( t) );
+    // all slots are usable again
+    std::vector< throwing > in2;
+    for ( int i = 0; i < 8; ++i) {
+        in2.push_back( throwing{ i });
+    }
+    BOOST_CHECK_EQUAL( 8u, chan.push_n( in2.begin(), in2.end() ) );
+    out.clear();
+    BOOST_CHECK_EQUAL( 8u, chan.pop_n( std::back_inserter( out), 8) );
+    BOOST_CHECK_EQUAL( 7, out[7].value);
+}
+
+void test_pop_n_throws() {
+    boost::fibers::buffered_channel< int > chan{ 8 };
+    std::vector< int > in{ 1, 2, 3, 4, 5, 6 };
+    BOOST_CHECK_EQUAL( 6u, chan.push_n( in.begin(), in.end() ) );
+    std::vector< int > out;
+    bool thrown = false;
+    try {
+        chan.pop_n( throwing_inserter( out, 2), 8);
+    } catch ( std::runtime_error const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+    BOOST_CHECK_EQUAL( 2u, out.size() );
+    // the values of the claimed run which were not written are discarded
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == chan.try_pop( v) );
+    // all slots are usable again
+    std::vector< int > in2{ 1, 2, 3, 4, 5, 6, 7, 8 };
+    BOOST_CHECK_EQUAL( 8u, chan.push_n( in2.begin(), in2.end() ) );
+    out.clear();
+    BOOST_CHECK_EQUAL( 8u, chan.pop_n( std::back_inserter( out), 8) );
+    BOOST_CHECK( in2 == out);
+}
+
+void test_push_n_pop_n_mt() {
+    boost::fibers::buffered_channel< int > chan{ 64 };
+    std::atomic< long > sum{ 0 };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i) {
+        threads.emplace_back( [&chan](){
+            boost::fibers::fiber( boost::fibers::launch::dispatch, [&chan](){
+                std::vector< int > batch( 50);
+                for ( int j = 0; j < 200; ++j) {
+                    for ( int k = 0; k < 50; ++k) {
+                        batch[k] = j * 50 + k + 1;
+                    }
+                    chan.push_n( batch.begin(), batch.end() );
+                }
+            }).join();
+        });
+        threads.emplace_back( [&chan,&sum](){
+            boost::fibers::fiber( boost::fibers::launch::dispatch, [&chan,&sum](){
+                int buffer[32];
+                std::size_t n = 0;
+                while ( 0 != ( n = chan.pop_n( buffer, 32) ) ) {
+                    for ( std::size_t k = 0; k < n; ++k) {
+                        sum += buffer[k];
+                    }
+                }
+            }).join();
+        });
+    }
+    for ( std::size_t i = 0; i < threads.size(); i += 2) {
+        threads[i].join();
+    }
+    chan.close();
+    for ( std::size_t i = 1; i < threads.size(); i += 2) {
+        threads[i].join();
+    }
+    BOOST_CHECK_EQUAL( 4 * 50005000L, sum.load() );
+}
+
+template< typename Spinlock >
+void do_test_spinlock_policy() {
+    boost::fibers::buffered_channel< int, Spinlock > chan{ 16 };
+    std::atomic< int > sum{ 0 };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i) {
+        threads.emplace_back( [&chan](){
+            boost::fibers::fiber( boost::fibers::launch::dispatch, [&chan](){
+                for ( int j = 1; j <= 1000; ++j) {
+                    chan.push( j);
+                }
+            }).join();
+        });
+        threads.emplace_back( [&chan,&sum](){
+            boost::fibers::fiber( boost::fibers::launch::dispatch, [&chan,&sum](){
+                int value = 0;
+                while ( boost::fibers::channel_op_status::success == chan.pop( value) ) {
+                    sum += value;
+                }
+            }).join();
+        });
+    }
+    for ( std::size_t i = 0; i < threads.size(); i += 2) {
+        threads[i].join();
+    }
+    chan.close();
+    for ( std::size_t i = 1; i < threads.size(); i += 2) {
+        threads[i].join();
+    }
+    BOOST_CHECK_EQUAL( 4 * 500500, sum.load() );
+}
+
+void test_spinlock_policy() {
+    do_test_spinlock_policy< boost::fibers::spinlock_policy::library_default >();
+    do_test_spinlock_policy< boost::fibers::spinlock_policy::mcs >();
+    do_test_spinlock_policy< boost::fibers::spinlock_policy::std_mutex >();
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: buffered_channel test suite");
@@ -530,6 +765,13 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
      test->add( BOOST_TEST_CASE( & test_wm_2) );
      test->add( BOOST_TEST_CASE( & test_moveable) );
      test->add( BOOST_TEST_CASE( & test_rangefor) );
+     test->add( BOOST_TEST_CASE( & test_push_n_pop_n) );
+     test->add( BOOST_TEST_CASE( & test_push_n_closed) );
+     test->add( BOOST_TEST_CASE( & test_push_n_pop_n_moveable) );
+     test->add( BOOST_TEST_CASE( & test_push_n_throws) );
+     test->add( BOOST_TEST_CASE( & test_pop_n_throws) );
+     test->add( BOOST_TEST_CASE( & test_push_n_pop_n_mt) );
+     test->add( BOOST_TEST_CASE( & test_spinlock_policy) );
 
     return test;
 }
@@ -477,6 +477,71 @@ void test_condition_wait_for_pred() {
     do_test_condition_wait_for_pred();
 }
 
+void do_test_notify_all_under_lock() {
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cond;
+    bool ready = false;
+    std::vector< int > order;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 3; ++i) {
+        fibers.emplace_back( boost::fibers::launch::dispatch, [&mtx,&cond,&ready,&order,i](){
+            std::unique_lock< boost::fibers::mutex > lk( mtx);
+            cond.wait( lk, [&ready](){ return ready; });
+            BOOST_CHECK( lk.owns_lock() );
+            order.push_back( i);
+        });
+    }
+    boost::this_fiber::yield();
+    {
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        ready = true;
+        // the waiters are moved to the mutex and get the lock one after
+        // another after it was released
+        cond.notify_all();
+        boost::this_fiber::yield();
+        BOOST_CHECK( order.empty() );
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_REQUIRE_EQUAL( 3u, order.size() );
+    BOOST_CHECK_EQUAL( 0, order[0]);
+    BOOST_CHECK_EQUAL( 1, order[1]);
+    BOOST_CHECK_EQUAL( 2, order[2]);
+}
+
+void test_notify_all_under_lock() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_notify_all_under_lock).join();
+}
+
+void do_test_notified_wait_for_timeout() {
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cond;
+    boost::fibers::cv_status status = boost::fibers::cv_status::timeout;
+    bool owns = false;
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&mtx,&cond,&status,&owns](){
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        status = cond.wait_for( lk, ms( 10) );
+        owns = lk.owns_lock();
+    });
+    boost::this_fiber::yield();
+    {
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        cond.notify_one();
+        // keep the lock beyond the timeout of the notified waiter
+        boost::this_fiber::sleep_for( ms( 50) );
+    }
+    f.join();
+    BOOST_CHECK( boost::fibers::cv_status::no_timeout == status);
+    BOOST_CHECK( owns);
+    BOOST_CHECK( mtx.try_lock() );
+    mtx.unlock();
+}
+
+void test_notified_wait_for_timeout() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_notified_wait_for_timeout).join();
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
 {
     boost::unit_test::test_suite * test =
@@ -490,6 +555,8 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
     test->add( BOOST_TEST_CASE( & test_condition_wait_until_pred) );
     test->add( BOOST_TEST_CASE( & test_condition_wait_for) );
     test->add( BOOST_TEST_CASE( & test_condition_wait_for_pred) );
+    test->add( BOOST_TEST_CASE( & test_notify_all_under_lock) );
+    test->add( BOOST_TEST_CASE( & test_notified_wait_for_timeout) );
 
 	return test;
 }
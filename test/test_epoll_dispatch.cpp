@@ -0,0 +1,261 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::chrono::milliseconds ms;
+
+template< typename Fn >
+void run_epoll( Fn && fn) {
+    std::thread t( [&fn](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::epoll >();
+        fn();
+    });
+    t.join();
+}
+
+void set_nonblocking( int fd) {
+    ::fcntl( fd, F_SETFL, ::fcntl( fd, F_GETFL) | O_NONBLOCK);
+}
+
+std::string read_some( int fd) {
+    char buf[64];
+    for (;;) {
+        ssize_t n = ::read( fd, buf, sizeof( buf) );
+        if ( 0 <= n) {
+            return std::string( buf, n);
+        }
+        BOOST_REQUIRE( EAGAIN == errno || EWOULDBLOCK == errno);
+        boost::this_fiber::wait_readable( fd);
+    }
+}
+
+void test_pipe_readable() {
+    run_epoll([](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::pipe( fds) );
+        set_nonblocking( fds[0]);
+        std::string result;
+        boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&](){
+            result = read_some( fds[0]);
+        });
+        boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&](){
+            boost::this_fiber::sleep_for( ms( 10) );
+            BOOST_REQUIRE( 5 == ::write( fds[1], "hello", 5) );
+        });
+        f1.join();
+        f2.join();
+        BOOST_CHECK_EQUAL( std::string( "hello"), result);
+        ::close( fds[0]);
+        ::close( fds[1]);
+    });
+}
+
+void test_pipe_hangup() {
+    run_epoll([](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::pipe( fds) );
+        set_nonblocking( fds[0]);
+        std::string result( "x");
+        boost::fibers::fiber f( boost::fibers::launch::dispatch, [&](){
+            result = read_some( fds[0]);
+        });
+        // wakes the reader blocked in epoll_wait() from another thread
+        std::thread t( [&fds](){
+            std::this_thread::sleep_for( ms( 20) );
+            ::close( fds[1]);
+        });
+        f.join();
+        t.join();
+        BOOST_CHECK( result.empty() );
+        ::close( fds[0]);
+    });
+}
+
+void test_socketpair_ping_pong() {
+    run_epoll([](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+        set_nonblocking( fds[0]);
+        set_nonblocking( fds[1]);
+        int count = 0;
+        boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&](){
+            for ( int i = 0; i < 100; ++i) {
+                BOOST_REQUIRE( 1 == ::write( fds[0], "a", 1) );
+                BOOST_REQUIRE( std::string( "b") == read_some( fds[0]) );
+                ++count;
+            }
+        });
+        boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&](){
+            for ( int i = 0; i < 100; ++i) {
+                BOOST_REQUIRE( std::string( "a") == read_some( fds[1]) );
+                BOOST_REQUIRE( 1 == ::write( fds[1], "b", 1) );
+            }
+        });
+        f1.join();
+        f2.join();
+        BOOST_CHECK_EQUAL( 100, count);
+        ::close( fds[0]);
+        ::close( fds[1]);
+    });
+}
+
+void test_socketpair_writable() {
+    run_epoll([](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+        set_nonblocking( fds[0]);
+        set_nonblocking( fds[1]);
+        char buf[4096];
+        std::memset( buf, 'x', sizeof( buf) );
+        // fill the socket buffer
+        while ( 0 < ::write( fds[0], buf, sizeof( buf) ) ) {
+        }
+        BOOST_REQUIRE( EAGAIN == errno || EWOULDBLOCK == errno);
+        bool written = false;
+        boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&](){
+            boost::this_fiber::wait_writable( fds[0]);
+            written = 0 < ::write( fds[0], buf, 1);
+        });
+        boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&](){
+            boost::this_fiber::sleep_for( ms( 10) );
+            BOOST_CHECK( ! written);
+            while ( 0 < ::read( fds[1], buf, sizeof( buf) ) ) {
+            }
+        });
+        f1.join();
+        f2.join();
+        BOOST_CHECK( written);
+        ::close( fds[0]);
+        ::close( fds[1]);
+    });
+}
+
+void test_read_and_write_same_fd() {
+    run_epoll([](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds) );
+        set_nonblocking( fds[0]);
+        set_nonblocking( fds[1]);
+        bool readable = false, writable = false;
+        // reader and writer on the same descriptor; the writer is woken
+        // first, the reader must stay registered
+        boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&](){
+            boost::this_fiber::wait_readable( fds[0]);
+            readable = true;
+        });
+        boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&](){
+            boost::this_fiber::wait_writable( fds[0]);
+            writable = true;
+        });
+        f2.join();
+        BOOST_CHECK( writable);
+        BOOST_CHECK( ! readable);
+        BOOST_REQUIRE( 1 == ::write( fds[1], "z", 1) );
+        f1.join();
+        BOOST_CHECK( readable);
+        ::close( fds[0]);
+        ::close( fds[1]);
+    });
+}
+
+void test_sleep_and_remote_wakeup() {
+    run_epoll([](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::pipe( fds) );
+        set_nonblocking( fds[0]);
+        boost::fibers::promise< int > p;
+        boost::fibers::future< int > fu = p.get_future();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&](){
+            // never readable - must not prevent the others from running
+            boost::this_fiber::wait_readable( fds[0]);
+        });
+        boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&](){
+            boost::this_fiber::sleep_for( ms( 20) );
+        });
+        std::thread t( [&p](){
+            std::this_thread::sleep_for( ms( 40) );
+            p.set_value( 7);
+        });
+        f2.join();
+        BOOST_CHECK( std::chrono::steady_clock::now() - start >= ms( 20) );
+        BOOST_CHECK_EQUAL( 7, fu.get() );
+        t.join();
+        BOOST_REQUIRE( 1 == ::write( fds[1], "q", 1) );
+        f1.join();
+        ::close( fds[0]);
+        ::close( fds[1]);
+    });
+}
+
+void test_busy() {
+    run_epoll([](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::pipe( fds) );
+        boost::fibers::fiber f( boost::fibers::launch::dispatch, [&](){
+            boost::this_fiber::wait_readable( fds[0]);
+        });
+        boost::this_fiber::yield();
+        bool thrown = false;
+        try {
+            boost::this_fiber::wait_readable( fds[0]);
+        } catch ( boost::fibers::fiber_error const& e) {
+            thrown = e.code() == std::errc::device_or_resource_busy;
+        }
+        BOOST_CHECK( thrown);
+        BOOST_REQUIRE( 1 == ::write( fds[1], "q", 1) );
+        f.join();
+        ::close( fds[0]);
+        ::close( fds[1]);
+    });
+}
+
+void test_not_supported() {
+    std::thread t([](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::pipe( fds) );
+        bool thrown = false;
+        try {
+            boost::this_fiber::wait_readable( fds[0]);
+        } catch ( boost::fibers::fiber_error const& e) {
+            thrown = e.code() == std::errc::operation_not_supported;
+        }
+        BOOST_CHECK( thrown);
+        ::close( fds[0]);
+        ::close( fds[1]);
+    });
+    t.join();
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: epoll test suite");
+
+    test->add( BOOST_TEST_CASE( & test_pipe_readable) );
+    test->add( BOOST_TEST_CASE( & test_pipe_hangup) );
+    test->add( BOOST_TEST_CASE( & test_socketpair_ping_pong) );
+    test->add( BOOST_TEST_CASE( & test_socketpair_writable) );
+    test->add( BOOST_TEST_CASE( & test_read_and_write_same_fd) );
+    test->add( BOOST_TEST_CASE( & test_sleep_and_remote_wakeup) );
+    test->add( BOOST_TEST_CASE( & test_busy) );
+    test->add( BOOST_TEST_CASE( & test_not_supported) );
+
+    return test;
+}
@@ -0,0 +1,153 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+// waits until counter is positive and decrements it
+void take( boost::fibers::eventcount & ec, std::atomic< int > & counter) {
+    for (;;) {
+        int value = counter.load();
+        while ( 0 < value) {
+            if ( counter.compare_exchange_weak( value, value - 1) ) {
+                return;
+            }
+        }
+        boost::fibers::eventcount::key k = ec.prepare_wait();
+        if ( 0 < counter.load() ) {
+            ec.cancel_wait();
+            continue;
+        }
+        ec.commit_wait( k);
+    }
+}
+
+void test_no_waiter() {
+    boost::fibers::eventcount ec;
+    ec.notify_one();
+    ec.notify_all();
+    // a notification between prepare_wait() and commit_wait() is not lost
+    boost::fibers::eventcount::key k = ec.prepare_wait();
+    ec.notify_one();
+    ec.commit_wait( k);
+    k = ec.prepare_wait();
+    ec.cancel_wait();
+}
+
+void do_test_notify_one() {
+    boost::fibers::eventcount ec;
+    std::atomic< int > counter{ 0 };
+    int taken = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 3; ++i) {
+        fibers.emplace_back( boost::fibers::launch::dispatch, [&ec,&counter,&taken](){
+            take( ec, counter);
+            ++taken;
+        });
+    }
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 0, taken);
+    for ( int i = 0; i < 3; ++i) {
+        ++counter;
+        ec.notify_one();
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 3, taken);
+    BOOST_CHECK_EQUAL( 0, counter.load() );
+}
+
+void test_notify_one() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_notify_one).join();
+}
+
+void test_notify_all() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, [](){
+        boost::fibers::eventcount ec;
+        std::atomic< bool > flag{ false };
+        int woken = 0;
+        std::vector< boost::fibers::fiber > fibers;
+        for ( int i = 0; i < 5; ++i) {
+            fibers.emplace_back( boost::fibers::launch::dispatch, [&ec,&flag,&woken](){
+                while ( ! flag.load() ) {
+                    boost::fibers::eventcount::key k = ec.prepare_wait();
+                    if ( flag.load() ) {
+                        ec.cancel_wait();
+                        break;
+                    }
+                    ec.commit_wait( k);
+                }
+                ++woken;
+            });
+        }
+        boost::this_fiber::yield();
+        flag = true;
+        ec.notify_all();
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+        BOOST_CHECK_EQUAL( 5, woken);
+    }).join();
+}
+
+void test_thread_producer() {
+    // producers are plain threads, consumers are fibers of other threads
+    boost::fibers::eventcount ec;
+    std::atomic< int > counter{ 0 };
+    std::atomic< int > taken{ 0 };
+    std::vector< std::thread > consumers;
+    for ( int i = 0; i < 3; ++i) {
+        consumers.emplace_back( [&ec,&counter,&taken](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int j = 0; j < 2; ++j) {
+                fibers.emplace_back( boost::fibers::launch::dispatch, [&ec,&counter,&taken](){
+                    for ( int k = 0; k < 1000; ++k) {
+                        take( ec, counter);
+                        ++taken;
+                    }
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    std::vector< std::thread > producers;
+    for ( int i = 0; i < 2; ++i) {
+        producers.emplace_back( [&ec,&counter](){
+            for ( int k = 0; k < 3000; ++k) {
+                ++counter;
+                ec.notify_one();
+            }
+        });
+    }
+    for ( std::thread & t : producers) {
+        t.join();
+    }
+    for ( std::thread & t : consumers) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( 6000, taken.load() );
+    BOOST_CHECK_EQUAL( 0, counter.load() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: eventcount test suite");
+
+    test->add( BOOST_TEST_CASE( & test_no_waiter) );
+    test->add( BOOST_TEST_CASE( & test_notify_one) );
+    test->add( BOOST_TEST_CASE( & test_notify_all) );
+    test->add( BOOST_TEST_CASE( & test_thread_producer) );
+
+	return test;
+}
@@ -0,0 +1,207 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+#include <boost/fiber/algo/io_uring.hpp>
+
+template< typename Fn >
+void run_io_uring( unsigned int entries, Fn && fn) {
+    std::thread t( [entries,&fn](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::io_uring >( entries);
+        BOOST_REQUIRE( nullptr != boost::fibers::algo::io_uring::instance() );
+        if ( 0 == entries) {
+            BOOST_CHECK( ! boost::fibers::algo::io_uring::instance()->has_ring() );
+        }
+        fn();
+    });
+    t.join();
+}
+
+int temp_file() {
+    char path[] = "/tmp/boost_fiber_io_uringXXXXXX";
+    int fd = ::mkstemp( path);
+    BOOST_REQUIRE( -1 != fd);
+    ::unlink( path);
+    return fd;
+}
+
+void set_nonblocking( int fd) {
+    ::fcntl( fd, F_SETFL, ::fcntl( fd, F_GETFL) | O_NONBLOCK);
+}
+
+void do_test_file( unsigned int entries) {
+    run_io_uring( entries, [](){
+        int fd = temp_file();
+        std::vector< boost::fibers::fiber > fibers;
+        // more fibers than submission queue entries in the small ring
+        for ( int i = 0; i < 32; ++i) {
+            fibers.emplace_back( boost::fibers::launch::dispatch, [fd,i](){
+                char buf[16];
+                std::snprintf( buf, sizeof( buf), "block-%09d", i);
+                BOOST_CHECK_EQUAL( 16, boost::fibers::io::pwrite( fd, buf, 16, i * 16) );
+            });
+        }
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+        fibers.clear();
+        BOOST_CHECK_EQUAL( 0, boost::fibers::io::fsync( fd) );
+        BOOST_CHECK_EQUAL( 0, boost::fibers::io::fdatasync( fd) );
+        for ( int i = 0; i < 32; ++i) {
+            fibers.emplace_back( boost::fibers::launch::dispatch, [fd,i](){
+                char buf[16], expected[16];
+                std::snprintf( expected, sizeof( expected), "block-%09d", i);
+                BOOST_CHECK_EQUAL( 16, boost::fibers::io::pread( fd, buf, 16, i * 16) );
+                BOOST_CHECK( 0 == std::memcmp( buf, expected, 16) );
+            });
+        }
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+        // file position based read/write
+        BOOST_REQUIRE( 0 == ::lseek( fd, 0, SEEK_SET) );
+        char buf[16];
+        BOOST_CHECK_EQUAL( 16, boost::fibers::io::read( fd, buf, 16) );
+        BOOST_CHECK( 0 == std::memcmp( buf, "block-000000000", 16) );
+        BOOST_CHECK_EQUAL( 16, boost::fibers::io::read( fd, buf, 16) );
+        BOOST_CHECK( 0 == std::memcmp( buf, "block-000000001", 16) );
+        ::close( fd);
+    });
+}
+
+void do_test_loopback( unsigned int entries) {
+    run_io_uring( entries, [](){
+        int lfd = ::socket( AF_INET, SOCK_STREAM, 0);
+        BOOST_REQUIRE( -1 != lfd);
+        ::sockaddr_in addr;
+        std::memset( & addr, 0, sizeof( addr) );
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        BOOST_REQUIRE( 0 == ::bind( lfd, reinterpret_cast< ::sockaddr * >( & addr), sizeof( addr) ) );
+        BOOST_REQUIRE( 0 == ::listen( lfd, 8) );
+        ::socklen_t len = sizeof( addr);
+        BOOST_REQUIRE( 0 == ::getsockname( lfd, reinterpret_cast< ::sockaddr * >( & addr), & len) );
+        // required by the readiness based fallback
+        set_nonblocking( lfd);
+        std::string received;
+        boost::fibers::fiber server( boost::fibers::launch::dispatch, [&](){
+            int cfd = boost::fibers::io::accept( lfd, nullptr, nullptr, SOCK_NONBLOCK);
+            BOOST_REQUIRE( -1 != cfd);
+            char buf[64];
+            for (;;) {
+                ::ssize_t n = boost::fibers::io::read( cfd, buf, sizeof( buf) );
+                BOOST_REQUIRE( 0 <= n);
+                if ( 0 == n) {
+                    break;
+                }
+                received.append( buf, n);
+                BOOST_CHECK_EQUAL( n, boost::fibers::io::write( cfd, buf, n) );
+            }
+            ::close( cfd);
+        });
+        std::string echoed;
+        boost::fibers::fiber client( boost::fibers::launch::dispatch, [&](){
+            boost::this_fiber::sleep_for( std::chrono::milliseconds( 10) );
+            int fd = ::socket( AF_INET, SOCK_STREAM, 0);
+            BOOST_REQUIRE( -1 != fd);
+            BOOST_REQUIRE( 0 == ::connect( fd, reinterpret_cast< ::sockaddr * >( & addr), sizeof( addr) ) );
+            set_nonblocking( fd);
+            for ( int i = 0; i < 10; ++i) {
+                std::string msg = "message " + std::to_string( i);
+                BOOST_REQUIRE( static_cast< ::ssize_t >( msg.size() ) ==
+                        boost::fibers::io::write( fd, msg.data(), msg.size() ) );
+                char buf[64];
+                std::size_t got = 0;
+                while ( got < msg.size() ) {
+                    ::ssize_t n = boost::fibers::io::read( fd, buf + got, msg.size() - got);
+                    BOOST_REQUIRE( 0 < n);
+                    got += n;
+                }
+                echoed.append( buf, got);
+            }
+            ::close( fd);
+        });
+        client.join();
+        server.join();
+        ::close( lfd);
+        BOOST_CHECK_EQUAL( received, echoed);
+        BOOST_CHECK_EQUAL( std::string( "message 0"), echoed.substr( 0, 9) );
+    });
+}
+
+void do_test_errors( unsigned int entries) {
+    run_io_uring( entries, [](){
+        char buf[4];
+        BOOST_CHECK_EQUAL( -1, boost::fibers::io::pread( -1, buf, sizeof( buf), 0) );
+        BOOST_CHECK_EQUAL( EBADF, errno);
+        BOOST_CHECK_EQUAL( -1, boost::fibers::io::fsync( -1) );
+        BOOST_CHECK_EQUAL( EBADF, errno);
+    });
+}
+
+void test_file() {
+    do_test_file( 8);
+}
+
+void test_file_fallback() {
+    do_test_file( 0);
+}
+
+void test_loopback() {
+    do_test_loopback( 8);
+}
+
+void test_loopback_fallback() {
+    do_test_loopback( 0);
+}
+
+void test_errors() {
+    do_test_errors( 8);
+    do_test_errors( 0);
+}
+
+void test_without_io_uring() {
+    // the default scheduler executes the plain syscalls
+    int fd = temp_file();
+    boost::fibers::fiber( boost::fibers::launch::dispatch, [fd](){
+        BOOST_CHECK_EQUAL( 4, boost::fibers::io::pwrite( fd, "abcd", 4, 0) );
+        char buf[4];
+        BOOST_CHECK_EQUAL( 4, boost::fibers::io::pread( fd, buf, 4, 0) );
+        BOOST_CHECK( 0 == std::memcmp( buf, "abcd", 4) );
+    }).join();
+    ::close( fd);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: io_uring test suite");
+
+    test->add( BOOST_TEST_CASE( & test_file) );
+    test->add( BOOST_TEST_CASE( & test_file_fallback) );
+    test->add( BOOST_TEST_CASE( & test_loopback) );
+    test->add( BOOST_TEST_CASE( & test_loopback_fallback) );
+    test->add( BOOST_TEST_CASE( & test_errors) );
+    test->add( BOOST_TEST_CASE( & test_without_io_uring) );
+
+    return test;
+}
@@ -0,0 +1,126 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void test_latch_count() {
+    boost::fibers::latch l( 2);
+    BOOST_CHECK( ! l.try_wait() );
+    l.count_down();
+    BOOST_CHECK( ! l.try_wait() );
+    l.count_down();
+    BOOST_CHECK( l.try_wait() );
+    // does not block
+    l.wait();
+    boost::fibers::latch l0( 0);
+    BOOST_CHECK( l0.try_wait() );
+    bool thrown = false;
+    try {
+        boost::fibers::latch l1( -1);
+    } catch ( boost::fibers::fiber_error const& e) {
+        thrown = std::make_error_code( std::errc::invalid_argument) == e.code();
+    }
+    BOOST_CHECK( thrown);
+}
+
+void do_test_latch_fan_in() {
+    boost::fibers::latch l( 5);
+    int done = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 5; ++i) {
+        fibers.emplace_back( boost::fibers::launch::dispatch, [&l,&done](){
+            boost::this_fiber::yield();
+            ++done;
+            l.count_down();
+        });
+    }
+    l.wait();
+    BOOST_CHECK_EQUAL( 5, done);
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+}
+
+void test_latch_fan_in() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_latch_fan_in).join();
+}
+
+void do_test_latch_arrive_and_wait() {
+    boost::fibers::latch l( 4);
+    int arrived = 0;
+    bool failed = false;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 3; ++i) {
+        fibers.emplace_back( boost::fibers::launch::dispatch, [&l,&arrived,&failed](){
+            ++arrived;
+            l.arrive_and_wait();
+            if ( 4 != arrived) {
+                failed = true;
+            }
+        });
+    }
+    boost::this_fiber::yield();
+    ++arrived;
+    // releases all fibers at once
+    l.arrive_and_wait();
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK( ! failed);
+}
+
+void test_latch_arrive_and_wait() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_latch_arrive_and_wait).join();
+}
+
+void test_latch_mt() {
+    for ( int k = 0; k < 100; ++k) {
+        // destroyed as soon as wait() returns
+        std::unique_ptr< boost::fibers::latch > l{ new boost::fibers::latch( 4 * 4) };
+        std::atomic< int > counted{ 0 };
+        std::vector< std::thread > threads;
+        for ( int i = 0; i < 4; ++i) {
+            threads.emplace_back( [&l,&counted](){
+                boost::fibers::latch * lp = l.get();
+                std::vector< boost::fibers::fiber > fibers;
+                for ( int i = 0; i < 4; ++i) {
+                    fibers.emplace_back( boost::fibers::launch::dispatch, [lp,&counted](){
+                        ++counted;
+                        lp->count_down();
+                    });
+                }
+                for ( boost::fibers::fiber & f : fibers) {
+                    f.join();
+                }
+            });
+        }
+        l->wait();
+        BOOST_CHECK_EQUAL( 16, counted.load() );
+        l.reset();
+        for ( std::thread & t : threads) {
+            t.join();
+        }
+    }
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: latch test suite");
+
+    test->add( BOOST_TEST_CASE( & test_latch_count) );
+    test->add( BOOST_TEST_CASE( & test_latch_fan_in) );
+    test->add( BOOST_TEST_CASE( & test_latch_arrive_and_wait) );
+    test->add( BOOST_TEST_CASE( & test_latch_mt) );
+
+	return test;
+}
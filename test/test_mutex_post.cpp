@@ -7,16 +7,19 @@
 // This test is based on the tests of Boost.Thread 
 
 #include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <iostream>
 #include <map>
 #include <mutex>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
 
 #include <boost/fiber/all.hpp>
+#include <boost/fiber/scheduler.hpp>
 
 typedef std::chrono::nanoseconds  ns;
 typedef std::chrono::milliseconds ms;
@@ -52,7 +55,7 @@ void fn3( boost::fibers::timed_mutex & m) {
 
 void fn4( boost::fibers::timed_mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while ( ! m.try_lock() );
+    while ( ! m.try_lock_and_yield() );
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     m.unlock();
     ns d = t1 - t0 - ms(250);
@@ -107,7 +110,7 @@ void fn9( boost::fibers::recursive_timed_mutex & m) {
 
 void fn10( boost::fibers::recursive_timed_mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while (!m.try_lock()) ;
+    while (!m.try_lock_and_yield()) ;
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     BOOST_CHECK(m.try_lock());
     m.unlock();
@@ -165,7 +168,7 @@ void fn15( boost::fibers::recursive_mutex & m) {
 
 void fn16( boost::fibers::recursive_mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while (!m.try_lock());
+    while (!m.try_lock_and_yield());
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     BOOST_CHECK(m.try_lock());
     m.unlock();
@@ -185,7 +188,7 @@ void fn17( boost::fibers::mutex & m) {
 
 void fn18( boost::fibers::mutex & m) {
     std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
-    while (!m.try_lock()) ;
+    while (!m.try_lock_and_yield()) ;
     std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
     m.unlock();
     ns d = t1 - t0 - ms(250);
@@ -434,6 +437,281 @@ void test_recursive_timed_mutex() {
     boost::fibers::fiber( boost::fibers::launch::post, & do_test_recursive_timed_mutex).join();
 }
 
+template< typename M >
+void do_test_try_lock_no_yield() {
+    M mtx;
+    bool other = false;
+    // posted - must not run before this fiber suspends
+    boost::fibers::fiber f( boost::fibers::launch::post, [&other](){ other = true; });
+    BOOST_CHECK( mtx.try_lock() );
+    BOOST_CHECK( ! other);
+    mtx.unlock();
+    BOOST_CHECK( mtx.try_lock_and_yield() );
+    BOOST_CHECK( other);
+    mtx.unlock();
+    f.join();
+}
+
+void test_try_lock_no_yield() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_try_lock_no_yield< boost::fibers::mutex >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_try_lock_no_yield< boost::fibers::timed_mutex >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_try_lock_no_yield< boost::fibers::recursive_mutex >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_try_lock_no_yield< boost::fibers::recursive_timed_mutex >).join();
+}
+
+void do_test_timed_mutex_waiter_timeout() {
+    boost::fibers::timed_mutex mtx;
+    mtx.lock();
+    bool locked = true;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&mtx,&locked](){
+        // parks in the wait-queue and leaves it on timeout
+        locked = mtx.try_lock_for( ms( 10) );
+    });
+    f.join();
+    BOOST_CHECK( ! locked);
+    // no waiters left - released and re-acquired without handing over
+    mtx.unlock();
+    BOOST_CHECK( mtx.try_lock_for( ms( 10) ) );
+    mtx.unlock();
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&mtx,&locked](){
+        locked = mtx.try_lock_for( ms( 500) );
+        if ( locked) {
+            mtx.unlock();
+        }
+    });
+    mtx.lock();
+    boost::this_fiber::sleep_for( ms( 10) );
+    mtx.unlock();
+    f2.join();
+    BOOST_CHECK( locked);
+}
+
+void test_timed_mutex_waiter_timeout() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_timed_mutex_waiter_timeout).join();
+}
+
+void do_test_barging_mutex() {
+    boost::fibers::mutex mtx{ boost::fibers::mutex_mode::barging };
+    int acquired = 0;
+    mtx.lock();
+    boost::fibers::fiber f( boost::fibers::launch::post, [&mtx,&acquired](){
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        ++acquired;
+    });
+    boost::this_fiber::yield();
+    // the waiter is woken but not handed the lock
+    mtx.unlock();
+    BOOST_CHECK( mtx.try_lock() );
+    BOOST_CHECK_EQUAL( 0, acquired);
+    mtx.unlock();
+    f.join();
+    BOOST_CHECK_EQUAL( 1, acquired);
+}
+
+void test_barging_mutex() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_barging_mutex).join();
+}
+
+void do_test_barging_mutex_starvation() {
+    boost::fibers::mutex mtx{ boost::fibers::mutex_mode::barging };
+    bool acquired = false;
+    mtx.lock();
+    boost::fibers::fiber f( boost::fibers::launch::post, [&mtx,&acquired](){
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        acquired = true;
+    });
+    // re-acquires the lock before the woken waiter runs; the waiter
+    // exceeds the starvation threshold and gets the lock handed over
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + ms( 2000);
+    while ( ! acquired && std::chrono::steady_clock::now() < end) {
+        boost::this_fiber::yield();
+        mtx.unlock();
+        mtx.lock();
+    }
+    mtx.unlock();
+    f.join();
+    BOOST_CHECK( acquired);
+}
+
+void test_barging_mutex_starvation() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_barging_mutex_starvation).join();
+}
+
+void test_barging_mutex_mt() {
+    boost::fibers::mutex mtx{ boost::fibers::mutex_mode::barging };
+    int counter = 0;
+    auto worker = [&mtx,&counter](){
+        std::vector< boost::fibers::fiber > fibers;
+        for ( int i = 0; i < 4; ++i) {
+            fibers.emplace_back( boost::fibers::launch::post, [&mtx,&counter](){
+                for ( int j = 0; j < 2000; ++j) {
+                    std::unique_lock< boost::fibers::mutex > lk( mtx);
+                    ++counter;
+                    if ( 0 == j % 64) {
+                        boost::this_fiber::yield();
+                    }
+                }
+            });
+        }
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+    };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i) {
+        threads.emplace_back( worker);
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( 4 * 4 * 2000, counter);
+}
+
+struct inherit_props : public boost::fibers::fiber_properties {
+    inherit_props( boost::fibers::context * ctx) :
+        fiber_properties( ctx) {
+    }
+};
+
+boost::fibers::context * contended_owner = nullptr;
+boost::fibers::context * contended_waiter = nullptr;
+int contended_count = 0;
+boost::fibers::context * released_owner = nullptr;
+int released_count = 0;
+
+class inherit_algo : public boost::fibers::algo::algorithm_with_properties< inherit_props > {
+private:
+    typedef boost::fibers::scheduler::ready_queue_t rqueue_t;
+
+    rqueue_t                    rqueue_{};
+    std::mutex                  mtx_{};
+    std::condition_variable     cnd_{};
+    bool                        flag_{ false };
+
+public:
+    void awakened( boost::fibers::context * ctx, inherit_props &) noexcept {
+        ctx->ready_link( rqueue_);
+    }
+
+    boost::fibers::context * pick_next() noexcept {
+        boost::fibers::context * ctx( nullptr);
+        if ( ! rqueue_.empty() ) {
+            ctx = & rqueue_.front();
+            rqueue_.pop_front();
+        }
+        return ctx;
+    }
+
+    bool has_ready_fibers() const noexcept {
+        return ! rqueue_.empty();
+    }
+
+    void suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+        std::unique_lock< std::mutex > lk( mtx_);
+        cnd_.wait_until( lk, time_point, [this](){ return flag_; });
+        flag_ = false;
+    }
+
+    void notify() noexcept {
+        std::unique_lock< std::mutex > lk( mtx_);
+        flag_ = true;
+        lk.unlock();
+        cnd_.notify_all();
+    }
+
+    bool lock_contended( boost::fibers::context * owner, inherit_props &,
+                         boost::fibers::context * waiter, inherit_props &) noexcept {
+        contended_owner = owner;
+        contended_waiter = waiter;
+        ++contended_count;
+        return true;
+    }
+
+    void lock_released( boost::fibers::context * owner, inherit_props &) noexcept {
+        released_owner = owner;
+        ++released_count;
+    }
+};
+
+template< typename M >
+void do_test_priority_hooks() {
+    boost::fibers::use_scheduling_algorithm< inherit_algo >();
+    contended_owner = nullptr;
+    contended_waiter = nullptr;
+    contended_count = 0;
+    released_owner = nullptr;
+    released_count = 0;
+    M mtx;
+    boost::fibers::context * owner = nullptr;
+    boost::fibers::context * waiter = nullptr;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&mtx,&owner](){
+                owner = boost::fibers::context::active();
+                std::unique_lock< M > lk( mtx);
+                // uncontended lock/unlock does not call the hooks
+                lk.unlock();
+                lk.lock();
+                for ( int i = 0; i < 3; ++i) {
+                    boost::this_fiber::yield();
+                }
+            });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&mtx,&waiter](){
+                waiter = boost::fibers::context::active();
+                boost::this_fiber::yield();
+                std::unique_lock< M > lk( mtx);
+            });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 1, contended_count);
+    BOOST_CHECK( owner == contended_owner);
+    BOOST_CHECK( waiter == contended_waiter);
+    BOOST_CHECK_EQUAL( 1, released_count);
+    BOOST_CHECK( owner == released_owner);
+}
+
+template< typename M >
+void do_test_priority_hooks_timeout() {
+    boost::fibers::use_scheduling_algorithm< inherit_algo >();
+    contended_owner = nullptr;
+    contended_waiter = nullptr;
+    contended_count = 0;
+    released_owner = nullptr;
+    released_count = 0;
+    M mtx;
+    boost::fibers::context * owner = nullptr;
+    boost::fibers::context * waiter = nullptr;
+    int released_while_locked = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&mtx,&owner,&released_while_locked](){
+                owner = boost::fibers::context::active();
+                std::unique_lock< M > lk( mtx);
+                boost::this_fiber::sleep_for( ms( 100) );
+                released_while_locked = released_count;
+            });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&mtx,&waiter](){
+                waiter = boost::fibers::context::active();
+                boost::this_fiber::yield();
+                BOOST_CHECK( ! mtx.try_lock_for( ms( 10) ) );
+            });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 1, contended_count);
+    BOOST_CHECK( owner == contended_owner);
+    BOOST_CHECK( waiter == contended_waiter);
+    // the owner dropped the priority inherited from the timed out waiter
+    BOOST_CHECK_EQUAL( 1, released_while_locked);
+    BOOST_CHECK( owner == released_owner);
+}
+
+void test_priority_hooks() {
+    // run in a separate thread: use_scheduling_algorithm() replaces the
+    // algorithm of the calling thread
+    std::thread( do_test_priority_hooks< boost::fibers::mutex >).join();
+    std::thread( do_test_priority_hooks< boost::fibers::timed_mutex >).join();
+    std::thread( do_test_priority_hooks< boost::fibers::recursive_mutex >).join();
+    std::thread( do_test_priority_hooks< boost::fibers::recursive_timed_mutex >).join();
+    std::thread( do_test_priority_hooks_timeout< boost::fibers::timed_mutex >).join();
+    std::thread( do_test_priority_hooks_timeout< boost::fibers::recursive_timed_mutex >).join();
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: mutex test suite");
@@ -442,6 +720,12 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     test->add( BOOST_TEST_CASE( & test_recursive_mutex) );
     test->add( BOOST_TEST_CASE( & test_timed_mutex) );
     test->add( BOOST_TEST_CASE( & test_recursive_timed_mutex) );
+    test->add( BOOST_TEST_CASE( & test_try_lock_no_yield) );
+    test->add( BOOST_TEST_CASE( & test_timed_mutex_waiter_timeout) );
+    test->add( BOOST_TEST_CASE( & test_barging_mutex) );
+    test->add( BOOST_TEST_CASE( & test_barging_mutex_starvation) );
+    test->add( BOOST_TEST_CASE( & test_barging_mutex_mt) );
+    test->add( BOOST_TEST_CASE( & test_priority_hooks) );
 
 	return test;
 }
@@ -0,0 +1,136 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::chrono::milliseconds ms;
+
+int add( int a, int b) {
+    return a + b;
+}
+
+void test_value() {
+    int result = 0;
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&result](){
+        result = boost::fibers::offload( add, 3, 4);
+    });
+    f.join();
+    BOOST_CHECK_EQUAL( 7, result);
+}
+
+void test_void_and_reference() {
+    int i = 0;
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&i](){
+        boost::fibers::offload( [&i](){ i = 5; });
+        int & r = boost::fibers::offload( [&i]() -> int & { return i; });
+        BOOST_CHECK_EQUAL( & i, & r);
+    });
+    f.join();
+    BOOST_CHECK_EQUAL( 5, i);
+}
+
+void test_move_only() {
+    std::unique_ptr< std::string > result;
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&result](){
+        std::unique_ptr< std::string > arg( new std::string( "abc") );
+        result = boost::fibers::offload(
+            []( std::unique_ptr< std::string > p){
+                * p += "def";
+                return p;
+            }, std::move( arg) );
+    });
+    f.join();
+    BOOST_REQUIRE( result);
+    BOOST_CHECK_EQUAL( std::string( "abcdef"), * result);
+}
+
+void test_exception() {
+    bool thrown = false;
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&thrown](){
+        try {
+            boost::fibers::offload( [](){ throw std::runtime_error( "abc"); });
+        } catch ( std::runtime_error const& e) {
+            thrown = std::string( "abc") == e.what();
+        }
+    });
+    f.join();
+    BOOST_CHECK( thrown);
+}
+
+void test_other_fibers_run() {
+    int ticks = 0;
+    bool done = false;
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&done](){
+        // a blocking call - would stall the thread without offload()
+        boost::fibers::offload( [](){ std::this_thread::sleep_for( ms( 50) ); });
+        done = true;
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&ticks,&done](){
+        while ( ! done) {
+            ++ticks;
+            boost::this_fiber::sleep_for( ms( 1) );
+        }
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK( 5 < ticks);
+}
+
+void test_many() {
+    std::atomic< int > count{ 0 };
+    std::vector< std::thread > threads;
+    for ( int t = 0; t < 4; ++t) {
+        threads.emplace_back( [&count](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int i = 0; i < 50; ++i) {
+                fibers.emplace_back( boost::fibers::launch::dispatch, [&count,i](){
+                    int r = boost::fibers::offload( [i](){
+                        std::this_thread::sleep_for( ms( 1) );
+                        return i;
+                    });
+                    BOOST_CHECK_EQUAL( i, r);
+                    ++count;
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( 200, count.load() );
+}
+
+void test_main_context() {
+    // the main fiber might offload too
+    BOOST_CHECK_EQUAL( 9, boost::fibers::offload( add, 4, 5) );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: offload test suite");
+
+    test->add( BOOST_TEST_CASE( & test_value) );
+    test->add( BOOST_TEST_CASE( & test_void_and_reference) );
+    test->add( BOOST_TEST_CASE( & test_move_only) );
+    test->add( BOOST_TEST_CASE( & test_exception) );
+    test->add( BOOST_TEST_CASE( & test_other_fibers_run) );
+    test->add( BOOST_TEST_CASE( & test_many) );
+    test->add( BOOST_TEST_CASE( & test_main_context) );
+
+    return test;
+}
@@ -0,0 +1,140 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void add( int & value, int n) {
+    value += n;
+}
+
+void do_test_call_once() {
+    boost::fibers::once_flag flag;
+    int value = 0;
+    boost::fibers::call_once( flag, add, std::ref( value), 3);
+    BOOST_CHECK_EQUAL( 3, value);
+    boost::fibers::call_once( flag, add, std::ref( value), 3);
+    BOOST_CHECK_EQUAL( 3, value);
+}
+
+void test_call_once() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_call_once).join();
+}
+
+void do_test_call_once_wait() {
+    boost::fibers::once_flag flag;
+    int calls = 0;
+    int initialized = 0;
+    int failed = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 5; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [&flag,&calls,&initialized,&failed](){
+            boost::fibers::call_once( flag, [&calls,&initialized](){
+                ++calls;
+                // the other fibers of this thread keep running and block
+                // on the flag
+                boost::this_fiber::yield();
+                boost::this_fiber::yield();
+                initialized = 42;
+            });
+            if ( 42 != initialized) {
+                ++failed;
+            }
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 1, calls);
+    BOOST_CHECK_EQUAL( 0, failed);
+}
+
+void test_call_once_wait() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_call_once_wait).join();
+}
+
+void do_test_call_once_exception() {
+    boost::fibers::once_flag flag;
+    int calls = 0;
+    bool thrown = false;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&flag,&calls,&thrown](){
+        try {
+            boost::fibers::call_once( flag, [&calls](){
+                ++calls;
+                boost::this_fiber::yield();
+                throw std::runtime_error("initializer failed");
+            });
+        } catch ( std::runtime_error const&) {
+            thrown = true;
+        }
+    });
+    boost::this_fiber::yield();
+    // blocks until the first initializer threw, then runs the initializer
+    boost::fibers::call_once( flag, [&calls](){ ++calls; });
+    f.join();
+    BOOST_CHECK( thrown);
+    BOOST_CHECK_EQUAL( 2, calls);
+    boost::fibers::call_once( flag, [&calls](){ ++calls; });
+    BOOST_CHECK_EQUAL( 2, calls);
+}
+
+void test_call_once_exception() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_call_once_exception).join();
+}
+
+void test_call_once_mt() {
+    for ( int k = 0; k < 50; ++k) {
+        boost::fibers::once_flag flag;
+        std::atomic< int > calls{ 0 };
+        std::atomic< int > initialized{ 0 };
+        std::atomic< int > failed{ 0 };
+        std::vector< std::thread > threads;
+        for ( int i = 0; i < 4; ++i) {
+            threads.emplace_back( [&flag,&calls,&initialized,&failed](){
+                std::vector< boost::fibers::fiber > fibers;
+                for ( int i = 0; i < 4; ++i) {
+                    fibers.emplace_back( boost::fibers::launch::post, [&flag,&calls,&initialized,&failed](){
+                        boost::fibers::call_once( flag, [&calls,&initialized](){
+                            ++calls;
+                            boost::this_fiber::sleep_for( std::chrono::microseconds( 100) );
+                            initialized = 1;
+                        });
+                        if ( 1 != initialized) {
+                            ++failed;
+                        }
+                    });
+                }
+                for ( boost::fibers::fiber & f : fibers) {
+                    f.join();
+                }
+            });
+        }
+        for ( std::thread & t : threads) {
+            t.join();
+        }
+        BOOST_CHECK_EQUAL( 1, calls.load() );
+        BOOST_CHECK_EQUAL( 0, failed.load() );
+    }
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: once test suite");
+
+    test->add( BOOST_TEST_CASE( & test_call_once) );
+    test->add( BOOST_TEST_CASE( & test_call_once_wait) );
+    test->add( BOOST_TEST_CASE( & test_call_once_exception) );
+    test->add( BOOST_TEST_CASE( & test_call_once_mt) );
+
+	return test;
+}
@@ -0,0 +1,120 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::chrono::steady_clock clock_type;
+
+void test_sleep() {
+    // the scheduler parks with a deadline while the only fiber sleeps
+    boost::fibers::fiber( boost::fibers::launch::post, [](){
+        for ( int i = 0; i < 10; ++i) {
+            const clock_type::time_point start = clock_type::now();
+            boost::this_fiber::sleep_for( std::chrono::microseconds( 200) );
+            const clock_type::duration elapsed = clock_type::now() - start;
+            BOOST_CHECK( std::chrono::microseconds( 200) <= elapsed);
+            BOOST_CHECK( std::chrono::seconds( 1) > elapsed);
+        }
+    }).join();
+}
+
+void test_remote_unpark() {
+    // the scheduler of t parks without deadline until the remote notification
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cond;
+    bool ready = false;
+    bool woken = false;
+    std::thread t( [&](){
+        boost::fibers::fiber( boost::fibers::launch::post, [&](){
+            std::unique_lock< boost::fibers::mutex > lk( mtx);
+            cond.wait( lk, [&ready](){ return ready; });
+            woken = true;
+        }).join();
+    });
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10) );
+    boost::fibers::fiber( boost::fibers::launch::post, [&](){
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        ready = true;
+        lk.unlock();
+        cond.notify_one();
+    }).join();
+    t.join();
+    BOOST_CHECK( woken);
+}
+
+void test_ping_pong_mt() {
+    // each round trip parks and unparks both schedulers
+    boost::fibers::buffered_channel< int > ping{ 2 }, pong{ 2 };
+    std::thread t( [&ping,&pong](){
+        boost::fibers::fiber( boost::fibers::launch::post, [&ping,&pong](){
+            int value = 0;
+            while ( boost::fibers::channel_op_status::success == ping.pop( value) ) {
+                pong.push( value + 1);
+            }
+            pong.close();
+        }).join();
+    });
+    boost::fibers::fiber( boost::fibers::launch::post, [&ping,&pong](){
+        for ( int i = 0; i < 1000; ++i) {
+            ping.push( i);
+            BOOST_CHECK_EQUAL( i + 1, pong.value_pop() );
+        }
+        ping.close();
+    }).join();
+    t.join();
+}
+
+void test_shared_work_suspend() {
+    std::atomic< int > count{ 0 };
+    std::atomic< bool > done{ false };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 3; ++i) {
+        threads.emplace_back( [&done](){
+            boost::fibers::use_scheduling_algorithm< boost::fibers::algo::shared_work >( true);
+            // park until fibers are shared
+            while ( ! done.load() ) {
+                boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+            }
+        });
+    }
+    std::thread t( [&count](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::shared_work >( true);
+        for ( int i = 0; i < 100; ++i) {
+            boost::fibers::fiber( boost::fibers::launch::post, [&count](){
+                boost::this_fiber::sleep_for( std::chrono::microseconds( 100) );
+                ++count;
+            }).detach();
+        }
+        while ( 100 != count.load() ) {
+            boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+        }
+    });
+    t.join();
+    done = true;
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( 100, count.load() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: parking test suite");
+
+    test->add( BOOST_TEST_CASE( & test_sleep) );
+    test->add( BOOST_TEST_CASE( & test_remote_unpark) );
+    test->add( BOOST_TEST_CASE( & test_ping_pong_mt) );
+    test->add( BOOST_TEST_CASE( & test_shared_work_suspend) );
+
+	return test;
+}
@@ -0,0 +1,191 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+// statistics are only collected if the library and this test are compiled
+// with BOOST_FIBERS_PROFILE_CONTENTION defined - test/Jamfile.v2 builds this
+// test twice, with and without <fiber-profile-contention>on
+
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::chrono::milliseconds ms;
+
+boost::fibers::profiler::entry const* find( std::vector< boost::fibers::profiler::entry > const& entries,
+                                            void const* object) {
+    for ( boost::fibers::profiler::entry const& e : entries) {
+        if ( object == e.object) {
+            return & e;
+        }
+    }
+    return nullptr;
+}
+
+void do_test_mutex() {
+    boost::fibers::mutex mtx;
+    boost::fibers::profiler::set_name( & mtx, "test mutex");
+    mtx.lock();
+    boost::fibers::fiber f( boost::fibers::launch::post, [&mtx](){
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+    });
+    boost::this_fiber::sleep_for( ms( 10) );
+    mtx.unlock();
+    f.join();
+    BOOST_CHECK( mtx.try_lock() );
+    mtx.unlock();
+    std::vector< boost::fibers::profiler::entry > entries = boost::fibers::profiler::snapshot();
+    boost::fibers::profiler::entry const* e = find( entries, & mtx);
+    if ( ! boost::fibers::profiler::enabled() ) {
+        BOOST_CHECK( entries.empty() );
+        return;
+    }
+    BOOST_REQUIRE( nullptr != e);
+    BOOST_CHECK_EQUAL( std::string( "mutex"), e->kind);
+    BOOST_CHECK_EQUAL( std::string( "test mutex"), e->name);
+    BOOST_CHECK( nullptr != e->site);
+    BOOST_CHECK_EQUAL( 3u, e->acquisitions);
+    BOOST_CHECK_EQUAL( 1u, e->contentions);
+    BOOST_CHECK( e->wait_max >= ms( 5) );
+    BOOST_CHECK( e->wait_total >= e->wait_max);
+    BOOST_CHECK( e->hold_total >= ms( 5) );
+}
+
+void test_enabled() {
+    // the library must have been built in the same configuration as this test
+#if defined(BOOST_FIBERS_PROFILE_CONTENTION)
+    BOOST_CHECK( boost::fibers::profiler::enabled() );
+#else
+    BOOST_CHECK( ! boost::fibers::profiler::enabled() );
+#endif
+}
+
+void test_mutex() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_mutex).join();
+}
+
+void do_test_condition_variable() {
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable_any cond;
+    bool ready = false;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&mtx,&cond,&ready](){
+        boost::this_fiber::sleep_for( ms( 10) );
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        ready = true;
+        cond.notify_one();
+    });
+    {
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        cond.wait( lk, [&ready](){ return ready; });
+        // times out
+        cond.wait_for( lk, ms( 1) );
+    }
+    f.join();
+    if ( ! boost::fibers::profiler::enabled() ) {
+        return;
+    }
+    std::vector< boost::fibers::profiler::entry > entries = boost::fibers::profiler::snapshot();
+    boost::fibers::profiler::entry const* e = find( entries, & cond);
+    BOOST_REQUIRE( nullptr != e);
+    BOOST_CHECK_EQUAL( std::string( "condition_variable_any"), e->kind);
+    BOOST_CHECK_EQUAL( 1u, e->acquisitions);
+    BOOST_CHECK_EQUAL( 2u, e->contentions);
+    BOOST_CHECK( e->wait_max >= ms( 5) );
+}
+
+void test_condition_variable() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_condition_variable).join();
+}
+
+void test_dump_and_reset() {
+    void const* site = nullptr;
+    {
+        boost::fibers::timed_mutex mtx;
+        mtx.lock();
+        mtx.unlock();
+        if ( boost::fibers::profiler::enabled() ) {
+            boost::fibers::profiler::entry const* e = find( boost::fibers::profiler::snapshot(), & mtx);
+            BOOST_REQUIRE( nullptr != e);
+            site = e->site;
+        }
+    }
+    std::ostringstream os;
+    boost::fibers::profiler::dump( os);
+    BOOST_CHECK( ! os.str().empty() );
+    if ( ! boost::fibers::profiler::enabled() ) {
+        return;
+    }
+    // the statistics of destroyed instances are kept per construction site
+    bool found = false;
+    for ( boost::fibers::profiler::entry const& e : boost::fibers::profiler::snapshot() ) {
+        if ( nullptr == e.object && site == e.site && std::string( "timed_mutex") == e.kind) {
+            found = 1u <= e.acquisitions;
+        }
+    }
+    BOOST_CHECK( found);
+    BOOST_CHECK( std::string::npos != os.str().find( "timed_mutex") );
+    boost::fibers::profiler::reset();
+    for ( boost::fibers::profiler::entry const& e : boost::fibers::profiler::snapshot() ) {
+        BOOST_CHECK_EQUAL( 0u, e.acquisitions);
+    }
+}
+
+template< typename M >
+void do_test_hold_time( bool recursive) {
+    M mtx;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    mtx.lock();
+    if ( recursive) {
+        mtx.lock();
+    }
+    boost::fibers::fiber f( boost::fibers::launch::post, [&mtx](){
+        boost::this_fiber::sleep_for( ms( 10) );
+        // not the owner - does not count as a release
+        BOOST_CHECK_THROW( mtx.unlock(), boost::fibers::lock_error);
+    });
+    f.join();
+    if ( recursive) {
+        // nested release - does not count either
+        mtx.unlock();
+    }
+    boost::this_fiber::sleep_for( ms( 10) );
+    mtx.unlock();
+    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    if ( ! boost::fibers::profiler::enabled() ) {
+        return;
+    }
+    boost::fibers::profiler::entry const* e = find( boost::fibers::profiler::snapshot(), & mtx);
+    BOOST_REQUIRE( nullptr != e);
+    BOOST_CHECK_EQUAL( 1u, e->acquisitions);
+    BOOST_CHECK( e->hold_total >= ms( 20) );
+    BOOST_CHECK( e->hold_total <= elapsed);
+}
+
+void test_hold_time() {
+    boost::fibers::fiber( boost::fibers::launch::post, [](){
+        do_test_hold_time< boost::fibers::mutex >( false);
+        do_test_hold_time< boost::fibers::timed_mutex >( false);
+        do_test_hold_time< boost::fibers::recursive_mutex >( true);
+        do_test_hold_time< boost::fibers::recursive_timed_mutex >( true);
+    }).join();
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: profiler test suite");
+
+    test->add( BOOST_TEST_CASE( & test_enabled) );
+    test->add( BOOST_TEST_CASE( & test_mutex) );
+    test->add( BOOST_TEST_CASE( & test_condition_variable) );
+    test->add( BOOST_TEST_CASE( & test_hold_time) );
+    test->add( BOOST_TEST_CASE( & test_dump_and_reset) );
+
+	return test;
+}
@@ -0,0 +1,120 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+struct node {
+    int                 value;
+    std::atomic< bool > * freed;
+
+    node( int value_, std::atomic< bool > * freed_) :
+        value{ value_ },
+        freed{ freed_ } {
+    }
+
+    ~node() {
+        freed->store( true);
+    }
+};
+
+void test_synchronize() {
+    // a grace period without any reader
+    boost::fibers::synchronize_rcu();
+    std::atomic< bool > freed{ false };
+    std::atomic< node * > current{ new node{ 1, & freed } };
+    boost::fibers::rcu_read_lock();
+    BOOST_CHECK_EQUAL( 1, current.load()->value);
+    boost::fibers::rcu_read_unlock();
+    delete current.exchange( nullptr);
+    boost::fibers::synchronize_rcu();
+}
+
+void test_call_rcu() {
+    boost::fibers::fiber( boost::fibers::launch::post, [](){
+        std::atomic< int > called{ 0 };
+        for ( int i = 0; i < 10; ++i) {
+            boost::fibers::call_rcu( [&called](){ ++called; });
+        }
+        BOOST_CHECK_EQUAL( 0, called.load() );
+        // the callbacks run after a grace period
+        while ( 10 != called.load() ) {
+            boost::this_fiber::yield();
+        }
+    }).join();
+}
+
+void test_readers_mt() {
+    constexpr int updates = 2000;
+    std::vector< std::atomic< bool > > freed( updates);
+    std::atomic< node * > current{ new node{ 0, & freed[0] } };
+    std::atomic< bool > done{ false };
+    std::atomic< int > errors{ 0 };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 3; ++i) {
+        threads.emplace_back( [&current,&done,&errors](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int j = 0; j < 3; ++j) {
+                fibers.emplace_back( boost::fibers::launch::post, [&current,&done,&errors](){
+                    int last = 0;
+                    while ( ! done.load() ) {
+                        boost::fibers::rcu_read_lock();
+                        node * n = current.load( std::memory_order_acquire);
+                        if ( n->freed->load() || n->value < last) {
+                            ++errors;
+                        }
+                        last = n->value;
+                        boost::fibers::rcu_read_unlock();
+                        boost::this_fiber::yield();
+                    }
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    boost::fibers::fiber( boost::fibers::launch::post, [&current,&freed](){
+        std::atomic< int > reclaimed{ 0 };
+        for ( int i = 1; i < updates; ++i) {
+            node * old = current.exchange( new node{ i, & freed[i] });
+            if ( 0 == i % 2) {
+                boost::fibers::synchronize_rcu();
+                delete old;
+                ++reclaimed;
+            } else {
+                boost::fibers::call_rcu( [old,&reclaimed](){
+                    delete old;
+                    ++reclaimed;
+                });
+            }
+        }
+        while ( updates - 1 != reclaimed.load() ) {
+            boost::this_fiber::yield();
+        }
+    }).join();
+    done = true;
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    delete current.load();
+    BOOST_CHECK_EQUAL( 0, errors.load() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: rcu test suite");
+
+    test->add( BOOST_TEST_CASE( & test_synchronize) );
+    test->add( BOOST_TEST_CASE( & test_call_rcu) );
+    test->add( BOOST_TEST_CASE( & test_readers_mt) );
+
+	return test;
+}
@@ -0,0 +1,266 @@
+
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <boost/assert.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void test_pop_ready() {
+    boost::fibers::buffered_channel< int > c1{ 2 }, c2{ 2 };
+    int v1 = 0, v2 = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c2.push( 7) );
+    boost::fibers::select_result r = boost::fibers::select(
+            boost::fibers::pop_case( c1, v1),
+            boost::fibers::pop_case( c2, v2) );
+    BOOST_CHECK_EQUAL( 1u, r.index);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == r.status);
+    BOOST_CHECK_EQUAL( 0, v1);
+    BOOST_CHECK_EQUAL( 7, v2);
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c2.try_pop( v2) );
+}
+
+void test_precedence() {
+    boost::fibers::buffered_channel< int > c1{ 2 }, c2{ 2 };
+    int v1 = 0, v2 = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c1.push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c2.push( 2) );
+    boost::fibers::select_result r = boost::fibers::select(
+            boost::fibers::pop_case( c1, v1),
+            boost::fibers::pop_case( c2, v2) );
+    BOOST_CHECK_EQUAL( 0u, r.index);
+    BOOST_CHECK_EQUAL( 1, v1);
+    BOOST_CHECK_EQUAL( 0, v2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c2.try_pop( v2) );
+    BOOST_CHECK_EQUAL( 2, v2);
+}
+
+void test_push_ready() {
+    boost::fibers::buffered_channel< std::string > c1{ 2 }, c2{ 2 };
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c1.push( "a") );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c1.push( "b") );
+    std::string s1{ "c" }, s2{ "d" };
+    boost::fibers::select_result r = boost::fibers::select(
+            boost::fibers::push_case( c1, std::move( s1) ),
+            boost::fibers::push_case( c2, std::move( s2) ) );
+    BOOST_CHECK_EQUAL( 1u, r.index);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == r.status);
+    // only the value of the completed case was moved
+    BOOST_CHECK_EQUAL( std::string{ "c" }, s1);
+    std::string v;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c2.try_pop( v) );
+    BOOST_CHECK_EQUAL( std::string{ "d" }, v);
+}
+
+void test_pop_blocking() {
+    boost::fibers::buffered_channel< int > c1{ 2 }, c2{ 2 };
+    int v1 = 0, v2 = 0;
+    boost::fibers::select_result r{ 0, boost::fibers::channel_op_status::empty };
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&](){
+        r = boost::fibers::select(
+                boost::fibers::pop_case( c1, v1),
+                boost::fibers::pop_case( c2, v2) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c2](){
+        boost::this_fiber::sleep_for( std::chrono::milliseconds( 50) );
+        c2.push( 3);
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 1u, r.index);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == r.status);
+    BOOST_CHECK_EQUAL( 3, v2);
+}
+
+void test_push_blocking() {
+    boost::fibers::buffered_channel< int > c1{ 2 }, c2{ 2 };
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c1.push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c1.push( 2) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c2.push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c2.push( 2) );
+    boost::fibers::select_result r{ 0, boost::fibers::channel_op_status::empty };
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&](){
+        r = boost::fibers::select(
+                boost::fibers::push_case( c1, 10),
+                boost::fibers::push_case( c2, 20) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c1](){
+        boost::this_fiber::sleep_for( std::chrono::milliseconds( 50) );
+        int v = 0;
+        c1.pop( v);
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 0u, r.index);
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c1.pop( v) );
+    BOOST_CHECK_EQUAL( 2, v);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c1.pop( v) );
+    BOOST_CHECK_EQUAL( 10, v);
+}
+
+void test_timeout() {
+    boost::fibers::buffered_channel< int > c1{ 2 };
+    boost::fibers::unbuffered_channel< int > c2;
+    int v1 = 0, v2 = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    boost::fibers::select_result r = boost::fibers::select_for( std::chrono::milliseconds( 50),
+            boost::fibers::pop_case( c1, v1),
+            boost::fibers::pop_case( c2, v2) );
+    BOOST_CHECK_EQUAL( 2u, r.index);
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == r.status);
+    BOOST_CHECK( std::chrono::milliseconds( 50) <= std::chrono::steady_clock::now() - start);
+    // no stale waiter swallows the notification of a fiber blocked in pop()
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&c1,&v1](){
+        c1.pop( v1);
+    });
+    boost::this_fiber::yield();
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c1.push( 5) );
+    f.join();
+    BOOST_CHECK_EQUAL( 5, v1);
+}
+
+void test_closed() {
+    boost::fibers::buffered_channel< int > c1{ 2 }, c2{ 2 };
+    int v1 = 0, v2 = 0;
+    boost::fibers::select_result r{ 0, boost::fibers::channel_op_status::empty };
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&](){
+        r = boost::fibers::select(
+                boost::fibers::pop_case( c1, v1),
+                boost::fibers::pop_case( c2, v2) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c2](){
+        boost::this_fiber::sleep_for( std::chrono::milliseconds( 50) );
+        c2.close();
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 1u, r.index);
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == r.status);
+}
+
+void test_unbuffered_pop() {
+    boost::fibers::unbuffered_channel< int > c1, c2;
+    int v1 = 0, v2 = 0;
+    boost::fibers::select_result r{ 0, boost::fibers::channel_op_status::empty };
+    boost::fibers::channel_op_status status = boost::fibers::channel_op_status::empty;
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&](){
+        r = boost::fibers::select(
+                boost::fibers::pop_case( c1, v1),
+                boost::fibers::pop_case( c2, v2) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c1,&status](){
+        status = c1.push( 4);
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 0u, r.index);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == r.status);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == status);
+    BOOST_CHECK_EQUAL( 4, v1);
+}
+
+void test_unbuffered_push() {
+    boost::fibers::buffered_channel< int > c1{ 2 };
+    boost::fibers::unbuffered_channel< int > c2;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c1.push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c1.push( 2) );
+    int v = 0;
+    boost::fibers::select_result r{ 0, boost::fibers::channel_op_status::empty };
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&](){
+        r = boost::fibers::select(
+                boost::fibers::push_case( c1, 3),
+                boost::fibers::push_case( c2, 6) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c2,&v](){
+        c2.pop( v);
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 1u, r.index);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == r.status);
+    BOOST_CHECK_EQUAL( 6, v);
+}
+
+void test_mt() {
+    const int n = 10000;
+    boost::fibers::buffered_channel< int > c1{ 16 }, c2{ 16 };
+    std::atomic< long > sum{ 0 };
+    std::atomic< int > count{ 0 };
+    auto produce = []( boost::fibers::buffered_channel< int > & c, int n) {
+        boost::fibers::fiber( boost::fibers::launch::dispatch, [&c,n](){
+            for ( int i = 1; i <= n; ++i) {
+                c.push( i);
+            }
+            c.close();
+        }).join();
+    };
+    std::thread p1( produce, std::ref( c1), n);
+    std::thread p2( produce, std::ref( c2), n);
+    // selecting consumer competes with a plain consumer of c1
+    std::thread s( [&](){
+        boost::fibers::fiber( boost::fibers::launch::dispatch, [&](){
+            bool open1 = true, open2 = true;
+            int v = 0;
+            while ( open1 && open2) {
+                boost::fibers::select_result r = boost::fibers::select(
+                        boost::fibers::pop_case( c1, v),
+                        boost::fibers::pop_case( c2, v) );
+                if ( boost::fibers::channel_op_status::success == r.status) {
+                    sum += v;
+                    ++count;
+                } else if ( 0 == r.index) {
+                    open1 = false;
+                } else {
+                    open2 = false;
+                }
+            }
+            boost::fibers::buffered_channel< int > & rest = open1 ? c1 : c2;
+            while ( boost::fibers::channel_op_status::success == rest.pop( v) ) {
+                sum += v;
+                ++count;
+            }
+        }).join();
+    });
+    std::thread c( [&](){
+        boost::fibers::fiber( boost::fibers::launch::dispatch, [&](){
+            int v = 0;
+            while ( boost::fibers::channel_op_status::success == c1.pop( v) ) {
+                sum += v;
+                ++count;
+            }
+        }).join();
+    });
+    p1.join();
+    p2.join();
+    s.join();
+    c.join();
+    BOOST_CHECK_EQUAL( 2 * n, count.load() );
+    BOOST_CHECK_EQUAL( static_cast< long >( n) * ( n + 1), sum.load() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: select test suite");
+
+     test->add( BOOST_TEST_CASE( & test_pop_ready) );
+     test->add( BOOST_TEST_CASE( & test_precedence) );
+     test->add( BOOST_TEST_CASE( & test_push_ready) );
+     test->add( BOOST_TEST_CASE( & test_pop_blocking) );
+     test->add( BOOST_TEST_CASE( & test_push_blocking) );
+     test->add( BOOST_TEST_CASE( & test_timeout) );
+     test->add( BOOST_TEST_CASE( & test_closed) );
+     test->add( BOOST_TEST_CASE( & test_unbuffered_pop) );
+     test->add( BOOST_TEST_CASE( & test_unbuffered_push) );
+     test->add( BOOST_TEST_CASE( & test_mt) );
+
+    return test;
+}
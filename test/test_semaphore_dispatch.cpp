@@ -0,0 +1,225 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::chrono::milliseconds ms;
+
+void test_semaphore_permits() {
+    boost::fibers::counting_semaphore sem( 2);
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( ! sem.try_acquire() );
+    sem.release( 3);
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( ! sem.try_acquire() );
+}
+
+void do_test_semaphore_release_n() {
+    boost::fibers::counting_semaphore sem;
+    int acquired = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 5; ++i) {
+        fibers.emplace_back( boost::fibers::launch::dispatch, [&sem,&acquired](){
+            sem.acquire();
+            ++acquired;
+        });
+    }
+    // let all fibers block
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 0, acquired);
+    // wakes exactly three waiters
+    sem.release( 3);
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 3, acquired);
+    BOOST_CHECK( ! sem.try_acquire() );
+    // two waiters left, one permit stays available
+    sem.release( 3);
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 5, acquired);
+    BOOST_CHECK( sem.try_acquire() );
+    BOOST_CHECK( ! sem.try_acquire() );
+}
+
+void test_semaphore_release_n() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_semaphore_release_n).join();
+}
+
+void do_test_semaphore_timed() {
+    boost::fibers::counting_semaphore sem;
+    bool acquired = true;
+    boost::fibers::fiber( boost::fibers::launch::dispatch, [&sem,&acquired](){
+        acquired = sem.try_acquire_for( ms( 10) );
+    }).join();
+    BOOST_CHECK( ! acquired);
+    // no waiters left - the permit becomes available
+    sem.release();
+    BOOST_CHECK( sem.try_acquire_until( std::chrono::steady_clock::now() + ms( 10) ) );
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&sem,&acquired](){
+        acquired = sem.try_acquire_for( ms( 2000) );
+    });
+    boost::this_fiber::sleep_for( ms( 10) );
+    sem.release();
+    f.join();
+    BOOST_CHECK( acquired);
+    BOOST_CHECK( ! sem.try_acquire() );
+}
+
+void test_semaphore_timed() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_semaphore_timed).join();
+}
+
+void test_semaphore_mt() {
+    boost::fibers::counting_semaphore sem;
+    std::atomic< int > acquired{ 0 };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i) {
+        threads.emplace_back( [&sem,&acquired](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int i = 0; i < 8; ++i) {
+                fibers.emplace_back( boost::fibers::launch::dispatch, [&sem,&acquired](){
+                    for ( int j = 0; j < 100; ++j) {
+                        sem.acquire();
+                        ++acquired;
+                    }
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    for ( int i = 0; i < 4 * 8 * 100 / 16; ++i) {
+        sem.release( 16);
+        std::this_thread::yield();
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( 4 * 8 * 100, acquired.load() );
+    BOOST_CHECK( ! sem.try_acquire() );
+}
+
+void do_test_event_auto_reset() {
+    boost::fibers::event ev;
+    BOOST_CHECK( ! ev.is_set() );
+    BOOST_CHECK( ! ev.try_wait() );
+    ev.set();
+    BOOST_CHECK( ev.is_set() );
+    // consumed by the first wait
+    BOOST_CHECK( ev.try_wait() );
+    BOOST_CHECK( ! ev.try_wait() );
+    int woken = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 3; ++i) {
+        fibers.emplace_back( boost::fibers::launch::dispatch, [&ev,&woken](){
+            ev.wait();
+            ++woken;
+        });
+    }
+    boost::this_fiber::yield();
+    ev.set();
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 1, woken);
+    BOOST_CHECK( ! ev.is_set() );
+    ev.set();
+    ev.set();
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 3, woken);
+    BOOST_CHECK( ! ev.is_set() );
+}
+
+void test_event_auto_reset() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_event_auto_reset).join();
+}
+
+void do_test_event_manual_reset() {
+    boost::fibers::event ev( true);
+    int woken = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 3; ++i) {
+        fibers.emplace_back( boost::fibers::launch::dispatch, [&ev,&woken](){
+            ev.wait();
+            ++woken;
+        });
+    }
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 0, woken);
+    // releases all waiters and stays signaled
+    ev.set();
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 3, woken);
+    BOOST_CHECK( ev.try_wait() );
+    BOOST_CHECK( ev.is_set() );
+    ev.reset();
+    BOOST_CHECK( ! ev.try_wait() );
+    BOOST_CHECK( ! ev.wait_for( ms( 10) ) );
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&ev](){
+        boost::this_fiber::sleep_for( ms( 10) );
+        ev.set();
+    });
+    BOOST_CHECK( ev.wait_until( std::chrono::steady_clock::now() + ms( 2000) ) );
+    f.join();
+}
+
+void test_event_manual_reset() {
+    boost::fibers::fiber( boost::fibers::launch::dispatch, & do_test_event_manual_reset).join();
+}
+
+void test_event_mt() {
+    boost::fibers::event ev( true);
+    std::atomic< int > woken{ 0 };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i) {
+        threads.emplace_back( [&ev,&woken](){
+            std::vector< boost::fibers::fiber > fibers;
+            for ( int i = 0; i < 4; ++i) {
+                fibers.emplace_back( boost::fibers::launch::dispatch, [&ev,&woken](){
+                    ev.wait();
+                    ++woken;
+                });
+            }
+            for ( boost::fibers::fiber & f : fibers) {
+                f.join();
+            }
+        });
+    }
+    std::this_thread::sleep_for( ms( 10) );
+    ev.set();
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( 16, woken.load() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: semaphore test suite");
+
+    test->add( BOOST_TEST_CASE( & test_semaphore_permits) );
+    test->add( BOOST_TEST_CASE( & test_semaphore_release_n) );
+    test->add( BOOST_TEST_CASE( & test_semaphore_timed) );
+    test->add( BOOST_TEST_CASE( & test_semaphore_mt) );
+    test->add( BOOST_TEST_CASE( & test_event_auto_reset) );
+    test->add( BOOST_TEST_CASE( & test_event_manual_reset) );
+    test->add( BOOST_TEST_CASE( & test_event_mt) );
+
+	return test;
+}
@@ -0,0 +1,267 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef std::chrono::milliseconds ms;
+
+template< typename M >
+void do_test_shared_ownership() {
+    M mtx;
+    int readers = 0;
+    int max_readers = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 3; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [&mtx,&readers,&max_readers](){
+            mtx.lock_shared();
+            ++readers;
+            for ( int i = 0; i < 3; ++i) {
+                if ( max_readers < readers) {
+                    max_readers = readers;
+                }
+                boost::this_fiber::yield();
+            }
+            --readers;
+            mtx.unlock_shared();
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 3, max_readers);
+    BOOST_CHECK( mtx.try_lock() );
+    BOOST_CHECK( ! mtx.try_lock_shared() );
+    mtx.unlock();
+    BOOST_CHECK( mtx.try_lock_shared() );
+    BOOST_CHECK( ! mtx.try_lock() );
+    mtx.unlock_shared();
+}
+
+void test_shared_ownership() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_shared_ownership< boost::fibers::shared_mutex >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_shared_ownership< boost::fibers::shared_timed_mutex >).join();
+}
+
+template< typename M >
+void do_test_writer_preference() {
+    M mtx;
+    std::vector< int > order;
+    mtx.lock_shared();
+    boost::fibers::fiber w( boost::fibers::launch::post, [&mtx,&order](){
+        std::unique_lock< M > lk( mtx);
+        order.push_back( 1);
+    });
+    // let the writer block
+    boost::this_fiber::yield();
+    // a queued writer keeps new readers out
+    BOOST_CHECK( ! mtx.try_lock_shared() );
+    boost::fibers::fiber r( boost::fibers::launch::post, [&mtx,&order](){
+        mtx.lock_shared();
+        order.push_back( 2);
+        mtx.unlock_shared();
+    });
+    boost::this_fiber::yield();
+    BOOST_CHECK( order.empty() );
+    mtx.unlock_shared();
+    w.join();
+    r.join();
+    BOOST_REQUIRE_EQUAL( 2u, order.size() );
+    BOOST_CHECK_EQUAL( 1, order[0]);
+    BOOST_CHECK_EQUAL( 2, order[1]);
+}
+
+void test_writer_preference() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_writer_preference< boost::fibers::shared_mutex >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_writer_preference< boost::fibers::shared_timed_mutex >).join();
+}
+
+template< typename M >
+void do_test_readers_batch() {
+    M mtx;
+    int readers = 0;
+    int max_readers = 0;
+    bool writer = false;
+    mtx.lock();
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 4; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [&mtx,&readers,&max_readers](){
+            mtx.lock_shared();
+            ++readers;
+            boost::this_fiber::yield();
+            if ( max_readers < readers) {
+                max_readers = readers;
+            }
+            mtx.unlock_shared();
+        });
+    }
+    boost::fibers::fiber w( boost::fibers::launch::post, [&mtx,&writer,&readers](){
+        std::unique_lock< M > lk( mtx);
+        // all readers queued before were released in one batch
+        BOOST_CHECK_EQUAL( 4, readers);
+        writer = true;
+    });
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( 0, readers);
+    mtx.unlock();
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    w.join();
+    BOOST_CHECK_EQUAL( 4, max_readers);
+    BOOST_CHECK( writer);
+}
+
+void test_readers_batch() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_readers_batch< boost::fibers::shared_mutex >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_readers_batch< boost::fibers::shared_timed_mutex >).join();
+}
+
+template< typename M >
+void do_test_deadlock() {
+    M mtx;
+    mtx.lock();
+    bool thrown = false;
+    try {
+        mtx.lock();
+    } catch ( boost::fibers::lock_error const& e) {
+        thrown = std::make_error_code( std::errc::resource_deadlock_would_occur) == e.code();
+    }
+    BOOST_CHECK( thrown);
+    mtx.unlock();
+    thrown = false;
+    try {
+        mtx.unlock();
+    } catch ( boost::fibers::lock_error const& e) {
+        thrown = std::make_error_code( std::errc::operation_not_permitted) == e.code();
+    }
+    BOOST_CHECK( thrown);
+}
+
+void test_deadlock() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_deadlock< boost::fibers::shared_mutex >).join();
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_deadlock< boost::fibers::shared_timed_mutex >).join();
+}
+
+void do_test_shared_timed_mutex() {
+    boost::fibers::shared_timed_mutex mtx;
+    bool locked = true;
+    mtx.lock_shared();
+    boost::fibers::fiber( boost::fibers::launch::post, [&mtx,&locked](){
+        locked = mtx.try_lock_for( ms( 10) );
+    }).join();
+    BOOST_CHECK( ! locked);
+    // no waiters left - readers still enter via the fast path
+    BOOST_CHECK( mtx.try_lock_shared() );
+    mtx.unlock_shared();
+    // a timed-out writer releases the readers queued behind it
+    boost::fibers::fiber w( boost::fibers::launch::post, [&mtx,&locked](){
+        locked = mtx.try_lock_until( std::chrono::steady_clock::now() + ms( 50) );
+    });
+    boost::this_fiber::yield();
+    bool reader = false;
+    boost::fibers::fiber r( boost::fibers::launch::post, [&mtx,&reader](){
+        reader = mtx.try_lock_shared_for( ms( 2000) );
+        if ( reader) {
+            mtx.unlock_shared();
+        }
+    });
+    r.join();
+    w.join();
+    BOOST_CHECK( ! locked);
+    BOOST_CHECK( reader);
+    mtx.unlock_shared();
+    mtx.lock();
+    boost::fibers::fiber( boost::fibers::launch::post, [&mtx,&locked](){
+        locked = mtx.try_lock_shared_for( ms( 10) );
+    }).join();
+    BOOST_CHECK( ! locked);
+    boost::fibers::fiber r2( boost::fibers::launch::post, [&mtx,&locked](){
+        locked = mtx.try_lock_shared_for( ms( 2000) );
+        if ( locked) {
+            mtx.unlock_shared();
+        }
+    });
+    boost::this_fiber::sleep_for( ms( 10) );
+    mtx.unlock();
+    r2.join();
+    BOOST_CHECK( locked);
+    BOOST_CHECK( mtx.try_lock() );
+    mtx.unlock();
+}
+
+void test_shared_timed_mutex() {
+    boost::fibers::fiber( boost::fibers::launch::post, & do_test_shared_timed_mutex).join();
+}
+
+template< typename M >
+void do_test_mt() {
+    M mtx;
+    std::atomic< int > readers{ 0 };
+    long value = 0;
+    std::atomic< bool > failed{ false };
+    auto worker = [&mtx,&readers,&value,&failed](){
+        std::vector< boost::fibers::fiber > fibers;
+        for ( int i = 0; i < 4; ++i) {
+            fibers.emplace_back( boost::fibers::launch::post, [&mtx,&readers,&value,&failed,i](){
+                for ( int j = 0; j < 500; ++j) {
+                    if ( 0 == ( i + j) % 4) {
+                        std::unique_lock< M > lk( mtx);
+                        if ( 0 != readers.load() ) {
+                            failed = true;
+                        }
+                        ++value;
+                        boost::this_fiber::yield();
+                    } else {
+                        mtx.lock_shared();
+                        ++readers;
+                        boost::this_fiber::yield();
+                        --readers;
+                        mtx.unlock_shared();
+                    }
+                }
+            });
+        }
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+    };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i) {
+        threads.emplace_back( worker);
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK( ! failed);
+    BOOST_CHECK_EQUAL( 4 * 4 * 500 / 4, value);
+}
+
+void test_mt() {
+    do_test_mt< boost::fibers::shared_mutex >();
+    do_test_mt< boost::fibers::shared_timed_mutex >();
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: shared_mutex test suite");
+
+    test->add( BOOST_TEST_CASE( & test_shared_ownership) );
+    test->add( BOOST_TEST_CASE( & test_writer_preference) );
+    test->add( BOOST_TEST_CASE( & test_readers_batch) );
+    test->add( BOOST_TEST_CASE( & test_deadlock) );
+    test->add( BOOST_TEST_CASE( & test_shared_timed_mutex) );
+    test->add( BOOST_TEST_CASE( & test_mt) );
+
+	return test;
+}
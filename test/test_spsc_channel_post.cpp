@@ -0,0 +1,219 @@
+//          Copyright Oliver Kowalke 2016.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+void test_zero_wm() {
+    bool thrown = false;
+    try {
+        boost::fibers::spsc_channel< int > c( 0);
+    } catch ( boost::fibers::fiber_error const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+}
+
+void test_push_pop() {
+    boost::fibers::spsc_channel< int > c( 4);
+    int v = 0;
+    for ( int i = 0; i < 10; ++i) {
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( i) );
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+        BOOST_CHECK_EQUAL( i, v);
+    }
+}
+
+void test_push_closed() {
+    boost::fibers::spsc_channel< int > c( 16);
+    c.close();
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.try_push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.push_wait_for( 1, std::chrono::seconds( 1) ) );
+}
+
+void test_try_push_full() {
+    boost::fibers::spsc_channel< int > c( 2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 2) );
+    BOOST_CHECK( boost::fibers::channel_op_status::full == c.try_push( 3) );
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_pop( v) );
+    BOOST_CHECK_EQUAL( 1, v);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_push( 3) );
+}
+
+void test_push_wait_for_timeout() {
+    boost::fibers::spsc_channel< int > c( 2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push_wait_for( 1, std::chrono::seconds( 1) ) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push_wait_for( 2, std::chrono::seconds( 1) ) );
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.push_wait_for( 3, std::chrono::milliseconds( 50) ) );
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.push_wait_until( 3,
+                    std::chrono::system_clock::now() + std::chrono::milliseconds( 50) ) );
+}
+
+void test_pop_closed() {
+    boost::fibers::spsc_channel< int > c( 16);
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 1) );
+    c.close();
+    // values pushed before close() can be popped
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    BOOST_CHECK_EQUAL( 1, v);
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.pop( v) );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.try_pop( v) );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.pop_wait_for( v, std::chrono::seconds( 1) ) );
+    bool thrown = false;
+    try {
+        c.value_pop();
+    } catch ( boost::fibers::fiber_error const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+}
+
+void test_pop_success() {
+    boost::fibers::spsc_channel< int > c( 2);
+    int v1 = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&c,&v1](){
+        // suspends until the value is pushed
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v1) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&c](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 7) );
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 7, v1);
+}
+
+void test_pop_wait_for_timeout() {
+    boost::fibers::spsc_channel< int > c( 16);
+    int v = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c.try_pop( v) );
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.pop_wait_for( v, std::chrono::milliseconds( 50) ) );
+    BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.pop_wait_until( v,
+                    std::chrono::system_clock::now() + std::chrono::milliseconds( 50) ) );
+}
+
+void test_value_pop_moveable() {
+    boost::fibers::spsc_channel< std::unique_ptr< int > > c( 2);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( std::unique_ptr< int >( new int( 3) ) ) );
+    std::unique_ptr< int > p{ c.value_pop() };
+    BOOST_CHECK( p);
+    BOOST_CHECK_EQUAL( 3, * p);
+}
+
+void test_close_blocked_producer() {
+    boost::fibers::spsc_channel< int > c( 2);
+    boost::fibers::channel_op_status status = boost::fibers::channel_op_status::success;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&c,&status](){
+        c.push( 1);
+        c.push( 2);
+        // full - blocks until close()
+        status = c.push( 3);
+    });
+    boost::this_fiber::yield();
+    c.close();
+    f.join();
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == status);
+}
+
+void test_destroy_values() {
+    std::shared_ptr< int > p{ new int( 1) };
+    {
+        boost::fibers::spsc_channel< std::shared_ptr< int > > c( 4);
+        c.push( p);
+        c.push( p);
+        std::shared_ptr< int > q;
+        c.pop( q);
+        BOOST_CHECK_EQUAL( 3, p.use_count() );
+    }
+    // the value left in the channel was destroyed
+    BOOST_CHECK_EQUAL( 1, p.use_count() );
+}
+
+void test_rangefor() {
+    boost::fibers::spsc_channel< int > chan{ 2 };
+    std::vector< int > vec;
+    boost::fibers::fiber f1( boost::fibers::launch::post, [&chan]{
+        chan.push( 1);
+        chan.push( 1);
+        chan.push( 2);
+        chan.push( 3);
+        chan.push( 5);
+        chan.push( 8);
+        chan.push( 12);
+        chan.close();
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::post, [&vec,&chan]{
+        for ( int value : chan) {
+            vec.push_back( value);
+        }
+    });
+    f1.join();
+    f2.join();
+    std::vector< int > expected{ 1, 1, 2, 3, 5, 8, 12 };
+    BOOST_CHECK( expected == vec);
+}
+
+void test_mt() {
+    boost::fibers::spsc_channel< int > chan{ 16 };
+    long sum = 0;
+    bool ordered = true;
+    std::thread producer( [&chan](){
+        boost::fibers::fiber( boost::fibers::launch::post, [&chan](){
+            for ( int j = 1; j <= 100000; ++j) {
+                chan.push( j);
+            }
+            chan.close();
+        }).join();
+    });
+    std::thread consumer( [&chan,&sum,&ordered](){
+        boost::fibers::fiber( boost::fibers::launch::post, [&chan,&sum,&ordered](){
+            int value = 0, last = 0;
+            while ( boost::fibers::channel_op_status::success == chan.pop( value) ) {
+                if ( last + 1 != value) {
+                    ordered = false;
+                }
+                last = value;
+                sum += value;
+            }
+        }).join();
+    });
+    producer.join();
+    consumer.join();
+    BOOST_CHECK( ordered);
+    BOOST_CHECK_EQUAL( 5000050000L, sum);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: spsc_channel test suite");
+
+     test->add( BOOST_TEST_CASE( & test_zero_wm) );
+     test->add( BOOST_TEST_CASE( & test_push_pop) );
+     test->add( BOOST_TEST_CASE( & test_push_closed) );
+     test->add( BOOST_TEST_CASE( & test_try_push_full) );
+     test->add( BOOST_TEST_CASE( & test_push_wait_for_timeout) );
+     test->add( BOOST_TEST_CASE( & test_pop_closed) );
+     test->add( BOOST_TEST_CASE( & test_pop_success) );
+     test->add( BOOST_TEST_CASE( & test_pop_wait_for_timeout) );
+     test->add( BOOST_TEST_CASE( & test_value_pop_moveable) );
+     test->add( BOOST_TEST_CASE( & test_close_blocked_producer) );
+     test->add( BOOST_TEST_CASE( & test_destroy_values) );
+     test->add( BOOST_TEST_CASE( & test_rangefor) );
+     test->add( BOOST_TEST_CASE( & test_mt) );
+
+    return test;
+}
@@ -0,0 +1,441 @@
+
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+struct moveable {
+    bool    state;
+    int     value;
+
+    moveable() :
+        state( false),
+        value( -1) {
+    }
+
+    moveable( int v) :
+        state( true),
+        value( v) {
+    }
+
+    moveable( moveable && other) :
+        state( other.state),
+        value( other.value) {
+        other.state = false;
+        other.value = -1;
+    }
+
+    moveable & operator=( moveable && other) {
+        if ( this == & other) return * this;
+        state = other.state;
+        other.state = false;
+        value = other.value;
+        other.value = -1;
+        return * this;
+    }
+};
+
+// counts the live instances
+struct counted {
+    static int  instances;
+
+    int     value;
+
+    counted( int v = 0) :
+        value( v) {
+        ++instances;
+    }
+
+    counted( counted const& other) :
+        value( other.value) {
+        ++instances;
+    }
+
+    counted & operator=( counted const&) = default;
+
+    ~counted() {
+        --instances;
+    }
+};
+
+int counted::instances = 0;
+
+// copy construction throws if requested
+struct throwing {
+    int     value;
+    bool    fail;
+
+    throwing( int v, bool f = false) :
+        value( v),
+        fail( f) {
+    }
+
+    throwing( throwing const& other) :
+        value( other.value),
+        fail( other.fail) {
+        if ( fail) {
+            throw std::runtime_error("copy failed");
+        }
+    }
+
+    throwing & operator=( throwing const&) = default;
+};
+
+// counts the allocations of all instances
+template< typename T >
+struct counting_allocator {
+    typedef T   value_type;
+
+    static std::atomic< int >   allocations;
+
+    counting_allocator() = default;
+
+    template< typename U >
+    counting_allocator( counting_allocator< U > const&) noexcept {
+    }
+
+    T * allocate( std::size_t n) {
+        ++counting_allocator< int >::allocations;
+        return std::allocator< T >{}.allocate( n);
+    }
+
+    void deallocate( T * p, std::size_t n) noexcept {
+        std::allocator< T >{}.deallocate( p, n);
+    }
+};
+
+template< typename T >
+std::atomic< int > counting_allocator< T >::allocations{ 0 };
+
+template< typename T, typename U >
+bool operator==( counting_allocator< T > const&, counting_allocator< U > const&) noexcept {
+    return true;
+}
+
+template< typename T, typename U >
+bool operator!=( counting_allocator< T > const&, counting_allocator< U > const&) noexcept {
+    return false;
+}
+
+void test_push() {
+    boost::fibers::unbounded_channel< int > c;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 1) );
+}
+
+void test_push_closed() {
+    boost::fibers::unbounded_channel< int > c;
+    c.close();
+    BOOST_CHECK( c.is_closed() );
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.push( 1) );
+}
+
+void test_pop() {
+    boost::fibers::unbounded_channel< int > c;
+    int v1 = 2, v2 = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( v1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v2) );
+    BOOST_CHECK_EQUAL( v1, v2);
+}
+
+void test_pop_closed() {
+    boost::fibers::unbounded_channel< int > c;
+    int v1 = 2, v2 = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( v1) );
+    c.close();
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v2) );
+    BOOST_CHECK_EQUAL( v1, v2);
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.pop( v2) );
+}
+
+void test_pop_success() {
+    boost::fibers::unbounded_channel< int > c;
+    int v1 = 2, v2 = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&c,&v2](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v2) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c,v1](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( v1) );
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( v1, v2);
+}
+
+void test_value_pop() {
+    boost::fibers::unbounded_channel< int > c;
+    int v1 = 2, v2 = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( v1) );
+    v2 = c.value_pop();
+    BOOST_CHECK_EQUAL( v1, v2);
+}
+
+void test_value_pop_closed() {
+    boost::fibers::unbounded_channel< int > c;
+    int v1 = 2, v2 = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( v1) );
+    c.close();
+    v2 = c.value_pop();
+    BOOST_CHECK_EQUAL( v1, v2);
+    bool thrown = false;
+    try {
+        c.value_pop();
+    } catch ( boost::fibers::fiber_error const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+}
+
+void test_try_pop() {
+    boost::fibers::unbounded_channel< int > c;
+    int v1 = 2, v2 = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c.try_pop( v2) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( v1) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_pop( v2) );
+    BOOST_CHECK_EQUAL( v1, v2);
+}
+
+void test_try_pop_closed() {
+    boost::fibers::unbounded_channel< int > c;
+    int v1 = 2, v2 = 0;
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( v1) );
+    c.close();
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_pop( v2) );
+    BOOST_CHECK_EQUAL( v1, v2);
+    BOOST_CHECK( boost::fibers::channel_op_status::closed == c.try_pop( v2) );
+}
+
+void test_pop_wait_for_success() {
+    boost::fibers::unbounded_channel< int > c;
+    int v1 = 2, v2 = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&c,&v2](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop_wait_for( v2, std::chrono::seconds( 1) ) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c,v1](){
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( v1) );
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( v1, v2);
+}
+
+void test_pop_wait_for_timeout() {
+    boost::fibers::unbounded_channel< int > c;
+    int v = 0;
+    boost::fibers::fiber f( boost::fibers::launch::dispatch, [&c,&v](){
+        BOOST_CHECK( boost::fibers::channel_op_status::timeout == c.pop_wait_for( v, std::chrono::seconds( 1) ) );
+    });
+    f.join();
+    // the timed out consumer does not swallow a notification
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( 3) );
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    BOOST_CHECK_EQUAL( 3, v);
+}
+
+void test_pop_wait_until_closed() {
+    boost::fibers::unbounded_channel< int > c;
+    int v = 0;
+    boost::fibers::fiber f1( boost::fibers::launch::dispatch, [&c,&v](){
+        BOOST_CHECK( boost::fibers::channel_op_status::closed ==
+                c.pop_wait_until( v, std::chrono::system_clock::now() + std::chrono::seconds( 1) ) );
+    });
+    boost::fibers::fiber f2( boost::fibers::launch::dispatch, [&c](){
+        c.close();
+    });
+    f1.join();
+    f2.join();
+}
+
+void test_moveable() {
+    boost::fibers::unbounded_channel< moveable > c;
+    moveable m1( 3), m2;
+    BOOST_CHECK( m1.state);
+    BOOST_CHECK_EQUAL( 3, m1.value);
+    BOOST_CHECK( ! m2.state);
+    BOOST_CHECK_EQUAL( -1, m2.value);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( std::move( m1) ) );
+    BOOST_CHECK( ! m1.state);
+    BOOST_CHECK( ! m2.state);
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( m2) );
+    BOOST_CHECK( ! m1.state);
+    BOOST_CHECK_EQUAL( -1, m1.value);
+    BOOST_CHECK( m2.state);
+    BOOST_CHECK_EQUAL( 3, m2.value);
+}
+
+void test_rangefor() {
+    boost::fibers::unbounded_channel< int > chan;
+    std::vector< int > vec;
+    boost::fibers::fiber f1([&chan]{
+        chan.push( 1);
+        chan.push( 1);
+        chan.push( 2);
+        chan.push( 3);
+        chan.push( 5);
+        chan.push( 8);
+        chan.push( 12);
+        chan.close();
+    });
+    boost::fibers::fiber f2([&vec,&chan]{
+        for ( int value : chan) {
+            vec.push_back( value);
+        }
+    });
+    f1.join();
+    f2.join();
+    BOOST_CHECK_EQUAL( 7u, vec.size() );
+    BOOST_CHECK_EQUAL( 1, vec[0]);
+    BOOST_CHECK_EQUAL( 1, vec[1]);
+    BOOST_CHECK_EQUAL( 2, vec[2]);
+    BOOST_CHECK_EQUAL( 3, vec[3]);
+    BOOST_CHECK_EQUAL( 5, vec[4]);
+    BOOST_CHECK_EQUAL( 8, vec[5]);
+    BOOST_CHECK_EQUAL( 12, vec[6]);
+}
+
+void test_segments() {
+    boost::fibers::unbounded_channel< std::string > c;
+    // spans many segments
+    for ( int i = 0; i < 1000; ++i) {
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( std::to_string( i) ) );
+    }
+    std::string v;
+    for ( int i = 0; i < 1000; ++i) {
+        BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_pop( v) );
+        BOOST_CHECK_EQUAL( std::to_string( i), v);
+    }
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c.try_pop( v) );
+}
+
+void test_destroy_values() {
+    {
+        boost::fibers::unbounded_channel< counted > c;
+        for ( int i = 0; i < 100; ++i) {
+            c.push( counted{ i });
+        }
+        counted v;
+        for ( int i = 0; i < 40; ++i) {
+            BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+            BOOST_CHECK_EQUAL( i, v.value);
+        }
+        BOOST_CHECK_EQUAL( 61, counted::instances);
+    }
+    BOOST_CHECK_EQUAL( 0, counted::instances);
+}
+
+void test_push_throws() {
+    boost::fibers::unbounded_channel< throwing > c;
+    // spans several segments, every third push throws
+    for ( int i = 0; i < 100; ++i) {
+        throwing t{ i, 0 == i % 3 };
+        if ( t.fail) {
+            BOOST_CHECK_THROW( c.push( t), std::runtime_error);
+        } else {
+            BOOST_CHECK( boost::fibers::channel_op_status::success == c.push( t) );
+        }
+    }
+    throwing v{ -1 };
+    for ( int i = 0; i < 100; ++i) {
+        if ( 0 != i % 3) {
+            BOOST_CHECK( boost::fibers::channel_op_status::success == c.try_pop( v) );
+            BOOST_CHECK_EQUAL( i, v.value);
+        }
+    }
+    BOOST_CHECK( boost::fibers::channel_op_status::empty == c.try_pop( v) );
+    // the failed slot at the head is stepped over by a blocking pop
+    throwing t{ 100, true };
+    BOOST_CHECK_THROW( c.push( t), std::runtime_error);
+    c.push( throwing{ 101 });
+    BOOST_CHECK( boost::fibers::channel_op_status::success == c.pop( v) );
+    BOOST_CHECK_EQUAL( 101, v.value);
+}
+
+void test_segment_reuse() {
+    boost::fibers::unbounded_channel< int, counting_allocator< int > > c;
+    int v = 0;
+    for ( int i = 0; i < 100; ++i) {
+        c.push( i);
+        c.pop( v);
+    }
+    const int warm = counting_allocator< int >::allocations.load();
+    // steady state: consumed segments are recycled
+    for ( int i = 0; i < 100000; ++i) {
+        c.push( i);
+        c.pop( v);
+        BOOST_CHECK_EQUAL( i, v);
+    }
+    BOOST_CHECK_EQUAL( warm, counting_allocator< int >::allocations.load() );
+}
+
+void test_mt() {
+    boost::fibers::unbounded_channel< int > chan;
+    std::atomic< long > sum{ 0 };
+    std::atomic< int > count{ 0 };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i) {
+        threads.emplace_back( [&chan](){
+            boost::fibers::fiber( boost::fibers::launch::dispatch, [&chan](){
+                for ( int j = 1; j <= 10000; ++j) {
+                    chan.push( j);
+                }
+            }).join();
+        });
+        threads.emplace_back( [&chan,&sum,&count](){
+            boost::fibers::fiber( boost::fibers::launch::dispatch, [&chan,&sum,&count](){
+                int v = 0;
+                while ( boost::fibers::channel_op_status::success == chan.pop( v) ) {
+                    sum += v;
+                    ++count;
+                }
+            }).join();
+        });
+    }
+    for ( std::size_t i = 0; i < threads.size(); i += 2) {
+        threads[i].join();
+    }
+    chan.close();
+    for ( std::size_t i = 1; i < threads.size(); i += 2) {
+        threads[i].join();
+    }
+    BOOST_CHECK_EQUAL( 40000, count.load() );
+    BOOST_CHECK_EQUAL( 4 * 50005000L, sum.load() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: unbounded_channel test suite");
+
+     test->add( BOOST_TEST_CASE( & test_push) );
+     test->add( BOOST_TEST_CASE( & test_push_closed) );
+     test->add( BOOST_TEST_CASE( & test_pop) );
+     test->add( BOOST_TEST_CASE( & test_pop_closed) );
+     test->add( BOOST_TEST_CASE( & test_pop_success) );
+     test->add( BOOST_TEST_CASE( & test_value_pop) );
+     test->add( BOOST_TEST_CASE( & test_value_pop_closed) );
+     test->add( BOOST_TEST_CASE( & test_try_pop) );
+     test->add( BOOST_TEST_CASE( & test_try_pop_closed) );
+     test->add( BOOST_TEST_CASE( & test_pop_wait_for_success) );
+     test->add( BOOST_TEST_CASE( & test_pop_wait_for_timeout) );
+     test->add( BOOST_TEST_CASE( & test_pop_wait_until_closed) );
+     test->add( BOOST_TEST_CASE( & test_moveable) );
+     test->add( BOOST_TEST_CASE( & test_rangefor) );
+     test->add( BOOST_TEST_CASE( & test_segments) );
+     test->add( BOOST_TEST_CASE( & test_destroy_values) );
+     test->add( BOOST_TEST_CASE( & test_push_throws) );
+     test->add( BOOST_TEST_CASE( & test_segment_reuse) );
+     test->add( BOOST_TEST_CASE( & test_mt) );
+
+    return test;
+}
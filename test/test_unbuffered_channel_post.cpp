@@ -4,9 +4,11 @@
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+#include <atomic>
 #include <chrono>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/assert.hpp>
@@ -402,6 +404,37 @@ void test_rangefor() {
     BOOST_CHECK_EQUAL( 12, vec[6]);
 }
 
+void test_mt() {
+    boost::fibers::unbuffered_channel< int > chan;
+    std::atomic< int > sum{ 0 };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i) {
+        threads.emplace_back( [&chan](){
+            boost::fibers::fiber( boost::fibers::launch::post, [&chan](){
+                for ( int j = 1; j <= 1000; ++j) {
+                    BOOST_CHECK( boost::fibers::channel_op_status::success == chan.push( j) );
+                }
+            }).join();
+        });
+        threads.emplace_back( [&chan,&sum](){
+            boost::fibers::fiber( boost::fibers::launch::post, [&chan,&sum](){
+                int value = 0;
+                while ( boost::fibers::channel_op_status::success == chan.pop( value) ) {
+                    sum += value;
+                }
+            }).join();
+        });
+    }
+    for ( std::size_t i = 0; i < threads.size(); i += 2) {
+        threads[i].join();
+    }
+    chan.close();
+    for ( std::size_t i = 1; i < threads.size(); i += 2) {
+        threads[i].join();
+    }
+    BOOST_CHECK_EQUAL( 4 * 500500, sum.load() );
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: unbuffered_channel test suite");
@@ -431,6 +464,7 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
      test->add( BOOST_TEST_CASE( & test_wm_1) );
      test->add( BOOST_TEST_CASE( & test_moveable) );
      test->add( BOOST_TEST_CASE( & test_rangefor) );
+     test->add( BOOST_TEST_CASE( & test_mt) );
 
     return test;
 }